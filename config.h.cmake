@@ -19,6 +19,8 @@
 
 #cmakedefine HAVE_SYS_STAT_H 1
 #cmakedefine HAVE_SYS_TYPES_H 1
+#cmakedefine HAVE_SYS_MMAN_H 1
+#cmakedefine HAVE_UNISTD_H 1
 #cmakedefine HAVE_READLINE 1
 
 #cmakedefine HAVE_WCWIDTH 1
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <array>
 
 #include "tile.h"
 #include "logging.h"
@@ -43,6 +44,7 @@ using dic_elt_t = unsigned int;
 using dic_code_t = unsigned char;
 struct params_cross_t;
 struct params_7plus1_t;
+struct params_anagram_t;
 struct params_regexp_t;
 struct DicEdge;
 
@@ -233,6 +235,25 @@ public:
     void searchRacc(const wstring &iWord, vector<wdstring> &oWordList,
                     unsigned int iMaxResults = 0) const;
 
+    /**
+     * Same search as searchRacc(), but only the added letters are returned,
+     * as masks of tile codes (bit i is set for the code i)
+     * @param iWord: word
+     * @param oFrontHooks: letters which can be added in front of the word
+     * @param oBackHooks: letters which can be added at the end of the word
+     */
+    void searchHooks(const wstring &iWord, uint64_t &oFrontHooks,
+                     uint64_t &oBackHooks) const;
+
+    /**
+     * Same search as searchBenj(), but only the codes of the 3 added
+     * letters of each benjamin are returned
+     * @param iWord: word
+     * @param oPrefixes: results
+     */
+    void searchBenjCodes(const wstring &iWord,
+                         vector<array<dic_code_t, 3>> &oPrefixes) const;
+
     /**
      * Search for all feasible word with "rack" plus one letter
      * XXX: the key in the map is the internal code, because it allows an easy
@@ -249,6 +270,28 @@ public:
                     map<unsigned int, vector<wdstring> > &oWordList,
                     bool joker) const;
 
+    /**
+     * Search for the words with the highest raw score which can be formed
+     * with (a subset of) the given letters, without using any board.
+     * The raw score of a word is the sum of the points of its letters,
+     * a letter played with a joker being worth 0 point.
+     * When several jokers assignments are possible for a word, the best one
+     * is used, and the letters played with a joker are returned in lowercase.
+     *
+     * @param iRack: letters, the '?' character standing for a joker
+     * @param oWordList: results, sorted by decreasing score, then in the
+     *      order of the dictionary letters. Each word is associated with
+     *      its raw score
+     * @param iMinLength: minimum length of the returned words
+     * @param iMaxLength: maximum length of the returned words
+     * @param iMaxResults: maximum number of returned results (0 means no limit)
+     */
+    void searchAnagrams(const wstring &iRack,
+                        vector<pair<wdstring, unsigned int> > &oWordList,
+                        unsigned int iMinLength = 1,
+                        unsigned int iMaxLength = DIC_WORD_MAX - 1,
+                        unsigned int iMaxResults = 0) const;
+
     /**
      * Search for words matching a regular expression
      * @param iRegexp: regular expression
@@ -324,6 +367,11 @@ private:
     void searchWordByLen(struct params_7plus1_t &params,
                          int i, const DicEdge *edgeptr) const;
 
+    /// Helper for searchAnagrams()
+    void searchAnagramsRec(struct params_anagram_t &params,
+                           unsigned int iDepth, const DicEdge *edgeptr,
+                           unsigned int iScore) const;
+
     /// Helper for searchRegExp()
     void searchRegexpRec(const struct params_regexp_t &params,
                          int state,
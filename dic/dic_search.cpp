@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cwchar>
@@ -216,6 +217,169 @@ void Dictionary::search7pl1(const wstring &iRack,
 /****************************************/
 /****************************************/
 
+struct anagram_t
+{
+    unsigned int points;
+    /// Discovery order, i.e. order of the words in the dictionary
+    unsigned int rank;
+    wstring word;
+};
+
+/// Return true if iA should be listed before iB
+static bool betterAnagram(const anagram_t &iA, const anagram_t &iB)
+{
+    if (iA.points != iB.points)
+        return iA.points > iB.points;
+    return iA.rank < iB.rank;
+}
+
+struct params_anagram_t
+{
+    unsigned int minlength;
+    unsigned int maxlength;
+    unsigned int maxresults;
+    /// Number of available tiles for each code (index 0 is for the joker)
+    unsigned int letters[DIC_LETTERS + 1];
+    /// Number of available tiles (including the jokers)
+    unsigned int nbtiles;
+    /// Sum of the points of the available tiles (jokers are worth 0)
+    unsigned int points;
+    unsigned int nbfound;
+    wchar_t word[DIC_WORD_MAX];
+    /**
+     * Results found so far. When maxresults is not 0, this is a heap
+     * whose front is the worst kept result
+     */
+    vector<anagram_t> results;
+};
+
+void Dictionary::searchAnagramsRec(struct params_anagram_t &params,
+                                   unsigned int iDepth, const DicEdge *edgeptr,
+                                   unsigned int iScore) const
+{
+    /* depth first search in the dictionary */
+    do
+    {
+        /* the test is false only when reach the end-node */
+        if (!edgeptr->chr)
+            continue;
+
+        // Use a real tile when possible, and a joker otherwise.
+        // All the occurrences of a letter are worth the same number
+        // of points, so this always gives the best score for the word,
+        // and each word is reached only once
+        const unsigned int code = edgeptr->chr;
+        const bool joker = params.letters[code] == 0;
+        if (joker && params.letters[0] == 0)
+            continue;
+
+        const unsigned int points = joker ? 0 : getHeader().getPoints(code);
+        const wchar_t chr = getHeader().getCharFromCode(code);
+        params.word[iDepth] = joker ? towlower(chr) : chr;
+        params.letters[joker ? 0 : code]--;
+        params.nbtiles--;
+        params.points -= points;
+
+        const unsigned int len = iDepth + 1;
+        const unsigned int score = iScore + points;
+        const bool full = params.maxresults &&
+            params.results.size() == params.maxresults;
+
+        if (edgeptr->term && len >= params.minlength &&
+            (!full || score > params.results.front().points))
+        {
+            // Add the solution
+            anagram_t found = { score, params.nbfound++, wstring(params.word, len) };
+            if (params.maxresults == 0)
+                params.results.push_back(found);
+            else
+            {
+                if (full)
+                {
+                    pop_heap(params.results.begin(), params.results.end(), betterAnagram);
+                    params.results.pop_back();
+                }
+                params.results.push_back(found);
+                push_heap(params.results.begin(), params.results.end(), betterAnagram);
+            }
+        }
+
+        // Go deeper, unless even the remaining tiles cannot give
+        // a better score than the worst kept result.
+        // Words found later are after in the dictionary order, so an
+        // equal score is not enough to be kept.
+        if (len < params.maxlength && params.nbtiles > 0 &&
+            !(params.maxresults && params.results.size() == params.maxresults &&
+              score + params.points <= params.results.front().points))
+        {
+            searchAnagramsRec(params, len, getEdgeAt(edgeptr->ptr), score);
+        }
+
+        params.points += points;
+        params.nbtiles++;
+        params.letters[joker ? 0 : code]++;
+    } while (! (*edgeptr++).last);
+}
+
+
+void Dictionary::searchAnagrams(const wstring &iRack,
+                                vector<pair<wdstring, unsigned int> > &oWordList,
+                                unsigned int iMinLength,
+                                unsigned int iMaxLength,
+                                unsigned int iMaxResults) const
+{
+    if (iRack == L"")
+        return;
+
+    struct params_anagram_t params;
+    params.minlength = iMinLength;
+    params.maxlength = min<unsigned int>(iMaxLength, DIC_WORD_MAX - 1);
+    params.maxresults = iMaxResults;
+    params.nbtiles = 0;
+    params.points = 0;
+    params.nbfound = 0;
+    for (unsigned int &letter : params.letters)
+        letter = 0;
+
+    /*
+     * the letters are verified and changed to the dic internal
+     * representation (using getCodeFromChar(*r))
+     */
+    for (wchar_t r : iRack)
+    {
+        if (iswalpha(r))
+        {
+            const unsigned int code = getHeader().getCodeFromChar(towupper(r));
+            params.letters[code]++;
+            params.points += getHeader().getPoints(code);
+        }
+        else if (r == L'?')
+            params.letters[0]++;
+        else
+            continue;
+        params.nbtiles++;
+    }
+
+    if (params.nbtiles < 1 || params.minlength > params.maxlength)
+        return;
+
+    if (iMaxResults)
+        params.results.reserve(iMaxResults);
+    else
+        params.results.reserve(DEFAULT_VECT_ALLOC);
+
+    const DicEdge *root_edge = getEdgeAt(getRoot());
+    searchAnagramsRec(params, 0, getEdgeAt(root_edge->ptr), 0);
+
+    std::sort(params.results.begin(), params.results.end(), betterAnagram);
+    oWordList.reserve(oWordList.size() + params.results.size());
+    for (const anagram_t &found : params.results)
+        oWordList.emplace_back(convertToDisplay(found.word), found.points);
+}
+
+/****************************************/
+/****************************************/
+
 void Dictionary::searchRacc(const wstring &iWord,
                             vector<wdstring> &oWordList,
                             unsigned int iMaxResults) const
@@ -268,6 +432,35 @@ void Dictionary::searchRacc(const wstring &iWord,
     }
 }
 
+
+void Dictionary::searchHooks(const wstring &iWord, uint64_t &oFrontHooks,
+                             uint64_t &oBackHooks) const
+{
+    oFrontHooks = 0;
+    oBackHooks = 0;
+    if (iWord == L"")
+        return;
+
+    // Try to add a letter at the front
+    const DicEdge *edge = getEdgeAt(getEdgeAt(getRoot())->ptr);
+    do
+    {
+        if (seekEdgePtr(iWord.c_str(), edge)->term)
+            oFrontHooks |= (uint64_t)1 << edge->chr;
+    } while (!(*edge++).last);
+
+    // Try to add a letter at the end
+    edge = getEdgeAt(seekEdgePtr(iWord.c_str(), getEdgeAt(getRoot()))->ptr);
+    if (edge != getEdgeAt(0))
+    {
+        do
+        {
+            if (edge->term)
+                oBackHooks |= (uint64_t)1 << edge->chr;
+        } while (!(*edge++).last);
+    }
+}
+
 /****************************************/
 /****************************************/
 
@@ -314,6 +507,35 @@ void Dictionary::searchBenj(const wstring &iWord, vector<wdstring> &oWordList,
     } while (!(*edge0++).last);
 }
 
+
+void Dictionary::searchBenjCodes(const wstring &iWord,
+                                 vector<array<dic_code_t, 3>> &oPrefixes) const
+{
+    if (iWord == L"")
+        return;
+
+    const DicEdge *edge0, *edge1, *edge2;
+    edge0 = getEdgeAt(getRoot());
+    edge0 = getEdgeAt(edge0->ptr);
+    do
+    {
+        edge1 = getEdgeAt(edge0->ptr);
+        do
+        {
+            edge2 = getEdgeAt(edge1->ptr);
+            do
+            {
+                if (seekEdgePtr(iWord.c_str(), edge2)->term)
+                {
+                    oPrefixes.push_back({(dic_code_t)edge0->chr,
+                                         (dic_code_t)edge1->chr,
+                                         (dic_code_t)edge2->chr});
+                }
+            } while (!(*edge2++).last);
+        } while (!(*edge1++).last);
+    } while (!(*edge0++).last);
+}
+
 /****************************************/
 /****************************************/
 
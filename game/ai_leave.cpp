@@ -0,0 +1,75 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "rack.h"
+#include "pldrack.h"
+#include "move.h"
+#include "results.h"
+#include "board.h"
+#include "move_selector.h"
+#include "leave_table.h"
+#include "ai_leave.h"
+#include "encoding.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, AILeave);
+
+
+AILeave::AILeave(std::shared_ptr<const LeaveTable> iLeaves)
+    : m_leaves(std::move(iLeaves)), m_results(0)
+{
+    ASSERT(m_leaves != nullptr, "No leave table");
+}
+
+
+void AILeave::compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord)
+{
+    // All the rounds are needed, since the best one is not necessarily
+    // among the highest scores
+    const Rack &rack = getCurrentRack().getRack();
+    m_results.search(iDic, iBoard, rack, iFirstWord);
+    compute(iDic, iBoard, m_results);
+}
+
+
+void AILeave::compute(const Dictionary &iDic, const Board &iBoard,
+                      const Results &iAllResults)
+{
+    if (iAllResults.isEmpty())
+    {
+        // If there is no result, pass the turn (see AIPercent)
+        m_move = Move(L"");
+        return;
+    }
+
+    const Rack &rack = getCurrentRack().getRack();
+    MoveSelector selector(iDic, iBoard, rack, m_leaves.get());
+    m_move = Move(selector.selectBest(iAllResults));
+    LOG_DEBUG("Chosen round: {} ({} points)",
+              lfw(m_move.getRound().getWord()), m_move.getScore());
+}
+
+
+Move AILeave::getMove() const
+{
+    return m_move;
+}
+
@@ -0,0 +1,66 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef AI_LEAVE_H_
+#define AI_LEAVE_H_
+
+#include <memory>
+
+#include "ai_player.h"
+#include "results.h"
+#include "move.h"
+#include "logging.h"
+
+class LeaveTable;
+
+/**
+ * This kind of AI plays the round maximizing the sum of its score and of
+ * the value of the letters remaining on the rack, as given by a leave
+ * table (see LeaveTable). It is stronger than AIPercent in free games,
+ * where the remaining letters are kept for the next turn.
+ * Like AIPercent, this AI will never change letters.
+ */
+class AILeave: public AIPlayer
+{
+    DEFINE_LOGGER();
+public:
+    /// Constructor, taking the leave table (which can be shared by several players)
+    explicit AILeave(std::shared_ptr<const LeaveTable> iLeaves);
+
+    const LeaveTable & getLeaveTable() const { return *m_leaves; }
+
+    void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord) override;
+    void compute(const Dictionary &iDic, const Board &iBoard,
+                 const Results &iAllResults) override;
+    bool needsAllRounds() const override { return true; }
+
+    /// Return the move played by the AI
+    Move getMove() const override;
+
+private:
+    std::shared_ptr<const LeaveTable> m_leaves;
+    /// Container for all the found solutions
+    LimitResults m_results;
+    /// Move chosen by the last computation
+    Move m_move;
+};
+
+#endif
+
@@ -0,0 +1,232 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+
+#include "dic.h"
+#include "rack.h"
+#include "pldrack.h"
+#include "round.h"
+#include "move.h"
+#include "results.h"
+#include "board.h"
+#include "game_params.h"
+#include "leave_table.h"
+#include "ai_montecarlo.h"
+#include "thread_pool.h"
+#include "random.h"
+#include "encoding.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, AIMonteCarlo);
+
+
+AIMonteCarlo::AIMonteCarlo(const Params &iParams,
+                           std::shared_ptr<const LeaveTable> iLeaves)
+    : m_params(iParams), m_leaves(std::move(iLeaves)),
+    m_results(std::max(iParams.nbCandidates, 1u))
+{
+    ASSERT(m_params.nbCandidates > 0, "No candidate round");
+    ASSERT(m_params.timeBudget > 0 || m_params.maxIterations > 0,
+           "The number of simulations is not bounded");
+}
+
+
+void AIMonteCarlo::compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord)
+{
+    const Rack &rack = getCurrentRack().getRack();
+    m_results.search(iDic, iBoard, rack, iFirstWord);
+    compute(iDic, iBoard, m_results);
+}
+
+
+void AIMonteCarlo::compute(const Dictionary &iDic, const Board &iBoard,
+                           const Results &iAllResults)
+{
+    if (iAllResults.isEmpty())
+    {
+        // If there is no result, pass the turn (see AIPercent)
+        m_move = Move(L"");
+        return;
+    }
+
+    // The results are sorted by decreasing scores
+    vector<Round> candidates;
+    for (unsigned i = 0; i < iAllResults.size() && i < m_params.nbCandidates; ++i)
+        candidates.push_back(iAllResults.get(i));
+    if (candidates.size() == 1)
+    {
+        m_move = Move(candidates[0]);
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(m_params.timeBudget);
+
+    const Rack &rack = getCurrentRack().getRack();
+    const vector<Tile> &unseen = getUnseenTiles(iDic, iBoard, rack);
+    const unsigned nbCandidates = candidates.size();
+    vector<double> totals(nbCandidates, 0);
+
+    // Each batch contains a few iterations, so that all the threads
+    // of the pool are busy even with a small number of candidates
+    ThreadPool &pool = ThreadPool::Instance();
+    unsigned nbIterations = 0;
+    do
+    {
+        unsigned batchSize = pool.getNbThreads();
+        if (m_params.maxIterations > 0)
+            batchSize = std::min(batchSize, m_params.maxIterations - nbIterations);
+
+        // The random draws are done here, with the engine of the game,
+        // so that the simulations do not depend on the number of threads
+        vector<vector<Tile>> draws(batchSize, unseen);
+        for (vector<Tile> &iterDraws : draws)
+            std::shuffle(iterDraws.begin(), iterDraws.end(), Random::getEngine());
+
+        // The tasks starting after the deadline are skipped, so that a
+        // batch does not exceed the time budget by much. The first
+        // iteration is always simulated, to have a result.
+        vector<float> equities(batchSize * nbCandidates);
+        vector<char> simulated(equities.size(), 0);
+        pool.run(equities.size(), [&](unsigned iTask) {
+            const unsigned iteration = nbIterations + iTask / nbCandidates;
+            if (iteration > 0 && m_params.timeBudget > 0 &&
+                std::chrono::steady_clock::now() >= deadline)
+            {
+                return;
+            }
+            equities[iTask] = simulate(iDic, iBoard, rack,
+                                       candidates[iTask % nbCandidates],
+                                       draws[iTask / nbCandidates]);
+            simulated[iTask] = 1;
+        });
+
+        // Only the iterations simulated for all the candidates are kept,
+        // to compare the candidates on the same draws
+        for (unsigned i = 0; i < batchSize; ++i)
+        {
+            const auto first = simulated.begin() + i * nbCandidates;
+            if (std::find(first, first + nbCandidates, 0) != first + nbCandidates)
+                continue;
+            for (unsigned j = 0; j < nbCandidates; ++j)
+                totals[j] += equities[i * nbCandidates + j];
+            ++nbIterations;
+        }
+    } while ((m_params.maxIterations == 0 || nbIterations < m_params.maxIterations) &&
+             (m_params.timeBudget == 0 || std::chrono::steady_clock::now() < deadline));
+
+    // All the candidates have the same number of iterations, so the best
+    // total is also the best average. In case of equality, the first
+    // candidate (i.e. the one with the highest score) wins.
+    const unsigned bestIndex =
+        std::max_element(totals.begin(), totals.end()) - totals.begin();
+    m_move = Move(candidates[bestIndex]);
+
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    LOG_DEBUG("Chosen round: {} ({} points, average equity: {}) after {} iterations in {} ms",
+              lfw(m_move.getRound().getWord()), m_move.getScore(),
+              totals[bestIndex] / nbIterations, nbIterations, time.count());
+}
+
+
+vector<Tile> AIMonteCarlo::getUnseenTiles(const Dictionary &iDic, const Board &iBoard,
+                                          const Rack &iRack) const
+{
+    // Number of seen tiles, indexed by code
+    vector<unsigned> seen(iDic.getTileNumber() + 1, 0);
+    for (int row = BOARD_MIN; row <= BOARD_MAX; ++row)
+    {
+        for (int col = BOARD_MIN; col <= BOARD_MAX; ++col)
+        {
+            if (iBoard.isVacant(row, col))
+                continue;
+            const Tile &tile = iBoard.isJoker(row, col) ?
+                Tile::Joker() : iBoard.getTile(row, col);
+            ++seen[tile.toCode()];
+        }
+    }
+
+    vector<Tile> unseen;
+    for (const Tile &tile : iDic.getAllTiles())
+    {
+        const unsigned seenCount = seen[tile.toCode()] + iRack.count(tile);
+        // The count can be exceeded with the joker variants
+        for (unsigned i = seenCount; i < tile.maxNumber(); ++i)
+            unseen.push_back(tile);
+    }
+    return unseen;
+}
+
+
+float AIMonteCarlo::simulate(const Dictionary &iDic, const Board &iBoard,
+                             const Rack &iRack, const Round &iCandidate,
+                             const vector<Tile> &iDraws) const
+{
+    // Board::addRound() updates the board incrementally, so playing the
+    // plies on a copy of the board is cheap
+    Board board(iBoard);
+    board.addRound(iDic, iCandidate);
+    float equity = iCandidate.getPoints();
+
+    Rack ownRack = iRack;
+    ownRack.removePlayedTiles(iCandidate);
+    Rack opponentRack;
+
+    const unsigned rackSize = iBoard.getParams().getRackSize();
+    unsigned nextDraw = 0;
+    for (unsigned ply = 0; ply < m_params.nbPlies; ++ply)
+    {
+        // The opponent plays first
+        const bool isOpponent = ply % 2 == 0;
+        Rack &rack = isOpponent ? opponentRack : ownRack;
+        while (rack.getNbTiles() < rackSize && nextDraw < iDraws.size())
+            rack.add(iDraws[nextDraw++]);
+        if (rack.isEmpty())
+            break;
+
+        BestResults results;
+        board.search(iDic, rack, results);
+        if (results.isEmpty())
+            continue;
+
+        const Round &round = results.get(0);
+        board.addRound(iDic, round);
+        rack.removePlayedTiles(round);
+        equity += isOpponent ? -round.getPoints() : round.getPoints();
+    }
+
+    // The rack of the player is only completed before its own plies,
+    // so it still contains the leave of its last round
+    if (m_leaves != nullptr)
+        equity += m_leaves->getValue(ownRack);
+
+    return equity;
+}
+
+
+Move AIMonteCarlo::getMove() const
+{
+    return m_move;
+}
+
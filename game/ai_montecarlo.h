@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef AI_MONTECARLO_H_
+#define AI_MONTECARLO_H_
+
+#include <memory>
+#include <vector>
+
+#include "ai_player.h"
+#include "tile.h"
+#include "results.h"
+#include "move.h"
+#include "logging.h"
+
+class LeaveTable;
+class Rack;
+
+using std::vector;
+
+/**
+ * This kind of AI simulates the next turns of the game for the best
+ * rounds found by the search, and plays the round with the best average
+ * result. It is meant for free games.
+ *
+ * Each simulation (or iteration) draws a random rack for the opponent
+ * among the unseen tiles (i.e. the tiles which are neither on the board
+ * nor on the rack of the player), then plays a few plies on a copy of the
+ * board, each side playing its best score. The equity of a candidate
+ * round is its score, minus the scores of the opponent, plus the scores
+ * of the player in the following plies (and plus the value of the final
+ * leave, if a leave table is given).
+ * The same racks are used for all the candidates of an iteration, to make
+ * the comparison fairer.
+ *
+ * The simulations are run in parallel in the ThreadPool, until the time
+ * budget or the maximal number of iterations is reached, whichever comes
+ * first. At least one iteration is always done.
+ * Like AIPercent, this AI will never change letters.
+ */
+class AIMonteCarlo: public AIPlayer
+{
+    DEFINE_LOGGER();
+public:
+    struct Params
+    {
+        /// Number of rounds evaluated with simulations
+        unsigned nbCandidates{10};
+        /// Number of plies simulated after the candidate round
+        unsigned nbPlies{2};
+        /// Time budget for a turn, in milliseconds (0 for no limit)
+        unsigned timeBudget{1000};
+        /// Maximal number of iterations (0 for no limit)
+        unsigned maxIterations{0};
+    };
+
+    /**
+     * Constructor. The leave table (which can be shared by several players)
+     * is optional
+     */
+    AIMonteCarlo(const Params &iParams,
+                 std::shared_ptr<const LeaveTable> iLeaves = nullptr);
+
+    const Params & getParams() const { return m_params; }
+    const LeaveTable * getLeaveTable() const { return m_leaves.get(); }
+
+    void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord) override;
+    void compute(const Dictionary &iDic, const Board &iBoard,
+                 const Results &iAllResults) override;
+    bool needsAllRounds() const override { return false; }
+
+    /// Return the move played by the AI
+    Move getMove() const override;
+
+private:
+    Params m_params;
+    std::shared_ptr<const LeaveTable> m_leaves;
+    /// Container for the candidate rounds
+    TopResults m_results;
+    /// Move chosen by the last computation
+    Move m_move;
+
+    /// Return the tiles which are neither on the board nor on the rack
+    vector<Tile> getUnseenTiles(const Dictionary &iDic, const Board &iBoard,
+                                const Rack &iRack) const;
+
+    /**
+     * Play the given candidate round and the following plies on a copy
+     * of the board, the unseen tiles being drawn in the order of iDraws.
+     * Return the equity of the candidate for this simulation.
+     */
+    float simulate(const Dictionary &iDic, const Board &iBoard,
+                   const Rack &iRack, const Round &iCandidate,
+                   const vector<Tile> &iDraws) const;
+};
+
+#endif
+
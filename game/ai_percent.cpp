@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <cmath>
+
 #include "tile.h"
 #include "rack.h"
 #include "pldrack.h"
@@ -59,22 +61,54 @@ void AIPercent::compute(const Dictionary &iDic, const Board &iBoard, bool iFirst
 
     const Rack &rack = getCurrentRack().getRack();
     m_results->search(iDic, iBoard, rack, iFirstWord);
-}
-
 
-Move AIPercent::getMove() const
-{
     if (m_results->isEmpty())
     {
         // If there is no result, pass the turn.
         // FIXME: in duplicate mode, we should return a move of type NO_MOVE
         // instead of one of type PASS
-        return {L""};
+        m_move = Move(L"");
     }
     else
     {
         // TODO: use MoveSelector to select a correct move
-        return Move(m_results->get(0));
+        m_move = Move(m_results->get(0));
     }
 }
 
+
+void AIPercent::compute(const Dictionary &, const Board &,
+                        const Results &iAllResults)
+{
+    m_results->clear();
+
+    if (iAllResults.isEmpty())
+    {
+        // See above
+        m_move = Move(L"");
+        return;
+    }
+
+    // Choose the same round as PercentResults (or BestResults) would:
+    // the first one with the lowest score at least equal to the given
+    // percentage of the best score. The rounds are sorted by decreasing
+    // score, so the search can stop at the first round below this score.
+    const int minScore = lrint(ceil(iAllResults.getPoints(0) * m_percent));
+    unsigned chosen = 0;
+    for (unsigned i = 1; i < iAllResults.size(); ++i)
+    {
+        const int points = iAllResults.getPoints(i);
+        if (points < minScore)
+            break;
+        if (points < iAllResults.getPoints(chosen))
+            chosen = i;
+    }
+    m_move = Move(iAllResults.get(chosen));
+}
+
+
+Move AIPercent::getMove() const
+{
+    return m_move;
+}
+
@@ -23,6 +23,7 @@
 
 #include "ai_player.h"
 #include "results.h"
+#include "move.h"
 #include "logging.h"
 
 /**
@@ -51,6 +52,9 @@ public:
      * of the following methods, so it must prepare everything for them.
      */
     void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord) override;
+    void compute(const Dictionary &iDic, const Board &iBoard,
+                 const Results &iAllResults) override;
+    bool needsAllRounds() const override { return m_percent < 1; }
 
     /// Return the move played by the AI
     Move getMove() const override;
@@ -59,6 +63,8 @@ private:
     float m_percent;
     /// Container for all the found solutions
     Results *m_results;
+    /// Move chosen by the last computation
+    Move m_move;
 };
 
 #endif
@@ -27,6 +27,7 @@ class Dictionary;
 class Round;
 class Board;
 class Tile;
+class Results;
 
 /**
  * This class is a pure interface, that must be implemented by all the AI
@@ -72,6 +73,23 @@ public:
      */
     virtual void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord) = 0;
 
+    /**
+     * Alternative to compute(), where the move is chosen among the given
+     * results instead of performing a search. The results must contain all
+     * the rounds which can be played with the rack of the player, sorted as
+     * usual. This allows several players having the same rack (in duplicate
+     * mode) to share a single search.
+     */
+    virtual void compute(const Dictionary &iDic, const Board &iBoard,
+                         const Results &iAllResults) = 0;
+
+    /**
+     * Return true if the search of the player needs all the rounds,
+     * and false if it can prune the rounds with the lowest scores.
+     * Sharing a complete search is only worth it in the first case.
+     */
+    virtual bool needsAllRounds() const = 0;
+
     /// Return the move played by the AI
     virtual Move getMove() const = 0;
 
@@ -21,126 +21,210 @@
 
 
 #include <random> // For uniform_int_distribution()
+#include <algorithm>
+#include <bit>
+#include <type_traits>
 
 #include <dic.h>
 #include "bag.h"
 #include "debug.h"
 #include "encoding.h"
 #include "random.h"
+#include "game_exception.h"
 
 
 INIT_LOGGER(game, Bag);
 
 
 Bag::Bag(const Dictionary &iDic)
-    : m_dic(iDic)
+    : m_dic(iDic), m_jokerSlot(kNoSlot), m_state()
 {
-    for (const Tile &tile : m_dic.getAllTiles())
+    static_assert(std::is_trivially_copyable_v<State>);
+    std::fill(std::begin(m_slotOfCode), std::end(m_slotOfCode), kNoSlot);
+
+    // Give the slots in the order of the keys of a map<Tile, int>,
+    // to keep the random draws of the previous implementation
+    vector<Tile> tiles = m_dic.getAllTiles();
+    std::stable_sort(tiles.begin(), tiles.end());
+    ASSERT(tiles.size() <= kNbSlots, "Too many tiles in the dictionary");
+
+    for (const Tile &tile : tiles)
     {
-        m_tilesMap[tile] = tile.maxNumber();
-        m_nbTiles += tile.maxNumber();
+        const unsigned slot = m_nbSlots++;
+        m_codeOfSlot[slot] = tile.toCode();
+        if (tile.isJoker())
+            m_jokerSlot = slot;
+        else
+            m_slotOfCode[tile.toCode()] = slot;
+        if (tile.isVowel())
+            m_vowelSlots |= uint64_t(1) << slot;
+        if (tile.isConsonant())
+            m_consonantSlots |= uint64_t(1) << slot;
+        updateSlot(slot, tile.maxNumber());
     }
 }
 
 
-unsigned Bag::count(const Tile &iTile) const
+unsigned Bag::getSlot(const Tile &iTile) const
 {
-    auto it = m_tilesMap.find(iTile);
-    if (it != m_tilesMap.end())
-        return it->second;
-    return 0;
+    if (iTile.isJoker())
+        return m_jokerSlot;
+    const unsigned code = iTile.toCode();
+    if (code >= kNbSlots)
+        return kNoSlot;
+    return m_slotOfCode[code];
 }
 
 
-unsigned Bag::getNbVowels() const
+unsigned Bag::getValidSlot(const Tile &iTile) const
 {
-    int v = 0;
-    for (const auto &[tile, count] : m_tilesMap)
-    {
-        if (tile.isVowel())
-            v += count;
-    }
-    return v;
+    const unsigned slot = getSlot(iTile);
+    if (slot == kNoSlot)
+        throw GameException("Invalid tile for the bag: " + lfw(iTile.getDisplayStr()));
+    return slot;
 }
 
 
-unsigned Bag::getNbConsonants() const
+void Bag::updateSlot(unsigned iSlot, int iDelta)
 {
-    int c = 0;
-    for (const auto &[tile, count] : m_tilesMap)
+    const bool isVowel = (m_vowelSlots >> iSlot) & 1;
+    const bool isConsonant = (m_consonantSlots >> iSlot) & 1;
+
+    m_state.counts[iSlot] += iDelta;
+    m_state.nbTiles += iDelta;
+    if (isVowel)
+        m_state.nbVowels += iDelta;
+    if (isConsonant)
+        m_state.nbConsonants += iDelta;
+
+    for (unsigned i = iSlot + 1; i <= kNbSlots; i += i & (~i + 1))
     {
-        if (tile.isConsonant())
-            c += count;
+        m_state.trees[kALL_TILES][i] += iDelta;
+        if (isVowel)
+            m_state.trees[kVOWELS][i] += iDelta;
+        if (isConsonant)
+            m_state.trees[kCONSONANTS][i] += iDelta;
     }
-    return c;
+}
+
+
+unsigned Bag::count(const Tile &iTile) const
+{
+    const unsigned slot = getSlot(iTile);
+    if (slot == kNoSlot)
+        return 0;
+    return m_state.counts[slot];
 }
 
 
 void Bag::takeTile(const Tile &iTile)
 {
-    ASSERT(contains(iTile),
+    const unsigned slot = getValidSlot(iTile);
+    ASSERT(m_state.counts[slot] > 0,
            "The bag does not contain the letter " + lfw(iTile.getDisplayStr()));
 
-    m_tilesMap[iTile]--;
-    m_nbTiles--;
+    updateSlot(slot, -1);
 }
 
 
 void Bag::replaceTile(const Tile &iTile)
 {
-    ASSERT(count(iTile) < iTile.maxNumber(),
+    const unsigned slot = getValidSlot(iTile);
+    ASSERT(m_state.counts[slot] < iTile.maxNumber(),
            "Cannot replace tile: " + lfw(iTile.getDisplayStr()));
 
-    m_tilesMap[iTile]++;
-    m_nbTiles++;
+    updateSlot(slot, 1);
+}
+
+
+void Bag::takeTiles(const vector<Tile> &iTiles)
+{
+    updateSlots(iTiles, -1);
+}
+
+
+void Bag::replaceTiles(const vector<Tile> &iTiles)
+{
+    updateSlots(iTiles, 1);
+}
+
+
+void Bag::updateSlots(const vector<Tile> &iTiles, int iSign)
+{
+    // Group the tiles by slot first, so that the Fenwick trees are
+    // updated once per letter instead of once per tile
+    int deltas[kNbSlots];
+    uint64_t usedSlots = 0;
+    for (const Tile &tile : iTiles)
+    {
+        const unsigned slot = getValidSlot(tile);
+        const uint64_t bit = uint64_t(1) << slot;
+        if (!(usedSlots & bit))
+            deltas[slot] = 0;
+        usedSlots |= bit;
+        deltas[slot] += iSign;
+    }
+
+    while (usedSlots != 0)
+    {
+        const unsigned slot = std::countr_zero(usedSlots);
+        usedSlots &= usedSlots - 1;
+        ASSERT(m_state.counts[slot] + deltas[slot] >= 0 &&
+               m_state.counts[slot] + deltas[slot] <=
+               (int)m_dic.getTileFromCode(m_codeOfSlot[slot]).maxNumber(),
+               "Invalid number of tiles in the bag: " +
+               lfw(m_dic.getTileFromCode(m_codeOfSlot[slot]).getDisplayStr()));
+        updateSlot(slot, deltas[slot]);
+    }
 }
 
 
 Tile Bag::selectRandom() const
 {
-    return selectRandomTile(m_nbTiles, false, false);
+    return selectRandomTile(getNbTiles(), kALL_TILES);
 }
 
 
 Tile Bag::selectRandomVowel() const
 {
-    return selectRandomTile(getNbVowels(), true, false);
+    return selectRandomTile(getNbVowels(), kVOWELS);
 }
 
 
 Tile Bag::selectRandomConsonant() const
 {
-    return selectRandomTile(getNbConsonants(), false, true);
+    return selectRandomTile(getNbConsonants(), kCONSONANTS);
 }
 
 
-Tile Bag::selectRandomTile(unsigned total,
-                           bool onlyVowels, bool onlyConsonants) const
+Tile Bag::selectRandomTile(unsigned total, TreeKind iKind) const
 {
     ASSERT(total > 0, "Not enough tiles (of the requested kind) in the bag");
 
     std::uniform_int_distribution<int> dist(0, total -1);
-    int n = dist(Random::getEngine());
-    for (const auto &[tile, count] : m_tilesMap)
+    unsigned n = dist(Random::getEngine());
+
+    // Descend the Fenwick tree, to find the first slot
+    // where the cumulated count exceeds n
+    const uint16_t *tree = m_state.trees[iKind];
+    unsigned pos = 0;
+    for (unsigned step = kNbSlots; step > 0; step /= 2)
     {
-        if (onlyVowels && !tile.isVowel())
-            continue;
-        if (onlyConsonants && !tile.isConsonant())
-            continue;
-        if (n < count)
-            return tile;
-        n -= count;
+        if (pos + step <= kNbSlots && tree[pos + step] <= n)
+        {
+            pos += step;
+            n -= tree[pos];
+        }
     }
-    ASSERT(false, "We should not come here");
-    return {};
+    ASSERT(pos < m_nbSlots, "We should not come here");
+    return m_dic.getTileFromCode(m_codeOfSlot[pos]);
 }
 
 
 Bag & Bag::operator=(const Bag &iOther)
 {
-    m_tilesMap = iOther.m_tilesMap;
-    m_nbTiles = iOther.m_nbTiles;
+    ASSERT(&m_dic == &iOther.m_dic, "Cannot copy a bag using another dictionary");
+    m_state = iOther.m_state;
     return *this;
 }
 
-
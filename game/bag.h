@@ -22,17 +22,24 @@
 #ifndef BAG_H_
 #define BAG_H_
 
-#include <map>
+#include <stdint.h>
 #include "tile.h"
 #include "logging.h"
 
-using std::map;
-
 class Dictionary;
 
 
 /**
  * A bag stores the set of free tiles for the game.
+ *
+ * The tiles are counted in a fixed-size array, with one slot per letter
+ * of the dictionary. The slots follow the order of the tiles (as defined
+ * by Tile::operator<), so the random draws do not depend on this
+ * representation. The number of vowels and consonants is maintained as
+ * tiles come and go, and Fenwick trees over the slots allow drawing
+ * a random tile in logarithmic time.
+ * All this state is stored in plain arrays, so copying a bag (to compute
+ * the real bag, for instance) is a simple memcpy.
  */
 class Bag
 {
@@ -40,11 +47,25 @@ class Bag
 public:
     explicit Bag(const Dictionary &iDic);
 
-    /// Take a tile in the bag
+    /**
+     * Take a tile in the bag.
+     * A GameException is thrown if the tile is not a letter of the dictionary.
+     */
     void takeTile(const Tile &iTile);
-    /// Replace a tile into the bag
+    /**
+     * Replace a tile into the bag.
+     * A GameException is thrown if the tile is not a letter of the dictionary.
+     */
     void replaceTile(const Tile &iTile);
 
+    /**
+     * Take (or replace) all the given tiles, typically the tiles of a rack.
+     * This is equivalent to calling takeTile() (or replaceTile()) for each
+     * tile, but the counters are updated only once per letter.
+     */
+    void takeTiles(const vector<Tile> &iTiles);
+    void replaceTiles(const vector<Tile> &iTiles);
+
     /// Count how many tiles identical to iTile are available in the bag
     unsigned count(const Tile &iTile) const;
 
@@ -59,9 +80,9 @@ public:
      * Warning: b.getNbVowels() + b.getNbConsonants() != b.getNbTiles(),
      * because of the jokers and the 'Y'.
      */
-    unsigned getNbTiles() const { return m_nbTiles; }
-    unsigned getNbVowels() const;
-    unsigned getNbConsonants() const;
+    unsigned getNbTiles() const { return m_state.nbTiles; }
+    unsigned getNbVowels() const { return m_state.nbVowels; }
+    unsigned getNbConsonants() const { return m_state.nbConsonants; }
 
     /**
      * Return a random available tile
@@ -81,24 +102,74 @@ public:
      */
     Tile selectRandomConsonant() const;
 
+    Bag(const Bag &iOther) = default;
     Bag & operator=(const Bag &iOther);
 
     /// Convenience getter on the dictionary
     const Dictionary & getDic() const { return m_dic; }
 
 private:
+    /// Maximal number of slots (the dictionaries have at most 63 letters)
+    static const unsigned kNbSlots = 64;
+    /// Value of m_slotOfCode for the codes not used by the dictionary
+    static const uint8_t kNoSlot = 0xff;
+
+    /// Index of the Fenwick trees, in State::trees
+    enum TreeKind
+    {
+        kALL_TILES = 0,
+        kVOWELS = 1,
+        kCONSONANTS = 2,
+        kNB_TREES = 3
+    };
+
     /// Dictionary
     const Dictionary &m_dic;
 
-    /// Associate to each tile its number of occurrences in the bag
-    map<Tile, int> m_tilesMap;
-
-    /// Total number of tiles in the bag
-    unsigned m_nbTiles{0};
+    /// Slot of each tile, indexed by the code of the tile
+    uint8_t m_slotOfCode[kNbSlots];
+    /// Slot of the jokers (all the jokers are equivalent, as for Tile::operator<)
+    uint8_t m_jokerSlot;
+    /// Code of the tile of each slot
+    uint8_t m_codeOfSlot[kNbSlots];
+    /// Number of slots actually used
+    unsigned m_nbSlots{0};
+    /// Bit masks of the slots containing vowels and consonants
+    uint64_t m_vowelSlots{0};
+    uint64_t m_consonantSlots{0};
+
+    /// Contents of the bag, copied as a whole by operator=()
+    struct State
+    {
+        /// Number of tiles in each slot
+        uint16_t counts[kNbSlots];
+        /**
+         * Fenwick trees of the counts, for all the tiles, the vowels only,
+         * and the consonants only. The trees are indexed from 1.
+         */
+        uint16_t trees[kNB_TREES][kNbSlots + 1];
+        /// Total number of tiles in the bag
+        unsigned nbTiles;
+        /// Number of vowels in the bag
+        unsigned nbVowels;
+        /// Number of consonants in the bag
+        unsigned nbConsonants;
+    };
+    State m_state;
+
+    /// Return the slot of the given tile (kNoSlot if it is not a valid tile)
+    unsigned getSlot(const Tile &iTile) const;
+    /// Return the slot of the given tile, and throw if it is not a valid tile
+    unsigned getValidSlot(const Tile &iTile) const;
+
+    /// Add iDelta tiles in the given slot, and update the counters
+    void updateSlot(unsigned iSlot, int iDelta);
+
+    /// Add (iSign == 1) or remove (iSign == -1) all the given tiles
+    void updateSlots(const vector<Tile> &iTiles, int iSign);
 
     /// Helper method, used by the various selectRandom*() methods
-    Tile selectRandomTile(unsigned total,
-                          bool onlyVowels, bool onlyConsonants) const;
+    Tile selectRandomTile(unsigned total, TreeKind iKind) const;
 };
 
 #endif
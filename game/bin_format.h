@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BIN_FORMAT_H_
+#define BIN_FORMAT_H_
+
+#include <stdint.h>
+
+
+/**
+ * Description of the binary format of the saved games, written by
+ * BinWriter and read by BinReader. It contains the same information as
+ * the XML format (without the statistics), but it is much faster to load.
+ *
+ * The file is made of:
+ *  - a FileHeader;
+ *  - the letters of the dictionary (string);
+ *  - the players: for each one, its ID (u32), table number (u32), type
+ *    (u8, see PlayerType), level (u8), Monte-Carlo parameters (4 x i32,
+ *    only for kAI_MONTECARLO), name (string) and leave table (string);
+ *  - the turn index: nbTurns + 1 offsets (u32, from the beginning of the
+ *    file), the records of turn i being between offsets i and i + 1;
+ *  - the records of the turns.
+ *
+ * A record starts with its type (u8, see RecordType), followed by:
+ *  - for the player records, the player ID (u32);
+ *  - for the racks: a flag (u8, 1 if the rack was rejected), the number
+ *    of old and new tiles (u8 each), and the tiles;
+ *  - for the moves: the move type (u8, see MoveType), then for a valid
+ *    round: row, column, direction, length (u8 each), points (i32), bonus
+ *    flag (u8) and tiles; for an invalid move: word and coordinates
+ *    (strings); for a change of letters: the letters (string);
+ *  - for the topping moves: the move, followed by the elapsed time (i32);
+ *  - for the penalties, solos and end game points: the points (i32).
+ *
+ * The tiles are stored on one byte: the code of the letter in the
+ * dictionary (6 bits), kTILE_JOKER if the tile is a joker, and
+ * kTILE_FROM_RACK if the tile of a round was played from the rack.
+ * The strings are stored as their length (u16) followed by the UTF-8
+ * characters. The integers are stored with the byte order of the machine
+ * which wrote the file (checked with the byteOrder field).
+ */
+class BinFormat
+{
+public:
+    static constexpr char kMAGIC[8] = {'E', 'L', 'I', 'O', 'T', 'G', 'M', '\0'};
+    static const uint32_t kVERSION = 1;
+    static const uint32_t kBYTE_ORDER = 0x01020304;
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        /// Used to detect files written on a machine with another endianness
+        uint32_t byteOrder;
+        /// Number of words of the dictionary
+        uint32_t nbWords;
+        /// Game mode (GameParams::GameMode)
+        uint8_t mode;
+        /// Game variants (GameParams::GameVariant flags)
+        uint8_t variants;
+        uint16_t nbPlayers;
+        uint32_t nbTurns;
+        /// Reserved for future extensions, always 0 for now (the files
+        /// with other values are rejected)
+        uint32_t flags;
+    };
+
+    enum PlayerType: uint8_t
+    {
+        kHUMAN = 0,
+        kAI_PERCENT = 1,
+        kAI_LEAVE = 2,
+        kAI_MONTECARLO = 3
+    };
+
+    enum RecordType: uint8_t
+    {
+        kGAME_RACK = 0,
+        kPLAYER_RACK = 1,
+        kGAME_MOVE = 2,
+        kPLAYER_MOVE = 3,
+        kMASTER_MOVE = 4,
+        kTOPPING_MOVE = 5,
+        kWARNING = 6,
+        kPENALTY = 7,
+        kSOLO = 8,
+        kEND_GAME = 9
+    };
+
+    enum MoveType: uint8_t
+    {
+        kMOVE_VALID = 0,
+        kMOVE_INVALID = 1,
+        kMOVE_CHANGE = 2,
+        kMOVE_PASS = 3,
+        kMOVE_NONE = 4
+    };
+
+    static const uint8_t kTILE_CODE_MASK = 0x3f;
+    static const uint8_t kTILE_JOKER = 0x40;
+    static const uint8_t kTILE_FROM_RACK = 0x80;
+
+    /// Return true for the records related to a player
+    static bool HasPlayer(RecordType iType)
+    {
+        return iType != kGAME_RACK && iType != kGAME_MOVE && iType != kMASTER_MOVE;
+    }
+};
+
+#endif
+
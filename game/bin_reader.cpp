@@ -0,0 +1,563 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include <fstream>
+#include <memory>
+#include <set>
+#include <cstring>
+
+#ifdef HAVE_SYS_MMAN_H
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+#include "bin_reader.h"
+#include "dic.h"
+#include "header.h"
+#include "game_exception.h"
+#include "game_factory.h"
+#include "duplicate.h"
+#include "player.h"
+#include "ai_percent.h"
+#include "ai_leave.h"
+#include "ai_montecarlo.h"
+#include "leave_table.h"
+#include "round.h"
+#include "encoding.h"
+#include "navigation.h"
+#include "cmd/game_rack_cmd.h"
+#include "cmd/game_move_cmd.h"
+#include "cmd/player_rack_cmd.h"
+#include "cmd/player_move_cmd.h"
+#include "cmd/player_event_cmd.h"
+#include "cmd/master_move_cmd.h"
+#include "cmd/topping_move_cmd.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, BinReader);
+
+
+/// Sequential reading of a part of the file, with bounds checking
+class BinReader::Cursor
+{
+public:
+    Cursor(const char *iData, size_t iPos, size_t iEnd, const string &iFileName)
+        : m_data(iData), m_pos(iPos), m_end(iEnd), m_fileName(iFileName) {}
+
+    template<typename T>
+    T get()
+    {
+        check(sizeof(T));
+        T value;
+        memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    string getString()
+    {
+        const uint16_t len = get<uint16_t>();
+        check(len);
+        string str(m_data + m_pos, len);
+        m_pos += len;
+        return str;
+    }
+
+    wstring getWString()
+    {
+        return readFromUTF8(getString(), "Loading game");
+    }
+
+    size_t getPos() const { return m_pos; }
+    bool atEnd() const { return m_pos == m_end; }
+
+    [[noreturn]] void fail() const
+    {
+        throw LoadGameException(_fmt(_("Invalid saved game: '{0}'"), m_fileName));
+    }
+
+private:
+    const char *m_data;
+    size_t m_pos;
+    size_t m_end;
+    const string &m_fileName;
+
+    void check(size_t iSize) const
+    {
+        if (m_pos + iSize > m_end)
+            fail();
+    }
+};
+
+
+BinReader::BinReader(const string &iFileName, const Dictionary &iDic)
+    : m_fileName(iFileName), m_dic(iDic), m_params(iDic)
+{
+#ifdef HAVE_SYS_MMAN_H
+    int fd = open(iFileName.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                m_mapping = addr;
+                m_mappingSize = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    if (m_mapping != nullptr)
+    {
+        m_data = static_cast<const char *>(m_mapping);
+        m_size = m_mappingSize;
+        try
+        {
+            init();
+        }
+        catch (...)
+        {
+            munmap(m_mapping, m_mappingSize);
+            throw;
+        }
+        return;
+    }
+#endif
+
+    // Read the whole file instead
+    ifstream file(iFileName.c_str(), ios::in | ios::binary | ios::ate);
+    if (!file.is_open())
+        throw LoadGameException(_fmt(_("Cannot open file '{0}'"), iFileName));
+    m_size = file.tellg();
+    m_buffer.resize((m_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(m_buffer.data()), m_size))
+        throw LoadGameException(_fmt(_("Cannot read file '{0}'"), iFileName));
+    m_data = reinterpret_cast<const char *>(m_buffer.data());
+    init();
+}
+
+
+BinReader::~BinReader()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (m_mapping != nullptr)
+        munmap(m_mapping, m_mappingSize);
+#endif
+}
+
+
+bool BinReader::IsBinFile(const string &iFileName)
+{
+    ifstream file(iFileName.c_str(), ios::in | ios::binary);
+    char magic[sizeof(BinFormat::kMAGIC)];
+    if (!file.read(magic, sizeof(magic)))
+        return false;
+    return memcmp(magic, BinFormat::kMAGIC, sizeof(magic)) == 0;
+}
+
+
+Game * BinReader::read(const string &iFileName, const Dictionary &iDic)
+{
+    LOG_INFO("Reading binary savegame '{}'", iFileName);
+    BinReader reader(iFileName, iDic);
+    return reader.createGame();
+}
+
+
+void BinReader::init()
+{
+    Cursor cursor(m_data, 0, m_size, m_fileName);
+    const auto header = cursor.get<BinFormat::FileHeader>();
+    if (memcmp(header.magic, BinFormat::kMAGIC, sizeof(BinFormat::kMAGIC)) != 0 ||
+        header.version != BinFormat::kVERSION ||
+        header.byteOrder != BinFormat::kBYTE_ORDER)
+    {
+        LOG_ERROR("Incompatible save game format: current={} savegame={}",
+                  BinFormat::kVERSION, header.version);
+        throw LoadGameException(_("This saved game is not compatible with the current version of Eliot."));
+    }
+    // The flags are reserved for extensions of the format, which this
+    // version would not be able to read
+    if (header.flags != 0)
+    {
+        LOG_ERROR("Unknown flags in the savegame: {:#x}", header.flags);
+        throw LoadGameException(_("This saved game is not compatible with the current version of Eliot."));
+    }
+
+    // Validate the dictionary
+    if (header.nbWords != m_dic.getHeader().getNbWords() ||
+        cursor.getWString() != m_dic.getHeader().getLetters())
+    {
+        throw LoadGameException(_("The current dictionary is different from the one used in the saved game"));
+    }
+
+    if (header.mode > GameParams::kTOPPING)
+        cursor.fail();
+    m_params.setMode(static_cast<GameParams::GameMode>(header.mode));
+    for (GameParams::GameVariant variant :
+         {GameParams::kJOKER, GameParams::kEXPLOSIVE, GameParams::k7AMONG8})
+    {
+        if (header.variants & variant)
+            m_params.addVariant(variant);
+    }
+
+    for (unsigned i = 0; i < header.nbPlayers; ++i)
+    {
+        PlayerInfo info;
+        info.id = cursor.get<uint32_t>();
+        info.tableNb = cursor.get<uint32_t>();
+        const auto type = cursor.get<uint8_t>();
+        if (type > BinFormat::kAI_MONTECARLO)
+            cursor.fail();
+        info.type = static_cast<BinFormat::PlayerType>(type);
+        info.level = cursor.get<uint8_t>();
+        if (info.type == BinFormat::kAI_MONTECARLO)
+        {
+            for (int32_t &param : info.monteCarlo)
+                param = cursor.get<int32_t>();
+        }
+        info.name = cursor.getWString();
+        info.leaveTable = cursor.getString();
+        m_players.push_back(info);
+    }
+
+    // The offsets of the turns are checked when reading them.
+    // The number of turns is converted before adding 1, so that a huge
+    // value cannot wrap around and pass the check
+    m_nbTurns = header.nbTurns;
+    m_indexPos = cursor.getPos();
+    if ((m_size - m_indexPos) / sizeof(uint32_t) < static_cast<uint64_t>(m_nbTurns) + 1)
+        cursor.fail();
+
+    LOG_DEBUG("Binary savegame {}: {} players, {} turns",
+              m_fileName, m_players.size(), m_nbTurns);
+}
+
+
+Tile BinReader::readTile(Cursor &ioCursor, const Dictionary &iDic, bool *oFromRack)
+{
+    const auto byte = ioCursor.get<uint8_t>();
+    const unsigned code = byte & BinFormat::kTILE_CODE_MASK;
+    if (code == 0 || code > iDic.getHeader().getLetters().size())
+        ioCursor.fail();
+    if (oFromRack != nullptr)
+        *oFromRack = byte & BinFormat::kTILE_FROM_RACK;
+    return Tile(code, byte & BinFormat::kTILE_JOKER);
+}
+
+
+PlayedRack BinReader::readRack(Cursor &ioCursor, const Dictionary &iDic)
+{
+    PlayedRack rack;
+    rack.setReject(ioCursor.get<uint8_t>() != 0);
+    const unsigned nbOld = ioCursor.get<uint8_t>();
+    const unsigned nbNew = ioCursor.get<uint8_t>();
+    for (unsigned i = 0; i < nbOld; ++i)
+        rack.addOld(readTile(ioCursor, iDic));
+    for (unsigned i = 0; i < nbNew; ++i)
+        rack.addNew(readTile(ioCursor, iDic));
+    return rack;
+}
+
+
+Move BinReader::readMove(Cursor &ioCursor, const Dictionary &iDic)
+{
+    const auto type = ioCursor.get<uint8_t>();
+    if (type == BinFormat::kMOVE_VALID)
+    {
+        Round round;
+        const int row = ioCursor.get<uint8_t>();
+        const int col = ioCursor.get<uint8_t>();
+        const int dir = ioCursor.get<uint8_t>();
+        const unsigned len = ioCursor.get<uint8_t>();
+        if (row < BOARD_MIN || row > BOARD_MAX || col < BOARD_MIN || col > BOARD_MAX ||
+            dir > 1 || len == 0 || len > Round::kMaxLen)
+        {
+            ioCursor.fail();
+        }
+        round.accessCoord() = Coord(row, col, dir == 0 ? Coord::HORIZONTAL : Coord::VERTICAL);
+        round.setPoints(ioCursor.get<int32_t>());
+        round.setBonus(ioCursor.get<uint8_t>() != 0);
+        for (unsigned i = 0; i < len; ++i)
+        {
+            bool fromRack;
+            const Tile &tile = readTile(ioCursor, iDic, &fromRack);
+            if (fromRack)
+                round.addRightFromRack(Tile(tile.toCode(), false), tile.isJoker());
+            else
+                round.addRightFromBoard(tile);
+        }
+        return Move(round);
+    }
+    else if (type == BinFormat::kMOVE_INVALID)
+    {
+        const wstring &word = ioCursor.getWString();
+        const wstring &coord = ioCursor.getWString();
+        return {word, coord};
+    }
+    else if (type == BinFormat::kMOVE_CHANGE)
+        return {ioCursor.getWString()};
+    else if (type == BinFormat::kMOVE_PASS)
+        return {L""};
+    else if (type == BinFormat::kMOVE_NONE)
+        return {};
+    ioCursor.fail();
+}
+
+
+/**
+ * Check a move decoded from the file against the board of the game,
+ * like XmlReader does: the points, the bonus and the origin of the tiles
+ * must be the ones computed for the word and its coordinates.
+ * This also ensures that a valid move fits on the board.
+ */
+static void checkMove(const Game &iGame, const Move &iMove)
+{
+    if (!iMove.isValid())
+        return;
+    if (iGame.getNPlayers() == 0)
+        throw LoadGameException(_("A game with a move must have players"));
+
+    const Round &round = iMove.getRound();
+    const wstring &word = iGame.getDic().convertFromInput(round.getWord());
+    Move move;
+    int res = iGame.checkPlayedWord(round.getCoord().toString(), word, move, false);
+    if (res != 0 || !(move.getRound() == round))
+    {
+        throw LoadGameException(_fmt(_("Invalid move marked as valid: {0} ({1})"),
+                                     lfw(round.getWord()),
+                                     lfw(round.getCoord().toString())));
+    }
+}
+
+
+BinReader::Record BinReader::readRecord(Cursor &ioCursor, const Dictionary &iDic)
+{
+    Record record;
+    const auto type = ioCursor.get<uint8_t>();
+    if (type > BinFormat::kEND_GAME)
+        ioCursor.fail();
+    record.type = static_cast<BinFormat::RecordType>(type);
+    if (BinFormat::HasPlayer(record.type))
+        record.playerId = ioCursor.get<uint32_t>();
+
+    switch (record.type)
+    {
+        case BinFormat::kGAME_RACK:
+        case BinFormat::kPLAYER_RACK:
+            record.rack = readRack(ioCursor, iDic);
+            break;
+        case BinFormat::kGAME_MOVE:
+        case BinFormat::kPLAYER_MOVE:
+        case BinFormat::kMASTER_MOVE:
+            record.move = readMove(ioCursor, iDic);
+            break;
+        case BinFormat::kTOPPING_MOVE:
+            record.move = readMove(ioCursor, iDic);
+            record.value = ioCursor.get<int32_t>();
+            break;
+        case BinFormat::kWARNING:
+            break;
+        case BinFormat::kPENALTY:
+        case BinFormat::kSOLO:
+        case BinFormat::kEND_GAME:
+            record.value = ioCursor.get<int32_t>();
+            break;
+    }
+    return record;
+}
+
+
+BinReader::Record BinReader::DecodeRecord(const string &iData, const Dictionary &iDic,
+                                          const string &iFileName)
+{
+    Cursor cursor(iData.data(), 0, iData.size(), iFileName);
+    Record record = readRecord(cursor, iDic);
+    if (!cursor.atEnd())
+        cursor.fail();
+    return record;
+}
+
+
+vector<BinReader::Record> BinReader::readTurn(unsigned iTurn) const
+{
+    ASSERT(iTurn < m_nbTurns, "Invalid turn number");
+
+    uint32_t offsets[2];
+    memcpy(offsets, m_data + m_indexPos + iTurn * sizeof(uint32_t), sizeof(offsets));
+    Cursor cursor(m_data, offsets[0], offsets[1], m_fileName);
+    const uint64_t recordsStart =
+        m_indexPos + (static_cast<uint64_t>(m_nbTurns) + 1) * sizeof(uint32_t);
+    if (offsets[0] < recordsStart || offsets[0] > offsets[1] || offsets[1] > m_size)
+        cursor.fail();
+
+    vector<Record> records;
+    while (!cursor.atEnd())
+        records.push_back(readRecord(cursor, m_dic));
+    return records;
+}
+
+
+Player * BinReader::createPlayer(const PlayerInfo &iInfo) const
+{
+    Player *p;
+    if (iInfo.type == BinFormat::kHUMAN)
+        p = new HumanPlayer();
+    else
+    {
+        shared_ptr<const LeaveTable> leaves;
+        if (iInfo.leaveTable != "")
+        {
+            try
+            {
+                leaves = std::make_shared<const LeaveTable>(iInfo.leaveTable, m_dic);
+            }
+            catch (const GameException &)
+            {
+                // The table is not available anymore: fall back
+                // to the usual AI, to be able to load the game anyway
+            }
+        }
+        if (iInfo.type == BinFormat::kAI_MONTECARLO)
+        {
+            const int32_t *mc = iInfo.monteCarlo;
+            if (mc[0] <= 0 || mc[1] < 0 || mc[2] < 0 || mc[3] < 0 ||
+                (mc[2] == 0 && mc[3] == 0))
+            {
+                throw LoadGameException(_("Invalid Monte-Carlo parameters"));
+            }
+            AIMonteCarlo::Params params;
+            params.nbCandidates = mc[0];
+            params.nbPlies = mc[1];
+            params.timeBudget = mc[2];
+            params.maxIterations = mc[3];
+            p = new AIMonteCarlo(params, leaves);
+        }
+        else if (leaves)
+            p = new AILeave(leaves);
+        else
+            p = new AIPercent(0.01 * iInfo.level);
+    }
+
+    p->setId(iInfo.id);
+    p->setName(iInfo.name);
+    p->setTableNb(iInfo.tableNb);
+    return p;
+}
+
+
+Command * BinReader::CreateCommand(Game &ioGame,
+                                   const map<unsigned int, Player*> &iPlayers,
+                                   const Record &iRecord)
+{
+    auto getPlayer = [&]() -> Player & {
+        auto it = iPlayers.find(iRecord.playerId);
+        if (it == iPlayers.end())
+            throw LoadGameException(_fmt(_("Invalid player ID: {0}"), iRecord.playerId));
+        return *it->second;
+    };
+
+    // FIXME: this is game-related logic (see XmlReader)
+    const bool isArbitrationGame = ioGame.getParams().getMode() == GameParams::kARBITRATION;
+
+    checkMove(ioGame, iRecord.move);
+
+    switch (iRecord.type)
+    {
+        case BinFormat::kGAME_RACK:
+            return new GameRackCmd(ioGame, iRecord.rack);
+        case BinFormat::kPLAYER_RACK:
+            return new PlayerRackCmd(getPlayer(), iRecord.rack);
+        case BinFormat::kGAME_MOVE:
+            return new GameMoveCmd(ioGame, iRecord.move);
+        case BinFormat::kPLAYER_MOVE:
+            return new PlayerMoveCmd(getPlayer(), iRecord.move, isArbitrationGame);
+        case BinFormat::kMASTER_MOVE:
+        {
+            auto *duplicateGame = dynamic_cast<Duplicate*>(&ioGame);
+            if (duplicateGame == nullptr)
+                throw LoadGameException(_("Master moves are only allowed in duplicate games"));
+            return new MasterMoveCmd(*duplicateGame, iRecord.move);
+        }
+        case BinFormat::kTOPPING_MOVE:
+            return new ToppingMoveCmd(iRecord.playerId, iRecord.move, iRecord.value);
+        case BinFormat::kWARNING:
+            return new PlayerEventCmd(getPlayer(), PlayerEventCmd::WARNING);
+        case BinFormat::kPENALTY:
+            return new PlayerEventCmd(getPlayer(), PlayerEventCmd::PENALTY, iRecord.value);
+        case BinFormat::kSOLO:
+            return new PlayerEventCmd(getPlayer(), PlayerEventCmd::SOLO, iRecord.value);
+        case BinFormat::kEND_GAME:
+            return new PlayerEventCmd(getPlayer(), PlayerEventCmd::END_GAME, iRecord.value);
+    }
+    throw LoadGameException(_("Invalid record type"));
+}
+
+
+Game * BinReader::createGame() const
+{
+    unique_ptr<Game> game(GameFactory::Instance()->createGame(m_params));
+
+    map<unsigned int, Player*> allPlayers;
+    for (const PlayerInfo &info : m_players)
+    {
+        Player *player = createPlayer(info);
+        if (allPlayers.find(player->getId()) != allPlayers.end())
+        {
+            delete player;
+            throw LoadGameException(_fmt(_("A player ID must be unique: {0}"), info.id));
+        }
+        allPlayers[player->getId()] = player;
+        game->addPlayer(player);
+    }
+
+    Navigation &navigation = game->accessNavigation();
+    for (unsigned turn = 0; turn < m_nbTurns; ++turn)
+    {
+        // End the previous turn
+        if (turn > 0)
+            navigation.newTurn();
+
+        for (const Record &record : readTurn(turn))
+        {
+            unique_ptr<Command> cmd(CreateCommand(*game, allPlayers, record));
+            navigation.addAndExecute(cmd.get());
+            cmd.release();
+        }
+    }
+
+    LOG_INFO("Binary savegame read successfully");
+    return game.release();
+}
+
@@ -0,0 +1,160 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BIN_READER_H_
+#define BIN_READER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+#include "logging.h"
+#include "game_params.h"
+#include "bin_format.h"
+#include "pldrack.h"
+#include "move.h"
+
+class Dictionary;
+class Game;
+class Player;
+class Command;
+
+using namespace std;
+
+
+/**
+ * Read a game saved in the binary format (see BinFormat).
+ *
+ * The file is mapped in memory (when possible), and only the header and
+ * the players are decoded by the constructor: the turns are decoded on
+ * demand, with readTurn(). This allows browsing big archives of games
+ * quickly, without creating the Game objects. On the other hand,
+ * createGame() decodes and replays all the turns as soon as the game is
+ * loaded, like the XmlReader class.
+ *
+ * A LoadGameException is thrown if the file is invalid, or if it was not
+ * saved with the given dictionary.
+ */
+class BinReader
+{
+    DEFINE_LOGGER();
+public:
+    BinReader(const string &iFileName, const Dictionary &iDic);
+    ~BinReader();
+
+    BinReader(const BinReader &) = delete;
+    BinReader & operator=(const BinReader &) = delete;
+
+    /// Return true if the given file starts like a binary saved game
+    static bool IsBinFile(const string &iFileName);
+
+    /// Create a Game object from the given file (see createGame())
+    static Game * read(const string &iFileName, const Dictionary &iDic);
+
+    const GameParams & getParams() const { return m_params; }
+
+    unsigned getNbPlayers() const { return m_players.size(); }
+    unsigned getNbTurns() const { return m_nbTurns; }
+
+    /// Decoded command of a turn
+    struct Record
+    {
+        BinFormat::RecordType type;
+        /// ID of the player (for the player records)
+        unsigned int playerId{0};
+        /// Rack (for kGAME_RACK and kPLAYER_RACK)
+        PlayedRack rack;
+        /// Move (for kGAME_MOVE, kPLAYER_MOVE, kMASTER_MOVE, kTOPPING_MOVE)
+        Move move;
+        /// Points of the events, or elapsed time of the topping moves
+        int value{0};
+    };
+
+    /// Decode the commands of the given turn (starting from 0)
+    vector<Record> readTurn(unsigned iTurn) const;
+
+    /// Create the game, and replay all its turns
+    Game * createGame() const;
+
+    /**
+     * Decode a single record, which must fill the given data completely
+     * (used by the Journal class). The file name is only used in the
+     * error messages.
+     */
+    static Record DecodeRecord(const string &iData, const Dictionary &iDic,
+                               const string &iFileName);
+
+    /**
+     * Create the command corresponding to the given record, for the given
+     * game. The players are found in iPlayers, using the player IDs.
+     * A valid move must be playable on the current board of the game, with
+     * the points, bonus and tile origins given in the record (otherwise a
+     * LoadGameException is thrown).
+     */
+    static Command * CreateCommand(Game &ioGame,
+                                   const map<unsigned int, Player*> &iPlayers,
+                                   const Record &iRecord);
+
+private:
+    string m_fileName;
+    const Dictionary &m_dic;
+    GameParams m_params;
+
+    /// Mapping of the file (if it could be mapped)
+    void *m_mapping{nullptr};
+    size_t m_mappingSize{0};
+    /// Contents of the file (if it could not be mapped)
+    vector<uint64_t> m_buffer;
+
+    const char *m_data{nullptr};
+    size_t m_size{0};
+
+    unsigned m_nbTurns{0};
+    /// Position of the turn index in the file
+    size_t m_indexPos{0};
+
+    struct PlayerInfo
+    {
+        unsigned int id;
+        unsigned int tableNb;
+        BinFormat::PlayerType type;
+        int level;
+        int32_t monteCarlo[4];
+        wstring name;
+        string leaveTable;
+    };
+    vector<PlayerInfo> m_players;
+
+    class Cursor;
+
+    /// Check the header, and decode the players
+    void init();
+
+    static Tile readTile(Cursor &ioCursor, const Dictionary &iDic,
+                         bool *oFromRack = nullptr);
+    static PlayedRack readRack(Cursor &ioCursor, const Dictionary &iDic);
+    static Move readMove(Cursor &ioCursor, const Dictionary &iDic);
+    static Record readRecord(Cursor &ioCursor, const Dictionary &iDic);
+    Player * createPlayer(const PlayerInfo &iInfo) const;
+};
+
+#endif
+
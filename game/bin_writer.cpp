@@ -0,0 +1,356 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#ifdef HAVE_UNISTD_H
+#   include <unistd.h>
+#endif
+
+#include "bin_writer.h"
+#include "bin_format.h"
+#include "encoding.h"
+#include "game.h"
+#include "player.h"
+#include "ai_percent.h"
+#include "ai_leave.h"
+#include "ai_montecarlo.h"
+#include "leave_table.h"
+#include "game_exception.h"
+#include "turn.h"
+#include "cmd/game_rack_cmd.h"
+#include "cmd/game_move_cmd.h"
+#include "cmd/player_rack_cmd.h"
+#include "cmd/player_move_cmd.h"
+#include "cmd/player_event_cmd.h"
+#include "cmd/master_move_cmd.h"
+#include "cmd/topping_move_cmd.h"
+#include "dic.h"
+#include "header.h"
+#include "debug.h"
+
+
+using namespace std;
+
+INIT_LOGGER(game, BinWriter);
+
+
+template<typename T>
+static void put(string &ioData, T iValue)
+{
+    ioData.append(reinterpret_cast<const char *>(&iValue), sizeof(iValue));
+}
+
+
+static void putString(string &ioData, const string &iStr)
+{
+    if (iStr.size() > UINT16_MAX)
+        throw SaveGameException(_("String too long"));
+    put<uint16_t>(ioData, iStr.size());
+    ioData += iStr;
+}
+
+
+static void putString(string &ioData, const wstring &iStr)
+{
+    putString(ioData, writeInUTF8(iStr, "Saving game"));
+}
+
+
+static void putTile(string &ioData, const Tile &iTile, bool iFromRack)
+{
+    uint8_t byte = iTile.toCode();
+    ASSERT((byte & ~BinFormat::kTILE_CODE_MASK) == 0, "Invalid tile code");
+    if (iTile.isJoker())
+        byte |= BinFormat::kTILE_JOKER;
+    if (iFromRack)
+        byte |= BinFormat::kTILE_FROM_RACK;
+    put<uint8_t>(ioData, byte);
+}
+
+
+static void putRack(string &ioData, const PlayedRack &iRack)
+{
+    vector<Tile> oldTiles;
+    vector<Tile> newTiles;
+    iRack.getOldTiles(oldTiles);
+    iRack.getNewTiles(newTiles);
+    put<uint8_t>(ioData, iRack.isReject());
+    put<uint8_t>(ioData, oldTiles.size());
+    put<uint8_t>(ioData, newTiles.size());
+    for (const Tile &tile : oldTiles)
+        putTile(ioData, tile, false);
+    for (const Tile &tile : newTiles)
+        putTile(ioData, tile, false);
+}
+
+
+static void putMove(string &ioData, const Move &iMove)
+{
+    if (iMove.isValid())
+    {
+        const Round &round = iMove.getRound();
+        const Coord &coord = round.getCoord();
+        put<uint8_t>(ioData, BinFormat::kMOVE_VALID);
+        put<uint8_t>(ioData, coord.getRow());
+        put<uint8_t>(ioData, coord.getCol());
+        put<uint8_t>(ioData, coord.getDir() == Coord::HORIZONTAL ? 0 : 1);
+        put<uint8_t>(ioData, round.getWordLen());
+        put<int32_t>(ioData, round.getPoints());
+        put<uint8_t>(ioData, round.getBonus());
+        for (unsigned int i = 0; i < round.getWordLen(); ++i)
+            putTile(ioData, round.getTile(i), round.isPlayedFromRack(i));
+    }
+    else if (iMove.isInvalid())
+    {
+        put<uint8_t>(ioData, BinFormat::kMOVE_INVALID);
+        putString(ioData, iMove.getBadWord());
+        putString(ioData, iMove.getBadCoord());
+    }
+    else if (iMove.isChangeLetters())
+    {
+        put<uint8_t>(ioData, BinFormat::kMOVE_CHANGE);
+        putString(ioData, iMove.getChangedLetters());
+    }
+    else if (iMove.isPass())
+        put<uint8_t>(ioData, BinFormat::kMOVE_PASS);
+    else if (iMove.isNull())
+        put<uint8_t>(ioData, BinFormat::kMOVE_NONE);
+    else
+        throw SaveGameException(_fmt(_("Unsupported move: {0}"), lfw(iMove.toString())));
+}
+
+
+static void putPlayer(string &ioData, const Player &iPlayer)
+{
+    put<uint32_t>(ioData, iPlayer.getId());
+    put<uint32_t>(ioData, iPlayer.getTableNb());
+
+    string leaveTable;
+    if (iPlayer.isHuman())
+    {
+        put<uint8_t>(ioData, BinFormat::kHUMAN);
+        put<uint8_t>(ioData, 0);
+    }
+    else if (const auto *ai = dynamic_cast<const AIPercent *>(&iPlayer))
+    {
+        put<uint8_t>(ioData, BinFormat::kAI_PERCENT);
+        put<uint8_t>(ioData, lrint(ai->getPercent() * 100));
+    }
+    else if (const auto *aiLeave = dynamic_cast<const AILeave *>(&iPlayer))
+    {
+        put<uint8_t>(ioData, BinFormat::kAI_LEAVE);
+        // The level is used if the leave table cannot be loaded
+        put<uint8_t>(ioData, 100);
+        leaveTable = aiLeave->getLeaveTable().getFileName();
+    }
+    else if (const auto *aiMC = dynamic_cast<const AIMonteCarlo *>(&iPlayer))
+    {
+        put<uint8_t>(ioData, BinFormat::kAI_MONTECARLO);
+        put<uint8_t>(ioData, 100);
+        const AIMonteCarlo::Params &params = aiMC->getParams();
+        put<int32_t>(ioData, params.nbCandidates);
+        put<int32_t>(ioData, params.nbPlies);
+        put<int32_t>(ioData, params.timeBudget);
+        put<int32_t>(ioData, params.maxIterations);
+        if (aiMC->getLeaveTable() != nullptr)
+            leaveTable = aiMC->getLeaveTable()->getFileName();
+    }
+    else
+        throw SaveGameException(_fmt(_("Invalid player type for player {0}"), iPlayer.getId()));
+
+    putString(ioData, iPlayer.getName());
+    putString(ioData, leaveTable);
+}
+
+
+bool BinWriter::IsSaved(const Command &iCmd)
+{
+    if (const auto *eventCmd = dynamic_cast<const PlayerEventCmd*>(&iCmd))
+    {
+        return eventCmd->getEventType() == PlayerEventCmd::WARNING ||
+            eventCmd->getEventType() == PlayerEventCmd::PENALTY ||
+            eventCmd->getEventType() == PlayerEventCmd::SOLO ||
+            eventCmd->getEventType() == PlayerEventCmd::END_GAME;
+    }
+    return dynamic_cast<const GameRackCmd*>(&iCmd) != nullptr ||
+        dynamic_cast<const PlayerRackCmd*>(&iCmd) != nullptr ||
+        dynamic_cast<const PlayerMoveCmd*>(&iCmd) != nullptr ||
+        dynamic_cast<const GameMoveCmd*>(&iCmd) != nullptr ||
+        dynamic_cast<const MasterMoveCmd*>(&iCmd) != nullptr ||
+        dynamic_cast<const ToppingMoveCmd*>(&iCmd) != nullptr;
+}
+
+
+void BinWriter::putCommand(string &ioData, const Command &iCmd)
+{
+    if (const auto *rackCmd = dynamic_cast<const GameRackCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kGAME_RACK);
+        putRack(ioData, rackCmd->getRack());
+    }
+    else if (const auto *pRackCmd = dynamic_cast<const PlayerRackCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kPLAYER_RACK);
+        put<uint32_t>(ioData, pRackCmd->getPlayer().getId());
+        putRack(ioData, pRackCmd->getRack());
+    }
+    else if (const auto *pMoveCmd = dynamic_cast<const PlayerMoveCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kPLAYER_MOVE);
+        put<uint32_t>(ioData, pMoveCmd->getPlayer().getId());
+        putMove(ioData, pMoveCmd->getMove());
+    }
+    else if (const auto *moveCmd = dynamic_cast<const GameMoveCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kGAME_MOVE);
+        putMove(ioData, moveCmd->getMove());
+    }
+    else if (const auto *masterCmd = dynamic_cast<const MasterMoveCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kMASTER_MOVE);
+        putMove(ioData, masterCmd->getMove());
+    }
+    else if (const auto *toppingCmd = dynamic_cast<const ToppingMoveCmd*>(&iCmd))
+    {
+        put<uint8_t>(ioData, BinFormat::kTOPPING_MOVE);
+        put<uint32_t>(ioData, toppingCmd->getPlayerId());
+        putMove(ioData, toppingCmd->getMove());
+        put<int32_t>(ioData, toppingCmd->getElapsedTime());
+    }
+    else if (const auto *eventCmd = dynamic_cast<const PlayerEventCmd*>(&iCmd))
+    {
+        BinFormat::RecordType type;
+        if (eventCmd->getEventType() == PlayerEventCmd::WARNING)
+            type = BinFormat::kWARNING;
+        else if (eventCmd->getEventType() == PlayerEventCmd::PENALTY)
+            type = BinFormat::kPENALTY;
+        else if (eventCmd->getEventType() == PlayerEventCmd::SOLO)
+            type = BinFormat::kSOLO;
+        else if (eventCmd->getEventType() == PlayerEventCmd::END_GAME)
+            type = BinFormat::kEND_GAME;
+        else
+        {
+            LOG_ERROR("Unknown event type: {}", static_cast<int>(eventCmd->getEventType()));
+            return;
+        }
+        put<uint8_t>(ioData, type);
+        put<uint32_t>(ioData, eventCmd->getPlayer().getId());
+        if (type != BinFormat::kWARNING)
+            put<int32_t>(ioData, eventCmd->getPoints());
+    }
+    else
+    {
+        // Same behaviour as the XML format
+        LOG_ERROR("Unsupported command: {}", lfw(iCmd.toString()));
+    }
+}
+
+
+void BinWriter::write(const Game &iGame, const string &iFileName)
+{
+    // Like in the XML format, an empty last turn is not saved
+    const vector<Turn *> &turns = iGame.getNavigation().getTurns();
+    unsigned nbTurns = turns.size();
+    if (nbTurns > 0 && turns.back()->getCommands().empty())
+        --nbTurns;
+
+    BinFormat::FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BinFormat::kMAGIC, sizeof(BinFormat::kMAGIC));
+    header.version = BinFormat::kVERSION;
+    header.byteOrder = BinFormat::kBYTE_ORDER;
+    header.nbWords = iGame.getDic().getHeader().getNbWords();
+    header.mode = iGame.getMode();
+    const GameParams &params = iGame.getParams();
+    for (GameParams::GameVariant variant :
+         {GameParams::kJOKER, GameParams::kEXPLOSIVE, GameParams::k7AMONG8})
+    {
+        if (params.hasVariant(variant))
+            header.variants |= variant;
+    }
+    header.nbPlayers = iGame.getNPlayers();
+    header.nbTurns = nbTurns;
+
+    // Header, dictionary and players
+    string data;
+    put(data, header);
+    putString(data, iGame.getDic().getHeader().getLetters());
+    for (unsigned int i = 0; i < iGame.getNPlayers(); ++i)
+        putPlayer(data, iGame.getPlayer(i));
+
+    // Records of the turns, and their index
+    string records;
+    vector<uint32_t> offsets;
+    for (unsigned i = 0; i < nbTurns; ++i)
+    {
+        offsets.push_back(records.size());
+        for (const Command *cmd : turns[i]->getCommands())
+            putCommand(records, *cmd);
+    }
+    offsets.push_back(records.size());
+    const size_t recordsStart = data.size() + offsets.size() * sizeof(uint32_t);
+    if (recordsStart + records.size() > UINT32_MAX)
+        throw SaveGameException(_("The game is too big to be saved"));
+    for (uint32_t offset : offsets)
+        put<uint32_t>(data, recordsStart + offset);
+    data += records;
+
+    // Write a temporary file and rename it, so that a crash never leaves
+    // a truncated save (the previous one is kept instead)
+    const string tmpFileName = iFileName + ".tmp";
+    FILE *file = fopen(tmpFileName.c_str(), "wb");
+    if (file == nullptr)
+        throw SaveGameException(_fmt(_("Cannot open file for writing: '{0}'"), tmpFileName));
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size() &&
+              fflush(file) == 0;
+#ifdef HAVE_UNISTD_H
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        remove(tmpFileName.c_str());
+        throw SaveGameException(_fmt(_("Cannot write file '{0}'"), tmpFileName));
+    }
+#ifdef WIN32
+    // rename() does not replace an existing file on Windows
+    remove(iFileName.c_str());
+#endif
+    if (rename(tmpFileName.c_str(), iFileName.c_str()) != 0)
+    {
+        remove(tmpFileName.c_str());
+        throw SaveGameException(_fmt(_("Cannot write file '{0}'"), iFileName));
+    }
+    LOG_INFO("Saved game {} ({} turns, {} bytes)", iFileName, nbTurns, data.size());
+}
+
@@ -0,0 +1,55 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BIN_WRITER_H_
+#define BIN_WRITER_H_
+
+#include <string>
+
+#include "logging.h"
+
+class Game;
+class Command;
+
+using std::string;
+
+
+/**
+ * Save a game in the binary format (see BinFormat)
+ */
+class BinWriter
+{
+    DEFINE_LOGGER();
+public:
+    /// The method throws a SaveGameException in case of problem
+    static void write(const Game &iGame, const string &iFileName);
+
+    /**
+     * Return true if the given command is saved (like in the XML format,
+     * the commands which can be deduced from the others are not)
+     */
+    static bool IsSaved(const Command &iCmd);
+
+    /// Append the record of the given command to ioData, if it is saved
+    static void putCommand(string &ioData, const Command &iCmd);
+};
+
+#endif
+
@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <algorithm>
+#include <memory>
 #include <cwctype>
 #include <cstdio>
 #include <format>
@@ -33,45 +35,100 @@
 #include "round.h"
 #include "rack.h"
 #include "results.h"
+#include "search_control.h"
+#include "thread_pool.h"
+#include "random.h"
 #include "encoding.h"
 #include "debug.h"
 
-#define BOARD_REALDIM (BOARD_DIM + 2)
-
 
 INIT_LOGGER(game, Board);
 
 
-Board::Board(const GameParams &iParams):
+/// Mix the bits of iValue (one step of the SplitMix64 generator)
+static uint64_t MixBits(uint64_t iValue)
+{
+    return Random::mixBits(iValue + 0x9E3779B97F4A7C15ULL);
+}
+
+
+/**
+ * Random value associated to a tile (encoded like in BoardGrid) on
+ * a square of the board, for the Zobrist hash of the board.
+ * The values are computed on the fly from a pseudo-random function,
+ * instead of being stored in a big table.
+ */
+static uint64_t ZobristKey(int iRow, int iCol, uint8_t iTile)
+{
+    return MixBits((uint64_t)(iRow * BOARD_REALDIM + iCol) << 8 | iTile);
+}
+
+
+Board::Board(const Board &iBoard, const GameParams &iParams):
     m_params(iParams), m_layout(iParams.getBoardLayout()),
-    m_tilesRow(BOARD_REALDIM, Tile()),
-    m_tilesCol(BOARD_REALDIM, Tile()),
-    m_jokerRow(BOARD_REALDIM, false),
-    m_jokerCol(BOARD_REALDIM, false),
-    m_crossRow(BOARD_REALDIM, Cross()),
-    m_crossCol(BOARD_REALDIM, Cross()),
-    m_pointRow(BOARD_REALDIM, -1),
-    m_pointCol(BOARD_REALDIM, -1),
-    m_testsRow(BOARD_REALDIM, Tile())
+    m_gridRow(iBoard.m_gridRow), m_gridCol(iBoard.m_gridCol),
+    m_isEmpty(iBoard.m_isEmpty), m_hash(iBoard.m_hash)
+{
+    std::copy(&iBoard.m_testsRow[0][0],
+              &iBoard.m_testsRow[0][0] + BOARD_REALDIM * BOARD_REALDIM,
+              &m_testsRow[0][0]);
+}
+
+
+Board & Board::operator=(const Board &iOther)
 {
+    ASSERT(&m_params == &iOther.m_params, "Cannot copy a board using other parameters");
+    m_gridRow = iOther.m_gridRow;
+    m_gridCol = iOther.m_gridCol;
+    std::copy(&iOther.m_testsRow[0][0],
+              &iOther.m_testsRow[0][0] + BOARD_REALDIM * BOARD_REALDIM,
+              &m_testsRow[0][0]);
+    m_isEmpty = iOther.m_isEmpty;
+    m_hash = iOther.m_hash;
+    return *this;
+}
+
+
+Board::Board(const GameParams &iParams):
+    m_params(iParams), m_layout(iParams.getBoardLayout())
+{
+    // Initial hash, for the parameters which have an influence on the search
+    m_hash = MixBits(iParams.getLettersToPlay());
+    m_hash = MixBits(m_hash ^ iParams.getBonusPoints());
+
     // No cross check allowed around the board
     for (int i = 0; i < BOARD_REALDIM; i++)
     {
-        m_crossRow[0][i].setNone();
-        m_crossCol[0][i].setNone();
-        m_crossRow[i][0].setNone();
-        m_crossCol[i][0].setNone();
-        m_crossRow[BOARD_REALDIM - 1][i].setNone();
-        m_crossCol[BOARD_REALDIM - 1][i].setNone();
-        m_crossRow[i][BOARD_REALDIM - 1].setNone();
-        m_crossCol[i][BOARD_REALDIM - 1].setNone();
+        m_gridRow.accessCross(0, i).setNone();
+        m_gridCol.accessCross(0, i).setNone();
+        m_gridRow.accessCross(i, 0).setNone();
+        m_gridCol.accessCross(i, 0).setNone();
+        m_gridRow.accessCross(BOARD_REALDIM - 1, i).setNone();
+        m_gridCol.accessCross(BOARD_REALDIM - 1, i).setNone();
+        m_gridRow.accessCross(i, BOARD_REALDIM - 1).setNone();
+        m_gridCol.accessCross(i, BOARD_REALDIM - 1).setNone();
     }
+
+    // Keep a copy of the multipliers close to the tiles
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        for (int col = 1; col <= BOARD_DIM; col++)
+        {
+            const int letterMul = m_layout.getLetterMultiplier(row, col);
+            const int wordMul = m_layout.getWordMultiplier(row, col);
+            m_gridRow.setMultipliers(row, col, letterMul, wordMul);
+            m_gridCol.setMultipliers(col, row, letterMul, wordMul);
+            m_hash = MixBits(m_hash ^ (letterMul << 8 | wordMul));
+        }
+    }
+
+    removeTestRound();
 }
 
 
-const Tile& Board::getTile(int iRow, int iCol) const
+Tile Board::getTile(int iRow, int iCol) const
 {
-    return m_tilesRow[iRow][iCol];
+    return m_gridRow.getTile(iRow, iCol);
 }
 
 
@@ -88,14 +145,14 @@ wstring Board::getDisplayStr(int iRow, int iCol) const
 
 bool Board::isJoker(int iRow, int iCol) const
 {
-    return m_jokerRow[iRow][iCol];
+    return m_gridRow.isJoker(iRow, iCol);
 }
 
 
 bool Board::isVacant(int iRow, int iCol) const
 {
     ASSERT(m_layout.isValidCoord(iRow, iCol), "Invalid coordinates");
-    return m_tilesRow[iRow][iCol].isEmpty();
+    return m_gridRow.isEmpty(iRow, iCol);
 }
 
 
@@ -111,15 +168,15 @@ void Board::addRound(const Dictionary &iDic, const Round &iRound)
             if (isVacant(row, col + i))
             {
                 ASSERT(iRound.isPlayedFromRack(i), "Invalid round (1)");
-                m_tilesRow[row][col + i] = t;
-                m_jokerRow[row][col + i] = iRound.isJoker(i);
-                m_tilesCol[col + i][row] = t;
-                m_jokerCol[col + i][row] = iRound.isJoker(i);
+                m_gridRow.setTile(row, col + i, t);
+                m_gridCol.setTile(col + i, row, t);
+                m_hash ^= ZobristKey(row, col + i, m_gridRow.getByte(row, col + i));
             }
             else
             {
                 ASSERT(!iRound.isPlayedFromRack(i), "Invalid round (2)");
-                ASSERT(t == m_tilesRow[row][col + i].toUpper(), "Invalid round (3)");
+                ASSERT(t.toCode() == m_gridRow.getCode(row, col + i) && !t.isJoker(),
+                       "Invalid round (3)");
             }
         }
     }
@@ -131,21 +188,22 @@ void Board::addRound(const Dictionary &iDic, const Round &iRound)
             if (isVacant(row + i, col))
             {
                 ASSERT(iRound.isPlayedFromRack(i), "Invalid round (1)");
-                m_tilesRow[row + i][col] = t;
-                m_jokerRow[row + i][col] = iRound.isJoker(i);
-                m_tilesCol[col][row + i] = t;
-                m_jokerCol[col][row + i] = iRound.isJoker(i);
+                m_gridRow.setTile(row + i, col, t);
+                m_gridCol.setTile(col, row + i, t);
+                m_hash ^= ZobristKey(row + i, col, m_gridRow.getByte(row + i, col));
             }
             else
             {
                 ASSERT(!iRound.isPlayedFromRack(i), "Invalid round (2)");
-                ASSERT(t == m_tilesRow[row + i][col].toUpper(), "Invalid round (3)");
+                ASSERT(t.toCode() == m_gridRow.getCode(row + i, col) && !t.isJoker(),
+                       "Invalid round (3)");
             }
         }
     }
-    buildCross(iDic);
+    updateCross(iDic, iRound);
 #ifdef DEBUG
     checkDouble();
+    checkCross(iDic);
 #endif
 
     removeTestRound();
@@ -163,16 +221,15 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
     {
         for (unsigned int i = 0; i < iRound.getWordLen(); i++)
         {
-            ASSERT(iRound.getTile(i).toCode() == m_tilesRow[row][col + i].toCode(),
+            ASSERT(iRound.getTile(i).toCode() == m_gridRow.getCode(row, col + i),
                    "Invalid round removal");
             if (iRound.isPlayedFromRack(i))
             {
-                ASSERT(iRound.isJoker(i) == m_jokerRow[row][col + i],
+                ASSERT(iRound.isJoker(i) == m_gridRow.isJoker(row, col + i),
                        "Invalid round removal");
-                m_tilesRow[row][col + i] = Tile();
-                m_jokerRow[row][col + i] = false;
-                m_tilesCol[col + i][row] = Tile();
-                m_jokerCol[col + i][row] = false;
+                m_hash ^= ZobristKey(row, col + i, m_gridRow.getByte(row, col + i));
+                m_gridRow.clearTile(row, col + i);
+                m_gridCol.clearTile(col + i, row);
             }
         }
     }
@@ -180,24 +237,24 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
     {
         for (unsigned int i = 0; i < iRound.getWordLen(); i++)
         {
-            ASSERT(iRound.getTile(i).toCode() == m_tilesRow[row + i][col].toCode(),
+            ASSERT(iRound.getTile(i).toCode() == m_gridRow.getCode(row + i, col),
                    "Invalid round removal");
             if (iRound.isPlayedFromRack(i))
             {
-                ASSERT(iRound.isJoker(i) == m_jokerRow[row + i][col],
+                ASSERT(iRound.isJoker(i) == m_gridRow.isJoker(row + i, col),
                        "Invalid round removal");
-                m_tilesRow[row + i][col] = Tile();
-                m_jokerRow[row + i][col] = false;
-                m_tilesCol[col][row + i] = Tile();
-                m_jokerCol[col][row + i] = false;
+                m_hash ^= ZobristKey(row + i, col, m_gridRow.getByte(row + i, col));
+                m_gridRow.clearTile(row + i, col);
+                m_gridCol.clearTile(col, row + i);
             }
         }
     }
 
-    // Rebuild all the cross checks, because they are now invalid
-    buildCross(iDic);
+    // Update the cross checks, because they are now invalid
+    updateCross(iDic, iRound);
 #ifdef DEBUG
     checkDouble();
+    checkCross(iDic);
 #endif
 
     removeTestRound();
@@ -217,10 +274,7 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
 
 /* XXX: There is duplicated code with board_search.c.
  * We could probably factorize something... */
-int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
-                         const Matrix<Cross> &iCrossMx,
-                         const Matrix<int> &iPointsMx,
-                         const Matrix<bool> &iJokerMx,
+int Board::checkRoundAux(const BoardGrid &iGrid,
                          Round &iRound, bool checkJunction) const
 {
     bool isolated = true;
@@ -238,8 +292,8 @@ int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
 
     // Is the word an extension of another word?
     if (checkJunction &&
-        (!iTilesMx[row][col - 1].isEmpty() ||
-         !iTilesMx[row][col + iRound.getWordLen()].isEmpty()))
+        (!iGrid.isEmpty(row, col - 1) ||
+         !iGrid.isEmpty(row, col + iRound.getWordLen())))
     {
         return 1;
     }
@@ -247,12 +301,12 @@ int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
     for (unsigned int i = 0; i < iRound.getWordLen(); i++)
     {
         const Tile &t = iRound.getTile(i);
-        if (!iTilesMx[row][col + i].isEmpty())
+        if (!iGrid.isEmpty(row, col + i))
         {
             // Using a joker tile to emulate the letter on the board is not allowed,
             // the plain letter should be used instead.
             // Also, make sure the played letter is the same as the one on the board
-            if (iRound.isJoker(i) || iTilesMx[row][col+i].toCode() != t.toCode())
+            if (iRound.isJoker(i) || iGrid.getCode(row, col + i) != t.toCode())
             {
                 // Trying to overwrite a placed letter
                 return 2;
@@ -261,28 +315,29 @@ int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
             isolated = false;
             iRound.setFromBoard(i);
 
-            if (!iJokerMx[row][col + i])
+            if (!iGrid.isJoker(row, col + i))
                 pts += t.getPoints();
         }
         else
         {
             // The letter is not yet on the board
-            if (iCrossMx[row][col + i].check(t))
+            const Cross &cross = iGrid.getCross(row, col + i);
+            if (cross.check(t))
             {
                 // A non-trivial cross-check means an anchor square
-                if (!iCrossMx[row][col + i].isAny())
+                if (!cross.isAny())
                     isolated = false;
 
                 int l;
                 if (!iRound.isJoker(i))
-                    l = t.getPoints() * getLayout().getLetterMultiplier(row, col + i);
+                    l = t.getPoints() * iGrid.getLetterMultiplier(row, col + i);
                 else
                     l = 0;
                 pts += l;
-                int wm = getLayout().getWordMultiplier(row, col + i);
+                int wm = iGrid.getWordMultiplier(row, col + i);
                 wordmul *= wm;
 
-                int p = iPointsMx[row][col + i];
+                int p = iGrid.getPoints(row, col + i);
                 if (p >= 0)
                 {
                     ptscross += (p + l) * wm;
@@ -343,8 +398,7 @@ int Board::checkRound(Round &iRound, bool checkJunction) const
 {
     if (iRound.getCoord().getDir() == Coord::HORIZONTAL)
     {
-        return checkRoundAux(m_tilesRow, m_crossRow,
-                             m_pointRow, m_jokerRow, iRound, checkJunction);
+        return checkRoundAux(m_gridRow, iRound, checkJunction);
     }
     else
     {
@@ -352,8 +406,7 @@ int Board::checkRound(Round &iRound, bool checkJunction) const
         // Exchange the coordinates temporarily
         iRound.accessCoord().swap();
 
-        int res = checkRoundAux(m_tilesCol, m_crossCol,
-                                m_pointCol, m_jokerCol, iRound, checkJunction);
+        int res = checkRoundAux(m_gridCol, iRound, checkJunction);
 
         // Restore the coordinates
         iRound.accessCoord().swap();
@@ -377,9 +430,9 @@ void Board::testRound(const Round &iRound)
             {
                 const Tile &t = iRound.getTile(i);
                 if (iRound.isJoker(i))
-                    m_testsRow[row][col + i] = t.toLower();
+                    m_testsRow[row][col + i] = BoardGrid::EncodeTile(t.toLower());
                 else
-                    m_testsRow[row][col + i] = t;
+                    m_testsRow[row][col + i] = BoardGrid::EncodeTile(t);
             }
         }
     }
@@ -391,9 +444,9 @@ void Board::testRound(const Round &iRound)
             {
                 const Tile &t = iRound.getTile(i);
                 if (iRound.isJoker(i))
-                    m_testsRow[row + i][col] = t.toLower();
+                    m_testsRow[row + i][col] = BoardGrid::EncodeTile(t.toLower());
                 else
-                    m_testsRow[row + i][col] = t;
+                    m_testsRow[row + i][col] = BoardGrid::EncodeTile(t);
             }
         }
     }
@@ -402,20 +455,26 @@ void Board::testRound(const Round &iRound)
 
 void Board::removeTestRound()
 {
-    m_testsRow = m_tilesRow;
+    for (int row = 0; row < BOARD_REALDIM; row++)
+    {
+        for (int col = 0; col < BOARD_REALDIM; col++)
+        {
+            m_testsRow[row][col] = m_gridRow.getByte(row, col);
+        }
+    }
 }
 
 
 bool Board::isTestChar(int iRow, int iCol) const
 {
-    return !m_testsRow[iRow][iCol].isEmpty() && isVacant(iRow, iCol);
+    return m_testsRow[iRow][iCol] != 0 && isVacant(iRow, iCol);
 }
 
 
-const Tile& Board::getTestTile(int iRow, int iCol) const
+Tile Board::getTestTile(int iRow, int iCol) const
 {
     ASSERT(isTestChar(iRow, iCol), "The requested tile is not a test tile");
-    return m_testsRow[iRow][iCol];
+    return BoardGrid::DecodeTile(m_testsRow[iRow][iCol]);
 }
 
 
@@ -427,8 +486,8 @@ string Board::getCellContent_row(int row, int col) const
     char buff[1024];  // [ joker, mask, point, tiles ]
     sprintf(buff,CELL_STRING_FORMAT,
             // m_jokerRow[row][col] ? 'j':'.',
-            m_crossRow[row][col].getHexContent().c_str(),
-            m_pointRow[row][col]);
+            m_gridRow.getCross(row, col).getHexContent().c_str(),
+            m_gridRow.getPoints(row, col));
     return {buff};
 }
 
@@ -437,8 +496,8 @@ string Board::getCellContent_col(int row, int col) const
     char buff[1024];
     sprintf(buff,CELL_STRING_FORMAT,
             // m_jokerCol[col][row] ? 'j':'.',
-            m_crossCol[col][row].getHexContent().c_str(),
-            m_pointCol[col][row]);
+            m_gridCol.getCross(col, row).getHexContent().c_str(),
+            m_gridCol.getPoints(col, row));
     return {buff};
 }
 
@@ -452,15 +511,42 @@ void Board::checkDouble()
     {
         for (unsigned col = 1; col <= nbCols; col++)
         {
-            ASSERT(m_tilesRow[row][col] == m_tilesCol[col][row],
+            ASSERT(m_gridRow.getCode(row, col) == m_gridCol.getCode(col, row),
                    std::format("Tiles inconsistency at {}x{}", row, col));
-            ASSERT(m_jokerRow[row][col] == m_jokerCol[col][row],
+            ASSERT(m_gridRow.isJoker(row, col) == m_gridCol.isJoker(col, row),
                    std::format("Jokers inconsistency at {}x{}", row, col));
             // The crossckecks and the points have no reason to be the same
             // in both directions
         }
     }
 }
+
+
+void Board::checkCross(const Dictionary &iDic)
+{
+    // Compare the incrementally updated cross checks with a full rebuild
+    const BoardGrid gridRow = m_gridRow;
+    const BoardGrid gridCol = m_gridCol;
+    buildCross(iDic);
+
+    const unsigned nbRows = m_layout.getRowCount();
+    const unsigned nbCols = m_layout.getColCount();
+    for (unsigned row = 1; row <= nbRows; row++)
+    {
+        for (unsigned col = 1; col <= nbCols; col++)
+        {
+            ASSERT(gridRow.getCross(row, col) == m_gridRow.getCross(row, col) &&
+                   gridCol.getCross(row, col) == m_gridCol.getCross(row, col),
+                   std::format("Cross checks inconsistency at {}x{}", row, col));
+            ASSERT(gridRow.getPoints(row, col) == m_gridRow.getPoints(row, col) &&
+                   gridCol.getPoints(row, col) == m_gridCol.getPoints(row, col),
+                   std::format("Cross points inconsistency at {}x{}", row, col));
+            ASSERT(((m_gridRow.getAnchors(row) >> col) & 1) == m_gridRow.isAnchor(row, col) &&
+                   ((m_gridCol.getAnchors(row) >> col) & 1) == m_gridCol.isAnchor(row, col),
+                   std::format("Anchors inconsistency at {}x{}", row, col));
+        }
+    }
+}
 #endif
 
 
@@ -468,18 +554,48 @@ void Board::search(const Dictionary &iDic,
                    const Rack &iRack,
                    Results &oResults) const
 {
-    // Create a copy of the rack to avoid modifying the given one
-    Rack copyRack = iRack;
+    SearchControl *control = oResults.getControl();
+    BoardSearch horizSearch(iDic, m_params, m_gridRow, false, control);
+    BoardSearch vertSearch(iDic, m_params, m_gridCol, false, control);
+
+    // With a control, the rows are always searched separately,
+    // to report the progress after each row
+    ThreadPool &pool = ThreadPool::Instance();
+    if (pool.getNbThreads() == 1 && control == nullptr)
+    {
+        // Create a copy of the rack to avoid modifying the given one
+        Rack copyRack = iRack;
 
-    // Search horizontal words
-    BoardSearch horizSearch(iDic, m_params, m_tilesRow, m_crossRow,
-                            m_pointRow, m_jokerRow);
-    horizSearch.search(copyRack, oResults, Coord::HORIZONTAL);
+        // Search horizontal words, then vertical words
+        horizSearch.search(copyRack, oResults, Coord::HORIZONTAL);
+        vertSearch.search(copyRack, oResults, Coord::VERTICAL);
+        return;
+    }
 
-    // Search vertical words
-    BoardSearch vertSearch(iDic, m_params, m_tilesCol, m_crossCol,
-                            m_pointCol, m_jokerCol);
-    vertSearch.search(copyRack, oResults, Coord::VERTICAL);
+    // Search each row of each direction in a separate task, with its own
+    // copy of the rack and its own results. The first BOARD_DIM tasks
+    // handle the horizontal words, the next ones the vertical words.
+    vector<std::unique_ptr<Results>> sinks(2 * BOARD_DIM);
+    for (std::unique_ptr<Results> &sink : sinks)
+        sink.reset(oResults.createSink());
+    pool.run(2 * BOARD_DIM, [&](unsigned iTask) {
+        if (control != nullptr && control->isCancelled())
+            return;
+        Rack copyRack = iRack;
+        if (iTask < BOARD_DIM)
+            horizSearch.searchRow(copyRack, *sinks[iTask],
+                                  Coord::HORIZONTAL, iTask + 1);
+        else
+            vertSearch.searchRow(copyRack, *sinks[iTask],
+                                 Coord::VERTICAL, iTask - BOARD_DIM + 1);
+        if (control != nullptr)
+            control->notifyProgress(*sinks[iTask]);
+    });
+
+    // Merge the results in the order of the sequential search,
+    // to keep the search deterministic
+    for (const std::unique_ptr<Results> &sink : sinks)
+        oResults.merge(*sink);
 }
 
 
@@ -491,8 +607,10 @@ void Board::searchFirst(const Dictionary &iDic,
     Rack copyRack = iRack;
 
     // Search horizontal words
-    BoardSearch horizSearch(iDic, m_params, m_tilesRow, m_crossRow,
-                            m_pointRow, m_jokerRow, true);
+    SearchControl *control = oResults.getControl();
+    BoardSearch horizSearch(iDic, m_params, m_gridRow, true, control);
     horizSearch.search(copyRack, oResults, Coord::HORIZONTAL);
+    if (control != nullptr)
+        control->notifyProgress(oResults);
 }
 
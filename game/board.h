@@ -23,10 +23,11 @@
 #define BOARD_H_
 
 #include <string>
+#include <stdint.h>
 
-#include "matrix.h"
+#include "board_grid.h"
+#include "coord.h"
 #include "tile.h"
-#include "cross.h"
 #include "logging.h"
 
 class GameParams;
@@ -38,10 +39,6 @@ class Results;
 
 using namespace std;
 
-#define BOARD_MIN 1
-#define BOARD_MAX 15
-#define BOARD_DIM 15
-
 
 /**
  * Representation of the board.
@@ -55,23 +52,54 @@ class Board
 public:
     Board(const GameParams &iParams);
 
+    /**
+     * Copy the given board, but refer to the given parameters (which must
+     * be a copy of the ones of iBoard). This allows keeping a snapshot of
+     * the board which does not depend on the game anymore.
+     */
+    Board(const Board &iBoard, const GameParams &iParams);
+
+    Board(const Board &iOther) = default;
+    /// Copy the contents of a board using the same parameters
+    Board & operator=(const Board &iOther);
+
+    const GameParams & getParams() const { return m_params; }
     const BoardLayout & getLayout() const { return m_layout; }
 
     bool isJoker(int iRow, int iCol) const;
     bool isVacant(int iRow, int iCol) const;
 
-    const Tile& getTile(int iRow, int iCol) const;
+    Tile getTile(int iRow, int iCol) const;
     wstring getDisplayStr(int iRow, int iCol) const;
 
+    /**
+     * Return the cross check of the given square, for a tile placed
+     * there as part of a word in the given direction
+     */
+    const Cross & getCross(int iRow, int iCol, Coord::Direction iDir) const
+    {
+        return iDir == Coord::HORIZONTAL ?
+            m_gridRow.getCross(iRow, iCol) : m_gridCol.getCross(iCol, iRow);
+    }
+
     void addRound(const Dictionary &iDic, const Round &iRound);
     void removeRound(const Dictionary &iDic, const Round &iRound);
     int  checkRound(Round &iRound, bool checkJunction = true) const;
 
+    /**
+     * Return a hash of the tiles of the board (Zobrist hashing), updated
+     * incrementally by addRound() and removeRound().
+     * The hash also covers the game parameters which have an influence
+     * on the search (board layout, bonus, ...), so it identifies the
+     * rounds which can be found on the board with a given rack.
+     */
+    uint64_t getHash() const { return m_hash; }
+
     /**
      * Preview
      */
     bool isTestChar(int iRow, int iCol) const;
-    const Tile& getTestTile(int iRow, int iCol) const;
+    Tile getTestTile(int iRow, int iCol) const;
     void testRound(const Round &iRound);
     void removeTestRound();
 
@@ -90,36 +118,41 @@ private:
 
     const BoardLayout &m_layout;
 
-    Matrix<Tile> m_tilesRow;
-    Matrix<Tile> m_tilesCol;
-
-    Matrix<bool> m_jokerRow;
-    Matrix<bool> m_jokerCol;
-
-    Matrix<Cross> m_crossRow;
-    Matrix<Cross> m_crossCol;
-
-    Matrix<int> m_pointRow;
-    Matrix<int> m_pointCol;
+    /**
+     * The board contents, stored twice: as is (for the horizontal words),
+     * and transposed (for the vertical words). The cross checks of a grid
+     * are computed from the tiles of the other grid.
+     */
+    BoardGrid m_gridRow;
+    BoardGrid m_gridCol;
 
-    Matrix<Tile> m_testsRow;
+    /// Tiles of the board and of the test round (encoded like in BoardGrid)
+    uint8_t m_testsRow[BOARD_REALDIM][BOARD_REALDIM];
 
     /// Flag indicating if the board is empty or if it has letters
     bool m_isEmpty{true};
 
+    /// Zobrist hash of the board (see getHash())
+    uint64_t m_hash;
+
     /**
      * board_cross.c
      */
     void buildCross(const Dictionary &iDic);
 
-    int checkRoundAux(const Matrix<Tile> &iTilesMx,
-                      const Matrix<Cross> &iCrossMx,
-                      const Matrix<int> &iPointsMx,
-                      const Matrix<bool> &iJokerMx,
+    /**
+     * Update the cross checks after iRound was added to
+     * (or removed from) the board. Only the rows and columns
+     * touched by the round are recomputed.
+     */
+    void updateCross(const Dictionary &iDic, const Round &iRound);
+
+    int checkRoundAux(const BoardGrid &iGrid,
                       Round &iRound,
                       bool checkJunction) const;
 #ifdef DEBUG
     void checkDouble();
+    void checkCross(const Dictionary &iDic);
 #endif
 
 };
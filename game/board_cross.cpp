@@ -20,44 +20,51 @@
  *****************************************************************************/
 
 #include <cwctype>
+#include <algorithm>
 
 #include <dic.h>
+#include "header.h"
 #include "tile.h"
 #include "board.h"
+#include "round.h"
 #include "debug.h"
 
 
 static void Board_checkout_tile(const Dictionary &iDic,
-                                vector<Tile>& iTiles,
-                                vector<bool> & iJoker,
+                                const BoardGrid &iGrid,
                                 Cross &oCross,
                                 int& oPoints,
+                                int iLine,
                                 int index)
 {
+    const Header &header = iDic.getHeader();
     oPoints = 0;
 
     /* Points on the left part */
     int left = index;
-    while (!iTiles[left - 1].isEmpty())
+    while (!iGrid.isEmpty(iLine, left - 1))
     {
         left--;
-        if (!iJoker[left])
-            oPoints += iTiles[left].getPoints();
+        if (!iGrid.isJoker(iLine, left))
+            oPoints += header.getPoints(iGrid.getCode(iLine, left));
     }
 
-    // FIXME: create temporary strings until the dictionary uses Tile objects
-    wstring leftTiles;
-    wstring rightTiles;
+    dic_code_t leftTiles[BOARD_REALDIM];
+    dic_code_t rightTiles[BOARD_REALDIM];
 
+    int nbLeft = 0;
     for (int i = left; i < index; i++)
-        leftTiles.push_back(towupper(iTiles[i].toChar()));
+        leftTiles[nbLeft++] = iGrid.getCode(iLine, i);
+    leftTiles[nbLeft] = 0;
 
-    for (int i = index + 1; !iTiles[i].isEmpty(); i++)
-        rightTiles.push_back(towupper(iTiles[i].toChar()));
+    int nbRight = 0;
+    for (int i = index + 1; !iGrid.isEmpty(iLine, i); i++)
+        rightTiles[nbRight++] = iGrid.getCode(iLine, i);
+    rightTiles[nbRight] = 0;
 
     /* Tiles that can be played */
     unsigned int node, succ;
-    node = iDic.charLookup(iDic.getRoot(), leftTiles.c_str());
+    node = iDic.lookup(iDic.getRoot(), leftTiles);
     if (node == 0)
     {
         oCross.setNone();
@@ -66,7 +73,7 @@ static void Board_checkout_tile(const Dictionary &iDic,
 
     for (succ = iDic.getSucc(node); succ; succ = iDic.getNext(succ))
     {
-        if (iDic.isEndOfWord(iDic.charLookup(succ, rightTiles.c_str())))
+        if (iDic.isEndOfWord(iDic.lookup(succ, rightTiles)))
             oCross.insert(Tile(iDic.getChar(succ)));
         if (iDic.isLast(succ))
             break;
@@ -74,53 +81,121 @@ static void Board_checkout_tile(const Dictionary &iDic,
 
     /* Points on the right part */
     /* yes, it is REALLY [index + 1] */
-    while (!iTiles[index + 1].isEmpty())
+    while (!iGrid.isEmpty(iLine, index + 1))
     {
         index++;
-        if (!iJoker[index])
-            oPoints += iTiles[index].getPoints();
+        if (!iGrid.isJoker(iLine, index))
+            oPoints += header.getPoints(iGrid.getCode(iLine, index));
+    }
+}
+
+
+/*
+ * Compute the cross check of the cell j of the line i of iTilesGrid.
+ * The result is stored in iCrossGrid, which is the transposition of
+ * iTilesGrid.
+ */
+static void Board_checkCell(const Dictionary &iDic,
+                            const BoardGrid &iTilesGrid,
+                            BoardGrid &iCrossGrid,
+                            int i, int j)
+{
+    Cross &cross = iCrossGrid.accessCross(j, i);
+    iCrossGrid.setPoints(j, i, -1);
+    if (!iTilesGrid.isEmpty(i, j))
+    {
+        cross.setNone();
+    }
+    else if (!iTilesGrid.isEmpty(i, j - 1) ||
+             !iTilesGrid.isEmpty(i, j + 1))
+    {
+        cross.setNone();
+        int points;
+        Board_checkout_tile(iDic, iTilesGrid, cross, points, i, j);
+        iCrossGrid.setPoints(j, i, points);
+    }
+    else
+    {
+        cross.setAny();
     }
 }
 
 
 static void Board_check(const Dictionary &iDic,
-                        Matrix<Tile> &iTilesMx,
-                        Matrix<bool> &iJokerMx,
-                        Matrix<Cross> &iCrossMx,
-                        Matrix<int> &iPointMx)
+                        const BoardGrid &iTilesGrid,
+                        BoardGrid &iCrossGrid)
 {
     for (int i = 1; i <= BOARD_DIM; i++)
     {
         for (int j = 1; j <= BOARD_DIM; j++)
         {
-            iPointMx[j][i] = -1;
-            if (!iTilesMx[i][j].isEmpty())
-            {
-                iCrossMx[j][i].setNone();
-            }
-            else if (!iTilesMx[i][j - 1].isEmpty() ||
-                     !iTilesMx[i][j + 1].isEmpty())
-            {
-                iCrossMx[j][i].setNone();
-                Board_checkout_tile(iDic,
-                                    iTilesMx[i],
-                                    iJokerMx[i],
-                                    iCrossMx[j][i],
-                                    iPointMx[j][i],
-                                    j);
-            }
-            else
-            {
-                iCrossMx[j][i].setAny();
-            }
+            Board_checkCell(iDic, iTilesGrid, iCrossGrid, i, j);
         }
     }
 }
 
 
+/*
+ * Update the cells of the line i which depend on the tiles between
+ * the indices iFirst and iLast (included), after some of these tiles
+ * were added or removed: the cells of the word containing them, and
+ * the 2 cells surrounding this word.
+ */
+static void Board_checkLine(const Dictionary &iDic,
+                            const BoardGrid &iTilesGrid,
+                            BoardGrid &iCrossGrid,
+                            int i, int iFirst, int iLast)
+{
+    while (!iTilesGrid.isEmpty(i, iFirst - 1))
+        iFirst--;
+    while (!iTilesGrid.isEmpty(i, iLast + 1))
+        iLast++;
+    const int from = std::max(iFirst - 1, 1);
+    const int to = std::min(iLast + 1, BOARD_DIM);
+    for (int j = from; j <= to; j++)
+    {
+        Board_checkCell(iDic, iTilesGrid, iCrossGrid, i, j);
+    }
+}
+
+
 void Board::buildCross(const Dictionary &iDic)
 {
-    Board_check(iDic, m_tilesRow, m_jokerRow, m_crossCol, m_pointCol);
-    Board_check(iDic, m_tilesCol, m_jokerCol, m_crossRow, m_pointRow);
+    Board_check(iDic, m_gridRow, m_gridCol);
+    Board_check(iDic, m_gridCol, m_gridRow);
+}
+
+
+void Board::updateCross(const Dictionary &iDic, const Round &iRound)
+{
+    const int row = iRound.getCoord().getRow();
+    const int col = iRound.getCoord().getCol();
+    const int len = iRound.getWordLen();
+    if (iRound.getCoord().getDir() == Coord::HORIZONTAL)
+    {
+        // The row of the word
+        Board_checkLine(iDic, m_gridRow, m_gridCol, row, col, col + len - 1);
+        // The columns where a tile was added or removed
+        for (int i = 0; i < len; i++)
+        {
+            if (iRound.isPlayedFromRack(i))
+            {
+                Board_checkLine(iDic, m_gridCol, m_gridRow, col + i, row, row);
+            }
+        }
+    }
+    else
+    {
+        // The column of the word
+        Board_checkLine(iDic, m_gridCol, m_gridRow, col, row, row + len - 1);
+        // The rows where a tile was added or removed
+        for (int i = 0; i < len; i++)
+        {
+            if (iRound.isPlayedFromRack(i))
+            {
+                Board_checkLine(iDic, m_gridRow, m_gridCol, row + i, col, col);
+            }
+        }
+    }
 }
 
@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BOARD_GRID_H_
+#define BOARD_GRID_H_
+
+#include <stdint.h>
+#include <bit>
+
+#include "tile.h"
+#include "cross.h"
+
+#define BOARD_MIN 1
+#define BOARD_MAX 15
+#define BOARD_DIM 15
+#define BOARD_REALDIM (BOARD_DIM + 2)
+
+
+/**
+ * Flat storage for one orientation of the board (the board itself for
+ * the horizontal direction, or its transposition for the vertical one).
+ *
+ * The grid is padded with one empty cell on each side, so valid
+ * coordinates are between 0 and BOARD_REALDIM - 1 inclusive, and the
+ * neighbours of any cell of the board can be read without bound checks.
+ *
+ * Everything is stored in fixed-size arrays, so a grid can be copied
+ * with a plain memcpy. Each tile is encoded on one byte (the code of
+ * the tile, plus a bit for jokers), next to the multipliers of its
+ * square. The cross checks and their points are stored in parallel
+ * arrays, indexed the same way.
+ *
+ * The anchors of each line (i.e. the empty squares next to a tile, where
+ * the search starts) are also maintained when tiles are set or cleared,
+ * as a bitset per line, so that searches with different racks on the
+ * same board do not need to look for them.
+ */
+class BoardGrid
+{
+public:
+    /// Create an empty grid, where the cross checks accept any tile
+    BoardGrid()
+    {
+        for (int i = 0; i < kSize; ++i)
+            m_points[i] = -1;
+    }
+
+    /// Encode a tile on one byte (0 for an empty tile)
+    static uint8_t EncodeTile(const Tile &iTile)
+    {
+        if (iTile.isEmpty())
+            return 0;
+        return iTile.toCode() | (iTile.isJoker() ? kJokerBit : 0);
+    }
+
+    /// Return the code of a tile encoded with EncodeTile()
+    static unsigned int DecodeCode(uint8_t iByte) { return iByte & kCodeMask; }
+
+    /// Decode a tile encoded with EncodeTile()
+    static Tile DecodeTile(uint8_t iByte)
+    {
+        if (iByte == 0)
+            return Tile();
+        return Tile((unsigned int)(iByte & kCodeMask), (iByte & kJokerBit) != 0);
+    }
+
+    bool isEmpty(int iRow, int iCol) const { return cell(iRow, iCol).tile == 0; }
+    bool isJoker(int iRow, int iCol) const { return cell(iRow, iCol).tile & kJokerBit; }
+    /// Return the code of the tile (0 for an empty cell)
+    unsigned int getCode(int iRow, int iCol) const { return DecodeCode(cell(iRow, iCol).tile); }
+    Tile getTile(int iRow, int iCol) const { return DecodeTile(cell(iRow, iCol).tile); }
+    /// Raw access to the encoded tile
+    uint8_t getByte(int iRow, int iCol) const { return cell(iRow, iCol).tile; }
+
+    /// Set a tile on the board (the joker information is part of the tile)
+    void setTile(int iRow, int iCol, const Tile &iTile)
+    {
+        accessCell(iRow, iCol).tile = EncodeTile(iTile);
+        updateAnchors(iRow, iCol);
+    }
+    void clearTile(int iRow, int iCol)
+    {
+        accessCell(iRow, iCol).tile = 0;
+        updateAnchors(iRow, iCol);
+    }
+
+    /// Return true if the square is empty, with at least one non-empty neighbour
+    bool isAnchor(int iRow, int iCol) const
+    {
+        return isEmpty(iRow, iCol) &&
+            (!isEmpty(iRow, iCol - 1) || !isEmpty(iRow, iCol + 1) ||
+             !isEmpty(iRow - 1, iCol) || !isEmpty(iRow + 1, iCol));
+    }
+
+    /// Return the anchors of the line, the bit i being set if (iRow, i) is an anchor
+    uint32_t getAnchors(int iRow) const { return m_anchors[iRow]; }
+
+    /// Return the column of the anchor preceding (iRow, iCol) in the line, or 0
+    int getPreviousAnchor(int iRow, int iCol) const
+    {
+        const uint32_t before = m_anchors[iRow] & ((1u << iCol) - 1);
+        return before ? std::bit_width(before) - 1 : 0;
+    }
+
+    int getLetterMultiplier(int iRow, int iCol) const { return cell(iRow, iCol).letterMul; }
+    int getWordMultiplier(int iRow, int iCol) const { return cell(iRow, iCol).wordMul; }
+    void setMultipliers(int iRow, int iCol, int iLetterMul, int iWordMul)
+    {
+        accessCell(iRow, iCol).letterMul = iLetterMul;
+        accessCell(iRow, iCol).wordMul = iWordMul;
+    }
+
+    const Cross & getCross(int iRow, int iCol) const { return m_cross[Index(iRow, iCol)]; }
+    Cross & accessCross(int iRow, int iCol) { return m_cross[Index(iRow, iCol)]; }
+
+    /// Return the points of the cross word (-1 if there is no cross word)
+    int getPoints(int iRow, int iCol) const { return m_points[Index(iRow, iCol)]; }
+    void setPoints(int iRow, int iCol, int iPoints) { m_points[Index(iRow, iCol)] = iPoints; }
+
+private:
+    static const int kSize = BOARD_REALDIM * BOARD_REALDIM;
+    static const uint8_t kJokerBit = 0x80;
+    static const uint8_t kCodeMask = 0x7f;
+
+    static int Index(int iRow, int iCol) { return iRow * BOARD_REALDIM + iCol; }
+
+    /// Contents of a square, read together by the search
+    struct Cell
+    {
+        uint8_t tile{0};
+        uint8_t letterMul{0};
+        uint8_t wordMul{0};
+    };
+
+    const Cell & cell(int iRow, int iCol) const { return m_cells[Index(iRow, iCol)]; }
+    Cell & accessCell(int iRow, int iCol) { return m_cells[Index(iRow, iCol)]; }
+
+    /// Update the anchor bit of a square of the board
+    void updateAnchor(int iRow, int iCol)
+    {
+        if (iRow < BOARD_MIN || iRow > BOARD_MAX || iCol < BOARD_MIN || iCol > BOARD_MAX)
+            return;
+        if (isAnchor(iRow, iCol))
+            m_anchors[iRow] |= 1u << iCol;
+        else
+            m_anchors[iRow] &= ~(1u << iCol);
+    }
+
+    /// Update the anchor bits of a square and of its neighbours
+    void updateAnchors(int iRow, int iCol)
+    {
+        updateAnchor(iRow, iCol);
+        updateAnchor(iRow, iCol - 1);
+        updateAnchor(iRow, iCol + 1);
+        updateAnchor(iRow - 1, iCol);
+        updateAnchor(iRow + 1, iCol);
+    }
+
+    Cell m_cells[kSize];
+    Cross m_cross[kSize];
+    int16_t m_points[kSize];
+    uint32_t m_anchors[BOARD_REALDIM]{};
+};
+
+#endif
+
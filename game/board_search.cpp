@@ -19,28 +19,39 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
-#include <cwctype> // For towupper
+#include <algorithm>
+#include <climits>
+#include <bit>
 
 #include "board_search.h"
 #include "dic.h"
+#include "header.h"
 #include "game_params.h"
 #include "board.h"
+#include "board_grid.h"
 #include "tile.h"
 #include "rack.h"
 #include "round.h"
 #include "results.h"
+#include "search_control.h"
+#include "debug.h"
 
 
 BoardSearch::BoardSearch(const Dictionary &iDic,
                          const GameParams &iParams,
-                         const Matrix<Tile> &iTilesMx,
-                         const Matrix<Cross> &iCrossMx,
-                         const Matrix<int> &iPointsMx,
-                         const Matrix<bool> &iJokerMx,
-                         bool isFirstTurn)
-    : m_dic(iDic), m_params(iParams), m_tilesMx(iTilesMx), m_crossMx(iCrossMx),
-      m_pointsMx(iPointsMx), m_jokerMx(iJokerMx), m_firstTurn(isFirstTurn)
+                         const BoardGrid &iGrid,
+                         bool isFirstTurn,
+                         const SearchControl *iControl)
+    : m_dic(iDic), m_params(iParams), m_grid(iGrid), m_firstTurn(isFirstTurn),
+    m_control(iControl)
 {
+    // Jokers do not give any point
+    for (const Tile &tile : iDic.getAllTiles())
+        m_tilesByPoints.emplace_back(tile, tile.isJoker() ? 0 : tile.getPoints());
+    std::stable_sort(m_tilesByPoints.begin(), m_tilesByPoints.end(),
+                     [](const pair<Tile, int> &iTile1, const pair<Tile, int> &iTile2) {
+        return iTile1.second > iTile2.second;
+    });
 }
 
 
@@ -60,71 +71,99 @@ void BoardSearch::search(Rack &iRack, Results &oResults, Coord::Direction iDir)
     }
 
 
+    searchRows(iRack, oResults, iDir, 1, BOARD_DIM);
+}
+
+
+void BoardSearch::searchRow(Rack &iRack, Results &oResults,
+                            Coord::Direction iDir, int iRow) const
+{
+    searchRows(iRack, oResults, iDir, iRow, iRow);
+}
+
+
+void BoardSearch::searchRows(Rack &iRack, Results &oResults,
+                             Coord::Direction iDir,
+                             int iFirstRow, int iLastRow) const
+{
+    ASSERT(!m_firstTurn, "Not supported on the first turn");
+
     vector<Tile> rackTiles;
     iRack.getTiles(rackTiles);
-    vector<Tile>::const_iterator it;
+    const unsigned int rackMask = Cross::GetTilesMask(rackTiles);
 
-    for (int row = 1; row <= BOARD_DIM; row++)
+    // Collect the anchors of the rows, maintained by the grid
+    Anchor anchors[BOARD_DIM * BOARD_DIM];
+    int nbAnchors = 0;
+    for (int row = iFirstRow; row <= iLastRow; row++)
     {
-        Round partialWord;
-        partialWord.accessCoord().setDir(iDir);
-        partialWord.accessCoord().setRow(row);
-        int lastanchor = 0;
-        for (int col = 1; col <= BOARD_DIM; col++)
+        for (uint32_t bits = m_grid.getAnchors(row); bits != 0; bits &= bits - 1)
         {
-            if (m_tilesMx[row][col].isEmpty() &&
-                (!m_tilesMx[row][col - 1].isEmpty() ||
-                 !m_tilesMx[row][col + 1].isEmpty() ||
-                 !m_tilesMx[row - 1][col].isEmpty() ||
-                 !m_tilesMx[row + 1][col].isEmpty()))
-            {
-#ifdef DONT_USE_SEARCH_OPTIMIZATION
-                if (!m_tilesMx[row][col - 1].isEmpty())
-                {
-                    partialWord.accessCoord().setCol(lastanchor + 1);
-                    extendRight(iRack, partialWord, oResults,
-                                m_dic.getRoot(), row, lastanchor + 1, col);
-                }
-                else
-                {
-                    partialWord.accessCoord().setCol(col);
-                    leftPart(iRack, partialWord, oResults,
-                             m_dic.getRoot(), row, col, col - lastanchor - 1);
-                }
-                lastanchor = col;
-#else
-                // Optimization compared to the original Appel & Jacobson
-                // algorithm: skip leftPart if none of the tiles of the rack
-                // matches the cross mask for the current anchor
-                bool match = false;
-                for (it = rackTiles.begin(); it != rackTiles.end(); it++)
-                {
-                    if (m_crossMx[row][col].check(*it))
-                    {
-                        match = true;
-                        break;
-                    }
-                }
-                if (match)
-                {
-                    if (!m_tilesMx[row][col - 1].isEmpty())
-                    {
-                        partialWord.accessCoord().setCol(lastanchor + 1);
-                        extendRight(iRack, partialWord, oResults,
-                                    m_dic.getRoot(), row, lastanchor + 1, col);
-                    }
-                    else
-                    {
-                        partialWord.accessCoord().setCol(col);
-                        leftPart(iRack, partialWord, oResults,
-                                 m_dic.getRoot(), row, col, col - lastanchor - 1);
-                    }
-                }
-                lastanchor = col;
+            const int col = std::countr_zero(bits);
+#ifndef DONT_USE_SEARCH_OPTIMIZATION
+            // Optimization compared to the original Appel & Jacobson
+            // algorithm: skip leftPart if none of the tiles of the rack
+            // matches the cross mask for the current anchor
+            if (!m_grid.getCross(row, col).checkAny(rackMask))
+                continue;
 #endif
-            }
+            anchors[nbAnchors++] = Anchor{row, col,
+                                          m_grid.getPreviousAnchor(row, col),
+                                          INT_MAX};
         }
     }
+
+    // Branch and bound: if the results ignore the rounds below some score,
+    // search the most promising anchors first, so that this minimum score
+    // increases quickly, and skip the anchors which cannot reach it.
+    // The order of the search does not matter for such results, because
+    // the rounds they keep only depend on the best scores.
+    if (oResults.getMinScore() >= 0)
+    {
+        for (int i = 0; i < nbAnchors; ++i)
+        {
+            anchors[i].maxScore = getAnchorMaxScore(iRack, anchors[i].row,
+                                                    anchors[i].col,
+                                                    anchors[i].lastAnchor);
+        }
+        std::stable_sort(anchors, anchors + nbAnchors,
+                         [](const Anchor &iAnchor1, const Anchor &iAnchor2) {
+            return iAnchor1.maxScore > iAnchor2.maxScore;
+        });
+    }
+
+    Round partialWord;
+    partialWord.accessCoord().setDir(iDir);
+    for (int i = 0; i < nbAnchors; ++i)
+    {
+        // The anchors are sorted, so the next ones cannot do better
+        if (anchors[i].maxScore < oResults.getMinScore())
+            break;
+        if (m_control != nullptr && m_control->isCancelled())
+            break;
+        partialWord.accessCoord().setRow(anchors[i].row);
+        searchAnchor(iRack, partialWord, oResults, anchors[i].row,
+                     anchors[i].col, anchors[i].lastAnchor);
+    }
+}
+
+
+void BoardSearch::searchAnchor(Rack &iRack, Round &ioPartialWord,
+                               Results &oResults, int row,
+                               int col, int lastanchor) const
+{
+    if (!m_grid.isEmpty(row, col - 1))
+    {
+        ioPartialWord.accessCoord().setCol(lastanchor + 1);
+        extendRight(iRack, ioPartialWord, oResults, PartialScore(),
+                    m_dic.getRoot(), row, lastanchor + 1, col);
+    }
+    else
+    {
+        ioPartialWord.accessCoord().setCol(col);
+        leftPart(iRack, ioPartialWord, oResults,
+                 m_dic.getRoot(), row, col, col - lastanchor - 1);
+    }
 }
 
 
@@ -132,9 +171,17 @@ void BoardSearch::leftPart(Rack &iRack, Round &ioPartialWord,
                            Results &oResults, int n, int iRow,
                            int iAnchor, int iLimit) const
 {
-    extendRight(iRack, ioPartialWord, oResults, n, iRow, iAnchor, iAnchor);
+    // The squares of the left part depend on its length, so its score
+    // is only computed here, once its position is known. The following
+    // tiles are then scored incrementally by extendRight().
+    extendRight(iRack, ioPartialWord, oResults,
+                getPartialScore(ioPartialWord, iRow),
+                n, iRow, iAnchor, iAnchor);
 
-    if (iLimit > 0)
+    // At least one tile of the rack must be played from the anchor,
+    // so the left part cannot use all the letters to play
+    if (iLimit > 0 &&
+        (int)ioPartialWord.getWordLen() + 1 < m_params.getLettersToPlay())
     {
         bool hasJokerInRack = iRack.contains(Tile::Joker());
         for (unsigned int succ = m_dic.getSucc(n); succ; succ = m_dic.getNext(succ))
@@ -168,40 +215,66 @@ void BoardSearch::leftPart(Rack &iRack, Round &ioPartialWord,
 
 
 void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
-                              Results &oResults, unsigned int iNode,
+                              Results &oResults, const PartialScore &iScore,
+                              unsigned int iNode,
                               int iRow, int iCol, int iAnchor) const
 {
-    if (m_tilesMx[iRow][iCol].isEmpty())
+    if (m_grid.isEmpty(iRow, iCol))
     {
         if (m_dic.isEndOfWord(iNode) && iCol > iAnchor)
         {
-            evalMove(oResults, ioPartialWord);
+            evalMove(oResults, ioPartialWord, iScore);
         }
 
+        // No need to go further if all the letters to play are used
+        if (iScore.fromRack >= m_params.getLettersToPlay())
+            return;
+
         // Optimization: avoid entering the for loop if no tile can match
-        if (m_crossMx[iRow][iCol].isNone())
+        const Cross &cross = m_grid.getCross(iRow, iCol);
+        if (cross.isNone())
             return;
 
+        // Contribution of the square, as in getPartialScore()
+        const int letterMul = m_grid.getLetterMultiplier(iRow, iCol);
+        const int wordMul = m_grid.getWordMultiplier(iRow, iCol);
+        const int crossPoints = m_grid.getPoints(iRow, iCol);
+        PartialScore score = iScore;
+        score.wordMul *= wordMul;
+        score.fromRack++;
+
         bool hasJokerInRack = iRack.contains(Tile::Joker());
         for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
         {
             const Tile &l = Tile(m_dic.getChar(succ));
-            if (m_crossMx[iRow][iCol].check(l))
+            if (cross.check(l))
             {
                 if (iRack.contains(l))
                 {
+                    const int points = l.getPoints() * letterMul;
+                    score.letters = iScore.letters + points;
+                    score.cross = iScore.cross;
+                    if (crossPoints >= 0)
+                        score.cross += (crossPoints + points) * wordMul;
+
                     iRack.remove(l);
                     ioPartialWord.addRightFromRack(l, false);
-                    extendRight(iRack, ioPartialWord, oResults,
+                    extendRight(iRack, ioPartialWord, oResults, score,
                                 succ, iRow, iCol + 1, iAnchor);
                     ioPartialWord.removeRight();
                     iRack.add(l);
                 }
                 if (hasJokerInRack)
                 {
+                    // A joker does not give any point
+                    score.letters = iScore.letters;
+                    score.cross = iScore.cross;
+                    if (crossPoints >= 0)
+                        score.cross += crossPoints * wordMul;
+
                     iRack.remove(Tile::Joker());
                     ioPartialWord.addRightFromRack(l, true);
-                    extendRight(iRack, ioPartialWord, oResults,
+                    extendRight(iRack, ioPartialWord, oResults, score,
                                 succ, iRow, iCol + 1, iAnchor);
                     ioPartialWord.removeRight();
                     iRack.add(Tile::Joker());
@@ -211,15 +284,17 @@ void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
     }
     else
     {
-        const Tile &l = m_tilesMx[iRow][iCol];
-        wint_t upperChar = towupper(l.toChar());
+        const unsigned int code = m_grid.getCode(iRow, iCol);
         for (unsigned int succ = m_dic.getSucc(iNode); succ ; succ = m_dic.getNext(succ))
         {
-            if ((wint_t)m_dic.getChar(succ) == upperChar)
+            if (m_dic.getCode(succ) == code)
             {
-                ioPartialWord.addRightFromBoard(l);
-                extendRight(iRack, ioPartialWord,
-                            oResults, succ, iRow, iCol + 1, iAnchor);
+                PartialScore score = iScore;
+                if (!m_grid.isJoker(iRow, iCol))
+                    score.letters += m_dic.getHeader().getPoints(code);
+                ioPartialWord.addRightFromBoard(m_grid.getTile(iRow, iCol));
+                extendRight(iRack, ioPartialWord, oResults, score,
+                            succ, iRow, iCol + 1, iAnchor);
                 ioPartialWord.removeRight();
                 // The letter will be present only once in the dictionary,
                 // so we can stop looping
@@ -230,59 +305,159 @@ void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
 }
 
 
-/*
- * Computes the score of a word, coordinates may be changed to reflect
- * the real direction of the word
- */
-void BoardSearch::evalMove(Results &oResults, Round &iWord) const
+BoardSearch::PartialScore BoardSearch::getPartialScore(const Round &iWord,
+                                                      int row) const
 {
-    int fromrack = 0;
-    int pts      = 0;
-    int ptscross = 0;
-    int wordmul  = 1;
+    PartialScore score;
 
     unsigned int len = iWord.getWordLen();
-
-    int row = iWord.getCoord().getRow();
     int col = iWord.getCoord().getCol();
 
-    const BoardLayout & boardLayout = m_params.getBoardLayout();
     for (unsigned int i = 0; i < len; i++)
     {
-        if (!m_tilesMx[row][col+i].isEmpty())
+        if (!m_grid.isEmpty(row, col + i))
         {
-            if (!m_jokerMx[row][col+i])
-                pts += iWord.getTile(i).getPoints();
+            if (!m_grid.isJoker(row, col + i))
+                score.letters += iWord.getTile(i).getPoints();
         }
         else
         {
             int l;
             if (!iWord.isJoker(i))
                 l = iWord.getTile(i).getPoints() *
-                    boardLayout.getLetterMultiplier(row, col + i);
+                    m_grid.getLetterMultiplier(row, col + i);
             else
                 l = 0;
-            pts += l;
-            int wm = boardLayout.getWordMultiplier(row, col + i);
-            wordmul *= wm;
+            score.letters += l;
+            int wm = m_grid.getWordMultiplier(row, col + i);
+            score.wordMul *= wm;
 
-            int t = m_pointsMx[row][col+i];
+            int t = m_grid.getPoints(row, col + i);
             if (t >= 0)
-                ptscross += (t + l) * wm;
-            fromrack++;
+                score.cross += (t + l) * wm;
+            score.fromRack++;
         }
     }
 
-    // Ignore words using too many letters from the rack
-    if (fromrack > m_params.getLettersToPlay())
-        return;
+    return score;
+}
+
 
-    pts = ptscross + pts * wordmul;
-    if (fromrack == m_params.getLettersToPlay())
+int BoardSearch::getMaxScore(const Rack &iRack, const PartialScore &iPrefix,
+                             int row, int col, int iMinTiles) const
+{
+    const int maxTiles = std::min((int)iRack.getNbTiles(),
+                                  m_params.getLettersToPlay() - iPrefix.fromRack);
+
+    // Points of the best tiles of the rack, in decreasing order
+    int values[Round::kMaxLen];
+    int nbValues = 0;
+    for (const auto &[tile, points] : m_tilesByPoints)
     {
-        pts += m_params.getBonusPoints();
-        iWord.setBonus(true);
+        if (nbValues >= maxTiles)
+            break;
+        for (unsigned n = iRack.count(tile); n > 0 && nbValues < maxTiles; --n)
+            values[nbValues++] = points;
+    }
+
+    // When k tiles are played, they necessarily go to the first k empty
+    // squares, so the squares are known for each value of k. Only the
+    // tiles are unknown: the bound is obtained by putting the best tiles
+    // of the rack on the squares where they give the most points.
+    const Header &header = m_dic.getHeader();
+    int letters = iPrefix.letters;
+    int wordMul = iPrefix.wordMul;
+    int cross = iPrefix.cross;
+    int letterMuls[Round::kMaxLen];
+    int crossMuls[Round::kMaxLen];
+    int coefs[Round::kMaxLen];
+    int maxScore = -1;
+    for (int k = 1; k <= nbValues; ++k)
+    {
+        if (col > BOARD_MAX || m_grid.getCross(row, col).isNone())
+            break;
+
+        const int wm = m_grid.getWordMultiplier(row, col);
+        const int t = m_grid.getPoints(row, col);
+        wordMul *= wm;
+        letterMuls[k - 1] = m_grid.getLetterMultiplier(row, col);
+        crossMuls[k - 1] = t >= 0 ? wm : 0;
+        if (t >= 0)
+            cross += t * wm;
+
+        // Tiles of the board following the new tile
+        for (++col; !m_grid.isEmpty(row, col); ++col)
+        {
+            if (!m_grid.isJoker(row, col))
+                letters += header.getPoints(m_grid.getCode(row, col));
+        }
+
+        if (k < iMinTiles)
+            continue;
+
+        // Number of points given by one point of a tile on each square
+        for (int i = 0; i < k; ++i)
+            coefs[i] = letterMuls[i] * (wordMul + crossMuls[i]);
+        std::sort(coefs, coefs + k, std::greater<int>());
+
+        int score = cross + letters * wordMul;
+        for (int i = 0; i < k; ++i)
+            score += coefs[i] * values[i];
+        if (iPrefix.fromRack + k == m_params.getLettersToPlay())
+            score += m_params.getBonusPoints();
+        maxScore = std::max(maxScore, score);
+    }
+
+    return maxScore;
+}
+
+
+int BoardSearch::getAnchorMaxScore(const Rack &iRack, int row,
+                                   int col, int lastanchor) const
+{
+    if (!m_grid.isEmpty(row, col - 1))
+    {
+        // The word starts with the tiles of the board before the anchor
+        PartialScore prefix;
+        for (int c = lastanchor + 1; c < col; ++c)
+        {
+            if (!m_grid.isJoker(row, c))
+                prefix.letters += m_dic.getHeader().getPoints(m_grid.getCode(row, c));
+        }
+        return getMaxScore(iRack, prefix, row, col, 1);
     }
+
+    // The word starts with some tiles of the rack before the anchor
+    // (possibly none), and must reach the anchor
+    int maxScore = -1;
+    for (int start = col; start > lastanchor && col - start < (int)iRack.getNbTiles(); --start)
+    {
+        maxScore = std::max(maxScore,
+                            getMaxScore(iRack, PartialScore(), row, start,
+                                        col - start + 1));
+    }
+    return maxScore;
+}
+
+
+/*
+ * Computes the score of a word, coordinates may be changed to reflect
+ * the real direction of the word
+ */
+void BoardSearch::evalMove(Results &oResults, Round &iWord,
+                           const PartialScore &iScore) const
+{
+    const PartialScore &score = iScore;
+    ASSERT(score.fromRack <= m_params.getLettersToPlay(),
+           "Too many letters played from the rack");
+
+    int pts = score.cross + score.letters * score.wordMul;
+    // The word may have been a bingo before the last removed tiles,
+    // so the bonus must always be set
+    const bool bonus = score.fromRack == m_params.getLettersToPlay();
+    if (bonus)
+        pts += m_params.getBonusPoints();
+    iWord.setBonus(bonus);
     iWord.setPoints(pts);
 
     if (iWord.getCoord().getDir() == Coord::VERTICAL)
@@ -297,4 +472,3 @@ void BoardSearch::evalMove(Results &oResults, Round &iWord) const
         iWord.accessCoord().swap();
     }
 }
-
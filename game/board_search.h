@@ -21,49 +21,118 @@
 #ifndef BOARD_SEARCH_H_
 #define BOARD_SEARCH_H_
 
+#include <vector>
+#include <utility>
+
 #include "coord.h"
-#include "matrix.h"
+#include "tile.h"
 
 class Dictionary;
 class GameParams;
-class Tile;
 class Rack;
 class Results;
 class Round;
-class Cross;
+class BoardGrid;
+class SearchControl;
 
 
 class BoardSearch
 {
 public:
+    /**
+     * Constructor. If a control is given, the search of the rows stops
+     * as soon as it is cancelled.
+     */
     BoardSearch(const Dictionary &iDic,
                 const GameParams &iParams,
-                const Matrix<Tile> &iTilesMx,
-                const Matrix<Cross> &iCrossMx,
-                const Matrix<int> &iPointsMx,
-                const Matrix<bool> &iJokerMx,
-                bool isFirstTurn = false);
+                const BoardGrid &iGrid,
+                bool isFirstTurn = false,
+                const SearchControl *iControl = nullptr);
 
     void search(Rack &iRack, Results &oResults, Coord::Direction iDir) const;
 
+    /**
+     * Search the rounds anchored in the given row only.
+     * The rows are independent of each other, so several rows can be
+     * searched in parallel, as long as each search uses its own rack
+     * and results.
+     * Not available on the first turn.
+     */
+    void searchRow(Rack &iRack, Results &oResults,
+                   Coord::Direction iDir, int iRow) const;
+
 private:
     const Dictionary &m_dic;
     const GameParams &m_params;
-    const Matrix<Tile> &m_tilesMx;
-    const Matrix<Cross> &m_crossMx;
-    const Matrix<int> &m_pointsMx;
-    const Matrix<bool> &m_jokerMx;
+    const BoardGrid &m_grid;
     const bool m_firstTurn;
+    const SearchControl *m_control;
+
+    /// All the tiles of the dictionary, by decreasing number of points
+    std::vector<std::pair<Tile, int>> m_tilesByPoints;
+
+    /// Score of the tiles of a (possibly partial) word, as in evalMove()
+    struct PartialScore
+    {
+        /// Points of the letters, with their letter multipliers
+        int letters{0};
+        /// Product of the word multipliers of the new tiles
+        int wordMul{1};
+        /// Points of the cross words formed by the new tiles
+        int cross{0};
+        /// Number of tiles played from the rack
+        int fromRack{0};
+    };
+
+    /// Anchor of the words, with an upper bound of their score
+    struct Anchor
+    {
+        int row;
+        int col;
+        int lastAnchor;
+        int maxScore;
+    };
+
+    void searchRows(Rack &iRack, Results &oResults, Coord::Direction iDir,
+                    int iFirstRow, int iLastRow) const;
+
+    void searchAnchor(Rack &iRack, Round &ioPartialWord, Results &oResults,
+                      int iRow, int iCol, int iLastAnchor) const;
 
     void leftPart(Rack &iRack, Round &ioPartialWord,
                   Results &oResults, int n, int iRow,
                   int iAnchor, int iLimit) const;
 
+    /**
+     * Extend the partial word to the right, from the square iCol.
+     * iScore is the score of the tiles of the partial word, it is updated
+     * with each added tile, so that the score of a complete word is known
+     * without looking at its tiles again.
+     */
     void extendRight(Rack &iRack, Round &ioPartialWord,
-                     Results &oResults, unsigned int iNode,
+                     Results &oResults, const PartialScore &iScore,
+                     unsigned int iNode,
                      int iRow, int iCol, int iAnchor) const;
 
-    void evalMove(Results &oResults, Round &iWord) const;
+    /// Add the given word, whose tiles give the score iScore
+    void evalMove(Results &oResults, Round &iWord,
+                  const PartialScore &iScore) const;
+
+    /// Compute the score of the tiles of the given (partial) word
+    PartialScore getPartialScore(const Round &iWord, int iRow) const;
+
+    /**
+     * Return an upper bound of the score of the words starting with
+     * the tiles described by iPrefix (ending just before iCol), and
+     * continuing with at least iMinTiles tiles of iRack.
+     * Return -1 if no such word can be placed.
+     */
+    int getMaxScore(const Rack &iRack, const PartialScore &iPrefix,
+                    int iRow, int iCol, int iMinTiles) const;
+
+    /// Return an upper bound of the score of the words using the anchor
+    int getAnchorMaxScore(const Rack &iRack, int iRow,
+                          int iCol, int iLastAnchor) const;
 };
 
 #endif
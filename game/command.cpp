@@ -79,6 +79,13 @@ void UndoCmd::doUndo()
 }
 
 
+void UndoCmd::markExecuted(bool iExecuted)
+{
+    Command::markExecuted(iExecuted);
+    m_cmd->markExecuted(!iExecuted);
+}
+
+
 wstring UndoCmd::toString() const
 {
     return L"UndoCmd (" + m_cmd->toString() + L")";
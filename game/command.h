@@ -35,6 +35,8 @@ using std::wstring;
 class Command
 {
     DEFINE_LOGGER();
+    friend class Turn;
+    friend class UndoCmd;
 
     public:
         Command();
@@ -101,6 +103,14 @@ class Command
         void setAutoExecutable(bool autoExec) { m_autoExecutable = autoExec; }
 
     private:
+        /**
+         * Change the execution flag, without executing or undoing anything.
+         * This is only valid when the state of the game has been restored
+         * to a state where the command is (or is not) executed, and the
+         * command has already been executed once (its undo data is needed).
+         */
+        virtual void markExecuted(bool iExecuted) { m_executed = iExecuted; }
+
         bool m_executed{false};
         bool m_humanIndependent{true};
         bool m_autoExecutable{true};
@@ -144,6 +154,8 @@ class UndoCmd : public Command
 
     private:
         Command *m_cmd;
+
+        void markExecuted(bool iExecuted) override;
 };
 
 #endif
@@ -63,6 +63,20 @@ bool Cross::check(const Tile& iTile) const
 }
 
 
+unsigned int Cross::GetTilesMask(const vector<Tile> &iTiles)
+{
+    unsigned int mask = 0;
+    for (const Tile &tile : iTiles)
+    {
+        // A joker matches any tile accepted by the cross check
+        if (tile.isPureJoker())
+            return CROSS_MASK;
+        mask |= (1 << tile.toCode());
+    }
+    return mask;
+}
+
+
 void Cross::insert(const Tile& iTile)
 {
     m_mask |= (1 << iTile.toCode());
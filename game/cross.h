@@ -23,6 +23,7 @@
 #define CROSS_H_
 
 #include <set>
+#include <vector>
 #include "tile.h"
 #include "logging.h"
 
@@ -48,6 +49,15 @@ public:
 
     bool check(const Tile& iTile) const;
 
+    /**
+     * Return true if at least one of the tiles whose codes are set in
+     * the given mask (1 << code) is accepted. See GetTilesMask().
+     */
+    bool checkAny(unsigned int iTilesMask) const { return m_mask & iTilesMask; }
+
+    /// Return the mask of the given tiles, to be used with checkAny()
+    static unsigned int GetTilesMask(const vector<Tile> &iTiles);
+
     bool operator==(const Cross &iOther) const;
     bool operator!=(const Cross &iOther) const { return !(*this == iOther); }
 
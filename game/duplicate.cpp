@@ -90,7 +90,7 @@ int Duplicate::play(const wstring &iCoord, const wstring &iWord)
 }
 
 
-void Duplicate::playAI(unsigned int p)
+void Duplicate::playAI(unsigned int p, const Results *iAllResults)
 {
     ASSERT(p < getNPlayers(), "Wrong player number");
     ASSERT(!hasPlayed(p), "AI player has already played");
@@ -98,7 +98,10 @@ void Duplicate::playAI(unsigned int p)
     auto *player = dynamic_cast<AIPlayer*>(m_players[p]);
     ASSERT(player != nullptr, "AI requested for a human player");
 
-    player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
+    if (iAllResults != nullptr)
+        player->compute(getDic(), getBoard(), *iAllResults);
+    else
+        player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
     const Move &move = player->getMove();
     if (move.isChangeLetters() || move.isPass())
     {
@@ -182,13 +185,41 @@ void Duplicate::tryEndTurn()
     // make AI players play their turn
     // Some may have already played, in arbitration mode, if the future turns
     // were removed (because of the isHumanIndependent() behaviour)
+    vector<unsigned int> aiPlayers;
+    bool needsAllRounds = false;
     for (unsigned int i = 0; i < getNPlayers(); i++)
     {
         if (!m_players[i]->isHuman() && !hasPlayed(i))
         {
-            playAI(i);
+            aiPlayers.push_back(i);
+            const auto *player = dynamic_cast<const AIPlayer*>(m_players[i]);
+            needsAllRounds = needsAllRounds || player->needsAllRounds();
+        }
+    }
+
+    // All the players have the same rack: instead of letting each AI
+    // player perform the same search, find all the rounds only once,
+    // and let each player choose its move among them.
+    // When no player needs all the rounds, the pruned searches of the
+    // players are cheaper than a complete one.
+    if (aiPlayers.size() >= 2 && needsAllRounds)
+    {
+        const Rack &rack = m_players[aiPlayers[0]]->getCurrentRack().getRack();
+        LimitResults allResults(0);
+        allResults.search(getDic(), getBoard(), rack,
+                          getHistory().beforeFirstRound());
+        for (unsigned int i : aiPlayers)
+        {
+            ASSERT(m_players[i]->getCurrentRack().getRack() == rack,
+                   "AI players should all have the same rack");
+            playAI(i, &allResults);
         }
     }
+    else
+    {
+        for (unsigned int i : aiPlayers)
+            playAI(i);
+    }
 
     // Next turn
     endTurn();
@@ -372,6 +403,31 @@ bool Duplicate::hasPlayed(unsigned iPlayerId) const
 }
 
 
+/// Game state, including the master move
+struct Duplicate::DuplicateState: public Game::State
+{
+    explicit DuplicateState(const Duplicate &iGame)
+        : Game::State(iGame), masterMove(iGame.m_masterMove) {}
+
+    Move masterMove;
+};
+
+
+unique_ptr<GameState> Duplicate::saveState() const
+{
+    return make_unique<DuplicateState>(*this);
+}
+
+
+bool Duplicate::restoreState(const GameState &iState)
+{
+    if (!Game::restoreState(iState))
+        return false;
+    m_masterMove = static_cast<const DuplicateState &>(iState).masterMove;
+    return true;
+}
+
+
 void Duplicate::innerSetMasterMove(const Move &iMove)
 {
     m_masterMove = iMove;
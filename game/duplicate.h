@@ -28,6 +28,7 @@
 class Player;
 class Move;
 class PlayerEventCmd;
+class Results;
 
 using std::string;
 using std::wstring;
@@ -147,13 +148,24 @@ protected:
      */
     void setSoloAuto(unsigned int minNbPlayers, int iSoloValue);
 
+    /// Also save the master move
+    unique_ptr<GameState> saveState() const override;
+    bool restoreState(const GameState &iState) override;
+
 private: // Used by friend classes
     void innerSetMasterMove(const Move &iMove);
     bool isArbitrationGame() const;
 
 private:
-    /// Make the AI player whose ID is p play its turn
-    void playAI(unsigned int p);
+    struct DuplicateState;
+
+    /**
+     * Make the AI player whose ID is p play its turn.
+     * If iAllResults is given, it must contain all the rounds playable
+     * with the rack of the player, and the player will choose its move
+     * among them instead of performing its own search.
+     */
+    void playAI(unsigned int p, const Results *iAllResults = nullptr);
 
     /**
      * Find the player who scored the most  (with a valid move) at this turn.
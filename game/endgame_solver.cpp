@@ -0,0 +1,368 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "endgame_solver.h"
+#include "dic.h"
+#include "tile.h"
+#include "results.h"
+#include "random.h"
+#include "thread_pool.h"
+#include "encoding.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, EndgameSolver);
+
+/// Bound of the values (much higher than any possible score difference)
+static const int kINFINITY = 10000;
+
+
+/// Return the sum of the points of the tiles of the rack
+static int GetRackPoints(const Rack &iRack)
+{
+    vector<Tile> tiles;
+    iRack.getTiles(tiles);
+    int points = 0;
+    for (const Tile &tile : tiles)
+        points += tile.getPoints();
+    return points;
+}
+
+
+EndgameSolver::EndgameSolver(const Dictionary &iDic, const Board &iBoard,
+                             const Rack &iRack, const Rack &iOppRack,
+                             unsigned iPassesInARow, unsigned iPassesToEnd)
+    : m_dic(iDic), m_root{iBoard, {iRack, iOppRack}},
+    m_rootPasses(iPassesInARow), m_passesToEnd(iPassesToEnd),
+    m_table(kTABLE_SIZE)
+{
+    ASSERT(m_rootPasses < m_passesToEnd, "The game is already finished");
+}
+
+
+void EndgameSolver::getRounds(const Board &iBoard, const Rack &iRack,
+                              vector<Round> &oRounds) const
+{
+    // The search cache is not used, the positions are too short-lived
+    LimitResults results(0);
+    iBoard.search(m_dic, iRack, results);
+    oRounds.clear();
+    for (unsigned i = 0; i < results.size(); ++i)
+        oRounds.push_back(results.get(i));
+    // The rounds are not sorted by Board::search(). The order must be
+    // stable, since the best moves are stored as indices.
+    std::stable_sort(oRounds.begin(), oRounds.end(),
+                     [](const Round &a, const Round &b) {
+                         return a.getPoints() > b.getPoints();
+                     });
+}
+
+
+uint64_t EndgameSolver::getKey(const Position &iPos, unsigned iSide, unsigned iPasses) const
+{
+    const uint64_t ownHash = iPos.racks[iSide].getHash();
+    const uint64_t oppHash = iPos.racks[1 - iSide].getHash();
+    return iPos.board.getHash() ^ Random::mixBits(ownHash) ^
+        Random::mixBits(Random::mixBits(oppHash) ^ iPasses);
+}
+
+
+bool EndgameSolver::lookup(uint64_t iKey, Entry &oEntry)
+{
+    const unsigned index = iKey & (kTABLE_SIZE - 1);
+    std::lock_guard<std::mutex> lock(m_locks[index % kNB_LOCKS]);
+    if (m_table[index].key != iKey)
+        return false;
+    oEntry = m_table[index];
+    return true;
+}
+
+
+void EndgameSolver::store(const Entry &iEntry)
+{
+    const unsigned index = iEntry.key & (kTABLE_SIZE - 1);
+    std::lock_guard<std::mutex> lock(m_locks[index % kNB_LOCKS]);
+    // Keep the deepest result for a given position
+    Entry &entry = m_table[index];
+    if (entry.key != iEntry.key || entry.depth <= iEntry.depth)
+        entry = iEntry;
+}
+
+
+int EndgameSolver::evalMove(Position &ioPos, unsigned iSide, unsigned iPasses,
+                            const vector<Round> &iRounds, unsigned iIndex,
+                            unsigned iDepth, int iAlpha, int iBeta, bool &oHorizon)
+{
+    oHorizon = false;
+    if (iIndex == iRounds.size())
+    {
+        // Pass
+        return -negamax(ioPos, 1 - iSide, iPasses + 1, iDepth - 1,
+                        -iBeta, -iAlpha, oHorizon);
+    }
+
+    const Round &round = iRounds[iIndex];
+    const int points = round.getPoints();
+    Rack &rack = ioPos.racks[iSide];
+    const Rack savedRack = rack;
+    rack.removePlayedTiles(round);
+
+    int value;
+    if (rack.isEmpty())
+    {
+        // End of the game: the player gets the points of the opponent's
+        // rack, and the opponent loses them
+        value = points + 2 * GetRackPoints(ioPos.racks[1 - iSide]);
+    }
+    else
+    {
+        ioPos.board.addRound(m_dic, round);
+        value = points - negamax(ioPos, 1 - iSide, 0, iDepth - 1,
+                                 points - iBeta, points - iAlpha, oHorizon);
+        ioPos.board.removeRound(m_dic, round);
+    }
+    rack = savedRack;
+    return value;
+}
+
+
+int EndgameSolver::negamax(Position &ioPos, unsigned iSide, unsigned iPasses,
+                           unsigned iDepth, int iAlpha, int iBeta, bool &oHorizon)
+{
+    ++m_nbNodes;
+    if (m_hasDeadline && std::chrono::steady_clock::now() > m_deadline)
+        throw TimeoutException();
+
+    oHorizon = false;
+    // Blocked game: each player loses the points of his rack
+    if (iPasses >= m_passesToEnd)
+        return GetRackPoints(ioPos.racks[1 - iSide]) - GetRackPoints(ioPos.racks[iSide]);
+    if (iDepth == 0)
+    {
+        oHorizon = true;
+        return 0;
+    }
+
+    const uint64_t key = getKey(ioPos, iSide, iPasses);
+    Entry entry;
+    int hintIndex = -1;
+    if (lookup(key, entry))
+    {
+        if (entry.depth >= iDepth)
+        {
+            oHorizon = entry.depth != kSOLVED_DEPTH;
+            if (entry.bound == kEXACT ||
+                (entry.bound == kLOWER && entry.value >= iBeta) ||
+                (entry.bound == kUPPER && entry.value <= iAlpha))
+            {
+                return entry.value;
+            }
+        }
+        hintIndex = entry.bestIndex;
+    }
+
+    vector<Round> rounds;
+    getRounds(ioPos.board, ioPos.racks[iSide], rounds);
+
+    // Moves ordered by decreasing scores (the pass being the last one),
+    // except for the best move of a previous search, tried first
+    vector<unsigned> order;
+    if (hintIndex >= 0 && (unsigned)hintIndex <= rounds.size())
+        order.push_back(hintIndex);
+    for (unsigned i = 0; i <= rounds.size(); ++i)
+    {
+        if ((int)i != hintIndex)
+            order.push_back(i);
+    }
+
+    const int initialAlpha = iAlpha;
+    int bestValue = -kINFINITY;
+    unsigned bestIndex = order[0];
+    bool horizon = false;
+    for (unsigned index : order)
+    {
+        bool childHorizon;
+        const int value = evalMove(ioPos, iSide, iPasses, rounds, index,
+                                   iDepth, iAlpha, iBeta, childHorizon);
+        horizon = horizon || childHorizon;
+        if (value > bestValue)
+        {
+            bestValue = value;
+            bestIndex = index;
+        }
+        iAlpha = std::max(iAlpha, bestValue);
+        if (iAlpha >= iBeta)
+            break;
+    }
+
+    entry.key = key;
+    entry.value = bestValue;
+    entry.depth = horizon ? iDepth : kSOLVED_DEPTH;
+    if (bestValue <= initialAlpha)
+        entry.bound = kUPPER;
+    else if (bestValue >= iBeta)
+        entry.bound = kLOWER;
+    else
+        entry.bound = kEXACT;
+    entry.bestIndex = bestIndex;
+    store(entry);
+
+    oHorizon = horizon;
+    return bestValue;
+}
+
+
+void EndgameSolver::searchRoot(const vector<Round> &iRounds, unsigned iDepth,
+                               unsigned &ioBestIndex, int &oValue, bool &oHorizon)
+{
+    // The best move of the previous iteration is searched first, to get
+    // a good bound for the other ones
+    Position pos = m_root;
+    int bestValue = evalMove(pos, 0, m_rootPasses, iRounds, ioBestIndex, iDepth,
+                             -kINFINITY, kINFINITY, oHorizon);
+    unsigned bestIndex = ioBestIndex;
+
+    // The other moves are searched in parallel, each task using the best
+    // value known when it starts. The window includes the best value, so
+    // that the ties are always resolved in the same way (the lowest index
+    // wins, i.e. the highest score).
+    std::mutex bestMutex;
+    ThreadPool::Instance().run(iRounds.size() + 1, [&](unsigned iIndex) {
+        if (iIndex == ioBestIndex)
+            return;
+        int alpha;
+        {
+            std::lock_guard<std::mutex> lock(bestMutex);
+            alpha = bestValue - 1;
+        }
+        Position taskPos = m_root;
+        bool horizon;
+        const int value = evalMove(taskPos, 0, m_rootPasses, iRounds, iIndex, iDepth,
+                                   alpha, kINFINITY, horizon);
+
+        std::lock_guard<std::mutex> lock(bestMutex);
+        oHorizon = oHorizon || horizon;
+        if (value > bestValue || (value == bestValue && iIndex < bestIndex))
+        {
+            bestValue = value;
+            bestIndex = iIndex;
+        }
+    });
+
+    ioBestIndex = bestIndex;
+    oValue = bestValue;
+}
+
+
+void EndgameSolver::buildLine(const vector<Round> &iRounds, unsigned iBestIndex,
+                              unsigned iDepth, vector<Move> &oLine)
+{
+    Position pos = m_root;
+    vector<Round> rounds = iRounds;
+    unsigned index = iBestIndex;
+    unsigned side = 0;
+    unsigned passes = m_rootPasses;
+    for (unsigned ply = 0; ply < iDepth; ++ply)
+    {
+        if (index == rounds.size())
+        {
+            oLine.push_back(Move(L""));
+            if (++passes >= m_passesToEnd)
+                break;
+        }
+        else
+        {
+            const Round &round = rounds[index];
+            oLine.push_back(Move(round));
+            pos.racks[side].removePlayedTiles(round);
+            if (pos.racks[side].isEmpty())
+                break;
+            pos.board.addRound(m_dic, round);
+            passes = 0;
+        }
+        side = 1 - side;
+
+        Entry entry;
+        if (!lookup(getKey(pos, side, passes), entry))
+            break;
+        getRounds(pos.board, pos.racks[side], rounds);
+        index = entry.bestIndex;
+        if (index > rounds.size())
+            break;
+    }
+}
+
+
+EndgameResult EndgameSolver::solve(unsigned iTimeLimit)
+{
+    EndgameResult result;
+    m_deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(iTimeLimit);
+
+    vector<Round> rounds;
+    getRounds(m_root.board, m_root.racks[0], rounds);
+
+    // Each ply uses at least one tile, except the passes, and there are
+    // less than m_passesToEnd passes in a row
+    const unsigned maxDepth =
+        std::min<unsigned>(m_passesToEnd * (m_root.racks[0].getNbTiles() +
+                                            m_root.racks[1].getNbTiles() + 1),
+                           kSOLVED_DEPTH - 1);
+
+    unsigned bestIndex = 0;
+    for (unsigned depth = 1; depth <= maxDepth; ++depth)
+    {
+        // The first iteration is cheap, and always completed
+        m_hasDeadline = iTimeLimit > 0 && depth > 1;
+        int value;
+        bool horizon = false;
+        unsigned index = bestIndex;
+        try
+        {
+            searchRoot(rounds, depth, index, value, horizon);
+        }
+        catch (const TimeoutException &)
+        {
+            LOG_DEBUG("Time limit reached at depth {}", depth);
+            break;
+        }
+
+        bestIndex = index;
+        result.value = value;
+        result.depth = depth;
+        LOG_DEBUG("Depth {}: value {} ({} nodes)", depth, value, m_nbNodes.load());
+        if (!horizon)
+        {
+            result.solved = true;
+            break;
+        }
+    }
+
+    result.move = bestIndex == rounds.size() ? Move(L"") : Move(rounds[bestIndex]);
+    result.nbNodes = m_nbNodes;
+    buildLine(rounds, bestIndex, result.depth, result.line);
+    LOG_INFO("Endgame: {} (value: {}, depth: {}, solved: {}, nodes: {})",
+             lfw(result.move.toString()), result.value, result.depth,
+             result.solved, result.nbNodes);
+    return result;
+}
+
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef ENDGAME_SOLVER_H_
+#define ENDGAME_SOLVER_H_
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+#include "board.h"
+#include "rack.h"
+#include "round.h"
+#include "move.h"
+#include "logging.h"
+
+class Dictionary;
+
+using std::vector;
+
+
+/// Result of the search of EndgameSolver
+struct EndgameResult
+{
+    /// Best move for the player to move
+    Move move;
+    /**
+     * Expected difference between the points of the player to move
+     * and the points of his opponent, from now to the end of the game
+     */
+    int value{0};
+    /// Depth (in plies) of the last complete iteration
+    unsigned depth{0};
+    /// True if the value is exact, i.e. the whole game tree was explored
+    bool solved{false};
+    /// Number of positions explored
+    uint64_t nbNodes{0};
+    /// Expected sequence of moves, starting with the best move
+    vector<Move> line;
+};
+
+
+/**
+ * Solver for the end of a free game between 2 players, when the bag is
+ * empty: both racks are then known, and the game can be explored
+ * exhaustively.
+ *
+ * The solver uses an iterative deepening negamax search with alpha-beta
+ * pruning. The moves of a position are the rounds found by Board::search()
+ * (ordered by decreasing scores) and the pass. The rules are the ones of
+ * FreeGame: the game ends when a player plays all his tiles (he gets the
+ * points of the rack of his opponent, which the opponent loses), or when
+ * the given number of passes in a row is reached (each player loses the
+ * points of his own rack). The passes played before the solved position
+ * are taken into account.
+ * The positions already evaluated are kept in a transposition table, keyed
+ * by the hash of the board, the two racks and the number of passes.
+ *
+ * The root moves are evaluated in parallel in the ThreadPool, and the
+ * search stops when the time limit is reached, keeping the result of the
+ * last complete iteration.
+ */
+class EndgameSolver
+{
+    DEFINE_LOGGER();
+public:
+    /**
+     * Constructor. The racks are the ones of the player to move and of
+     * his opponent. The bag is supposed to be empty.
+     * iPassesInARow is the number of passes played just before the
+     * position, and the game ends when iPassesToEnd passes are played
+     * in a row.
+     */
+    EndgameSolver(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, const Rack &iOppRack,
+                  unsigned iPassesInARow, unsigned iPassesToEnd);
+
+    /**
+     * Search the best move, stopping after iTimeLimit milliseconds
+     * (0 for no limit). The first iteration is always completed.
+     */
+    EndgameResult solve(unsigned iTimeLimit);
+
+private:
+    /// Board and racks of a position, modified during the search
+    struct Position
+    {
+        Board board;
+        /// Racks of the player to move at the root, and of his opponent
+        Rack racks[2];
+    };
+
+    /// Kind of value stored in the transposition table
+    enum Bound : uint8_t { kEXACT, kLOWER, kUPPER };
+
+    struct Entry
+    {
+        uint64_t key{0};
+        int16_t value{0};
+        /// Depth of the search, or kSOLVED_DEPTH if the value is final
+        uint8_t depth{0};
+        Bound bound{kEXACT};
+        /// Index of the best move (the pass being after the rounds)
+        uint16_t bestIndex{0};
+    };
+
+    static const uint8_t kSOLVED_DEPTH = 255;
+    static const unsigned kTABLE_SIZE = 1 << 18;
+    static const unsigned kNB_LOCKS = 64;
+
+    const Dictionary &m_dic;
+    Position m_root;
+    unsigned m_rootPasses;
+    unsigned m_passesToEnd;
+
+    vector<Entry> m_table;
+    std::mutex m_locks[kNB_LOCKS];
+
+    std::atomic<uint64_t> m_nbNodes{0};
+    std::chrono::steady_clock::time_point m_deadline;
+    bool m_hasDeadline{false};
+
+    /// Thrown when the time limit is reached
+    struct TimeoutException {};
+
+    /// Return the rounds playable with the given rack, by decreasing scores
+    void getRounds(const Board &iBoard, const Rack &iRack,
+                   vector<Round> &oRounds) const;
+
+    uint64_t getKey(const Position &iPos, unsigned iSide, unsigned iPasses) const;
+    bool lookup(uint64_t iKey, Entry &oEntry);
+    void store(const Entry &iEntry);
+
+    /**
+     * Negamax search of the position, iSide being the index of the rack
+     * of the player to move. oHorizon is set to true if the depth limit
+     * was reached in the explored subtree.
+     */
+    int negamax(Position &ioPos, unsigned iSide, unsigned iPasses,
+                unsigned iDepth, int iAlpha, int iBeta, bool &oHorizon);
+
+    /**
+     * Play the move with the given index (the pass if iIndex is the number
+     * of rounds), search the resulting position and undo the move.
+     * Return the value of the move for the player to move.
+     */
+    int evalMove(Position &ioPos, unsigned iSide, unsigned iPasses,
+                 const vector<Round> &iRounds, unsigned iIndex,
+                 unsigned iDepth, int iAlpha, int iBeta, bool &oHorizon);
+
+    /// Search the root position at the given depth
+    void searchRoot(const vector<Round> &iRounds, unsigned iDepth,
+                    unsigned &ioBestIndex, int &oValue, bool &oHorizon);
+
+    /// Follow the best moves stored in the transposition table
+    void buildLine(const vector<Round> &iRounds, unsigned iBestIndex,
+                   unsigned iDepth, vector<Move> &oLine);
+};
+
+#endif
+
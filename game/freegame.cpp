@@ -22,7 +22,16 @@
 #include <iomanip>
 #include <cwctype>
 
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
 #include "freegame.h"
+#include "endgame_solver.h"
 #include "game_exception.h"
 #include "dic.h"
 #include "tile.h"
@@ -81,8 +90,16 @@ void FreeGame::playAI(unsigned int p)
 
     auto *player = static_cast<AIPlayer*>(m_players[p]);
 
-    player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
-    const Move &move = player->getMove();
+    // Once the bag is empty, the endgame solver can replace the AI
+    Move move;
+    const int endgameTime = Settings::Instance().getInt("freegame.endgame-time");
+    if (endgameTime > 0 && isEndgame())
+        move = solveEndgame(endgameTime).move;
+    else
+    {
+        player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
+        move = player->getMove();
+    }
     if (move.isChangeLetters() || move.isPass())
     {
         ASSERT(checkPass(*player, move.getChangedLetters()) == 0,
@@ -254,6 +271,30 @@ void FreeGame::endGame(unsigned iWinningPlayer)
 }
 
 
+bool FreeGame::isEndgame() const
+{
+    if (isFinished() || getNPlayers() != 2 || getHistory().beforeFirstRound())
+        return false;
+    Bag bag(getBag());
+    realBag(bag);
+    return bag.getNbTiles() == 0;
+}
+
+
+EndgameResult FreeGame::solveEndgame(unsigned iTimeLimit) const
+{
+    if (!isEndgame())
+        throw GameException(_("The endgame solver needs 2 players and an empty bag"));
+
+    const Rack &rack = getPlayer(m_currPlayer).getCurrentRack().getRack();
+    const Rack &oppRack = getPlayer(1 - m_currPlayer).getCurrentRack().getRack();
+    // Use the same rule as endTurn() for the end of a blocked game
+    EndgameSolver solver(getDic(), getBoard(), rack, oppRack,
+                         getNbPassesInARow(), kNB_PASSES * getNPlayers());
+    return solver.solve(iTimeLimit);
+}
+
+
 int FreeGame::checkPass(const Player &iPlayer,
                         const wstring &iToChange) const
 {
@@ -268,7 +309,7 @@ int FreeGame::checkPass(const Player &iPlayer,
     // It is forbidden to change letters when the bag does not contain at
     // least 7 letters (this is explicitly stated in the ODS). But it is
     // still allowed to pass
-    Bag bag(getDic());
+    Bag bag(getBag());
     realBag(bag);
     if (bag.getNbTiles() < 7 && !iToChange.empty())
     {
@@ -319,26 +360,29 @@ int FreeGame::pass(const wstring &iToChange)
 }
 
 
-bool FreeGame::allPlayersPassedThreeTimesInARow() const
+unsigned FreeGame::getNbPassesInARow() const
 {
-    const unsigned NB_OF_PASSES = 3;
-    // Only one player really plays at each turn
-    const unsigned NB_TURNS_TO_CHECK = NB_OF_PASSES * getNPlayers();
-
-    bool result = true;
-    for (const Player *player : m_players)
+    // All the players have the same number of turns
+    const unsigned nbTurns = m_players[0]->getHistory().getSize();
+    unsigned nbPasses = 0;
+    for (; nbPasses < nbTurns; ++nbPasses)
     {
-        const History &history = player->getHistory();
-        result = result && (history.getSize() >= NB_TURNS_TO_CHECK);
-        for (unsigned turnNb = history.getSize() - NB_TURNS_TO_CHECK;
-             turnNb < history.getSize();
-             ++turnNb)
+        const unsigned turnNb = nbTurns - 1 - nbPasses;
+        for (const Player *player : m_players)
         {
-            const Move &move = history.getTurn(turnNb).getMove();
+            const Move &move = player->getHistory().getTurn(turnNb).getMove();
             // Players who did not play got a null move for the turn
-            result = result && (move.isPass() || move.isNull());
+            if (!move.isPass() && !move.isNull())
+                return nbPasses;
         }
     }
-    return result;
+    return nbPasses;
+}
+
+
+bool FreeGame::allPlayersPassedThreeTimesInARow() const
+{
+    // Only one player really plays at each turn
+    return getNbPassesInARow() >= kNB_PASSES * getNPlayers();
 }
 
@@ -25,6 +25,7 @@
 #include "logging.h"
 
 class Player;
+struct EndgameResult;
 
 using std::string;
 using std::wstring;
@@ -80,7 +81,22 @@ public:
      */
     int pass(const wstring &iToChange);
 
+    /**
+     * Return true if the game is between 2 players, and the bag is empty,
+     * so that the end of the game can be solved (see EndgameSolver)
+     */
+    bool isEndgame() const;
+
+    /**
+     * Search the best move for the current player, with the endgame solver.
+     * @exception GameException if isEndgame() is false
+     */
+    EndgameResult solveEndgame(unsigned iTimeLimit) const;
+
 private:
+    /// Number of passes of each player in a row ending the game
+    static const unsigned kNB_PASSES = 3;
+
     /// True if the game is finished, false otherwise
     bool m_finished{false};
 
@@ -109,6 +125,9 @@ private:
      */
     int checkPass(const Player &iPlayer, const wstring &iToChange) const;
 
+    /// Number of turns at the end of the game where the player passed
+    unsigned getNbPassesInARow() const;
+
     bool allPlayersPassedThreeTimesInARow() const;
 };
 
@@ -57,6 +57,7 @@ Game::Game(const GameParams &iParams, const Game *iMasterGame):
 {
     m_points = 0;
     m_currPlayer = 0;
+    m_navigation.setStateHandler(this);
 }
 
 
@@ -70,6 +71,42 @@ Game::~Game()
 }
 
 
+Game::State::State(const Game &iGame):
+    board(iGame.m_board), bag(iGame.m_bag), history(iGame.m_history),
+    points(iGame.m_points), currPlayer(iGame.m_currPlayer)
+{
+    for (const Player *p : iGame.m_players)
+    {
+        playersHistory.push_back(p->getHistory());
+    }
+}
+
+
+unique_ptr<GameState> Game::saveState() const
+{
+    return make_unique<State>(*this);
+}
+
+
+bool Game::restoreState(const GameState &iState)
+{
+    const State &state = static_cast<const State &>(iState);
+    if (state.playersHistory.size() != m_players.size())
+        return false;
+
+    m_board = state.board;
+    m_bag = state.bag;
+    m_history = state.history;
+    m_points = state.points;
+    m_currPlayer = state.currPlayer;
+    for (unsigned int i = 0; i < m_players.size(); ++i)
+    {
+        m_players[i]->accessHistory() = state.playersHistory[i];
+    }
+    return true;
+}
+
+
 Player& Game::accessPlayer(unsigned int iNum)
 {
     ASSERT(iNum < m_players.size(), "Wrong player number");
@@ -121,10 +158,7 @@ void Game::realBag(Bag &ioBag) const
         for (const Player *player : m_players)
         {
             player->getCurrentRack().getAllTiles(tiles);
-            for (const Tile &tile : tiles)
-            {
-                ioBag.takeTile(tile);
-            }
+            ioBag.takeTiles(tiles);
         }
     }
     else
@@ -132,10 +166,7 @@ void Game::realBag(Bag &ioBag) const
         // In training or duplicate mode, take the rack of the current
         // player only
         getPlayer(m_currPlayer).getCurrentRack().getAllTiles(tiles);
-        for (const Tile &tile : tiles)
-        {
-            ioBag.takeTile(tile);
-        }
+        ioBag.takeTiles(tiles);
     }
 }
 
@@ -160,15 +191,12 @@ bool Game::canDrawRack(const PlayedRack &iPld, bool iCheck, int *reason) const
     // Create a copy of the bag in which we can do everything we want,
     // and take from it the tiles of the players rack so that "bag"
     // contains the right number of tiles.
-    Bag bag(getDic());
+    Bag bag(getBag());
     realBag(bag);
     // Replace all the tiles of the given rack into the bag
     vector<Tile> tiles;
     iPld.getAllTiles(tiles);
-    for (const Tile &tile : tiles)
-    {
-        bag.replaceTile(tile);
-    }
+    bag.replaceTiles(tiles);
 
     // Nothing in the rack, nothing in the bag --> end of the (free)game
     if (bag.getNbTiles() == 0)
@@ -282,7 +310,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
     // Create a copy of the bag in which we can do everything we want,
     // and take from it the tiles of the players rack so that "bag"
     // contains the right number of tiles.
-    Bag bag(getDic());
+    Bag bag(getBag());
     realBag(bag);
     if (mode == RACK_NEW && nold != 0)
     {
@@ -290,10 +318,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         // letters of the player)
         vector<Tile> tiles;
         pld.getNewTiles(tiles);
-        for (const Tile &tile : tiles)
-        {
-            bag.replaceTile(tile);
-        }
+        bag.replaceTiles(tiles);
         pld.resetNew();
     }
     else if ((mode == RACK_NEW && nold == 0) || mode == RACK_ALL)
@@ -301,10 +326,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         // Replace all the tiles in the bag before choosing random ones
         vector<Tile> tiles;
         pld.getAllTiles(tiles);
-        for (const Tile &tile : tiles)
-        {
-            bag.replaceTile(tile);
-        }
+        bag.replaceTiles(tiles);
         // RACK_NEW with an empty rack is equivalent to RACK_ALL
         pld.reset();
         // Do not forget to update nold, for the RACK_ALL case
@@ -377,10 +399,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         // Bad luck... we have to reject the rack
         vector<Tile> rejectedTiles;
         pld.getAllTiles(rejectedTiles);
-        for (const Tile &rejTile : rejectedTiles)
-        {
-            bag.replaceTile(rejTile);
-        }
+        bag.replaceTiles(rejectedTiles);
         pld.reset();
         // Do not mark the rack as rejected if it was empty
         if (nold > 0)
@@ -636,6 +655,9 @@ int Game::checkPlayedWord(const wstring &iCoord,
     {
         tiles.emplace_back(wc);
     }
+    // A word longer than the board cannot fit anyway
+    if (tiles.size() > Round::kMaxLen)
+        return 12;
     round.setWord(tiles);
 
     // Check the word position, compute its points,
@@ -47,7 +47,7 @@ using namespace std;
  * It offers the common attributes (Board, Bag, etc...) as well as useful
  * "helper" methods to factorize some code.
  */
-class Game
+class Game: private GameStateHandler
 {
     DEFINE_LOGGER();
 public:
@@ -260,6 +260,27 @@ protected:
      */
     Game(const GameParams &iParams, const Game *iMasterGame);
 
+    /**
+     * State of the game modified by the commands, saved and restored
+     * by the navigation. Subclasses with additional state must extend it,
+     * and override saveState() and restoreState().
+     */
+    struct State: public GameState
+    {
+        explicit State(const Game &iGame);
+
+        Board board;
+        Bag bag;
+        History history;
+        int points;
+        unsigned int currPlayer;
+        /// History of each player
+        vector<History> playersHistory;
+    };
+
+    unique_ptr<GameState> saveState() const override;
+    bool restoreState(const GameState &iState) override;
+
     /*********************************************************
      * Helper functions
      *********************************************************/
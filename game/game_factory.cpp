@@ -47,6 +47,7 @@
 #include "dic.h"
 #include "encoding.h"
 #include "xml_reader.h"
+#include "bin_reader.h"
 
 
 INIT_LOGGER(game, GameFactory);
@@ -241,6 +242,8 @@ Game *GameFactory::createFromCmdLine(int argc, char **argv)
 
 Game* GameFactory::load(const string &iFileName, const Dictionary &iDic)
 {
+    if (BinReader::IsBinFile(iFileName))
+        return BinReader::read(iFileName, iDic);
     return XmlReader::read(iFileName, iDic);
 }
 
@@ -157,7 +157,8 @@ string WordLettersHint::giveHint(const Move &iMove) const
 {
     LOG_DEBUG("Getting hint for move: {}", lfw(iMove.toString()));
     ASSERT(iMove.isValid(), "Hints only make sense for valid moves");
-    vector<Tile> tiles = iMove.getRound().getTiles();
+    const auto wordTiles = iMove.getRound().getTiles();
+    vector<Tile> tiles(wordTiles.begin(), wordTiles.end());
     // Sort the letters (we cannot sort directly the wstring from
     // Round::getWord(), because it would break digraph characters)
     std::ranges::sort(tiles, std::less());
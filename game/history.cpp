@@ -51,6 +51,33 @@ History::~History()
 }
 
 
+History::History(const History &iOther)
+{
+    for (const TurnData *turn : iOther.m_history)
+    {
+        m_history.push_back(new TurnData(*turn));
+    }
+}
+
+
+History & History::operator=(const History &iOther)
+{
+    if (this == &iOther)
+        return *this;
+    for (TurnData *turn : m_history)
+    {
+        delete turn;
+    }
+    m_history.clear();
+    for (const TurnData *turn : iOther.m_history)
+    {
+        m_history.push_back(new TurnData(*turn));
+    }
+    ++m_revision;
+    return *this;
+}
+
+
 unsigned int History::getSize() const
 {
     ASSERT(!m_history.empty(), "Invalid history size");
@@ -67,6 +94,7 @@ const PlayedRack& History::getCurrentRack() const
 void History::setCurrentRack(const PlayedRack &iPld)
 {
     m_history.back()->setPlayedRack(iPld);
+    ++m_revision;
 }
 
 
@@ -108,6 +136,7 @@ void History::playMove(const Move &iMove,
     auto * next_turn = new TurnData();
     next_turn->setPlayedRack(iNewRack);
     m_history.push_back(next_turn);
+    ++m_revision;
 }
 
 
@@ -122,6 +151,7 @@ void History::removeLastTurn()
         m_history.pop_back();
         delete t;
     }
+    ++m_revision;
 
 #ifdef BACK_REMOVE_RACK_NEW_PART
     // Now we have the previous played round in back()
@@ -136,6 +166,7 @@ void History::addWarning()
 {
     ASSERT(m_history.size() > 1, "Too short history");
     m_history[m_history.size() - 2]->addWarning();
+    ++m_revision;
 }
 
 
@@ -143,6 +174,7 @@ void History::removeWarning()
 {
     ASSERT(m_history.size() > 1, "Too short history");
     m_history[m_history.size() - 2]->addWarning(-1);
+    ++m_revision;
 }
 
 
@@ -150,6 +182,7 @@ void History::addPenaltyPoints(int iPoints)
 {
     ASSERT(m_history.size() > 1, "Too short history");
     m_history[m_history.size() - 2]->addPenaltyPoints(iPoints);
+    ++m_revision;
 }
 
 
@@ -157,6 +190,7 @@ void History::addSoloPoints(int iPoints)
 {
     ASSERT(m_history.size() > 1, "Too short history");
     m_history[m_history.size() - 2]->addSoloPoints(iPoints);
+    ++m_revision;
 }
 
 
@@ -164,6 +198,7 @@ void History::addEndGamePoints(int iPoints)
 {
     ASSERT(m_history.size() > 1, "Too short history");
     m_history[m_history.size() - 2]->addEndGamePoints(iPoints);
+    ++m_revision;
 }
 
 
@@ -59,6 +59,10 @@ public:
     History();
     ~History();
 
+    /// Deep copy of the turns
+    History(const History &iOther);
+    History & operator=(const History &iOther);
+
     /// Get the size of the history (without the current incomplete turn)
     unsigned int getSize() const;
 
@@ -74,6 +78,14 @@ public:
     /// Get turn 'n' (starting at 0)
     const TurnData& getTurn(unsigned int) const;
 
+    /**
+     * Return a number which changes every time the history is modified.
+     * It allows the interfaces to detect cheaply which histories need to
+     * be displayed again. It is not saved, and it is not copied with the
+     * history.
+     */
+    unsigned getRevision() const { return m_revision; }
+
     /**
      * Return true if the history doesn't contain at least one move
      * corresponding to a valid round, false otherwise.
@@ -102,6 +114,9 @@ public:
 
  private:
     vector<TurnData*> m_history;
+
+    /// See getRevision()
+    unsigned m_revision{0};
 };
 
 #endif
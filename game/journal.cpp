@@ -0,0 +1,452 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <typeinfo>
+#include <cstring>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#ifdef HAVE_UNISTD_H
+#   include <unistd.h>
+#endif
+
+#include "journal.h"
+#include "bin_format.h"
+#include "bin_writer.h"
+#include "bin_reader.h"
+#include "game.h"
+#include "player.h"
+#include "turn.h"
+#include "command.h"
+#include "game_exception.h"
+#include "encoding.h"
+#include "debug.h"
+
+
+using namespace std;
+
+INIT_LOGGER(game, Journal);
+
+
+template<typename T>
+static void put(string &ioData, T iValue)
+{
+    ioData.append(reinterpret_cast<const char *>(&iValue), sizeof(iValue));
+}
+
+
+Journal::Journal(Game &ioGame, const string &iFileName)
+    : m_game(ioGame), m_fileName(iFileName)
+{
+    m_file = fopen(iFileName.c_str(), "wb");
+    if (m_file == nullptr)
+        throw SaveGameException(_fmt(_("Cannot open file for writing: '{0}'"), iFileName));
+
+    const Navigation &navigation = m_game.getNavigation();
+    unsigned nbCommands = 0;
+    for (const Turn *turn : navigation.getTurns())
+    {
+        for (const Command *cmd : turn->getCommands())
+            nbCommands += BinWriter::IsSaved(*cmd);
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMAGIC, sizeof(kMAGIC));
+    header.version = kVERSION;
+    header.byteOrder = BinFormat::kBYTE_ORDER;
+    header.nbTurns = navigation.getNbTurns();
+    header.nbCommands = nbCommands;
+    if (fwrite(&header, sizeof(header), 1, m_file) != 1 || fflush(m_file) != 0)
+    {
+        fclose(m_file);
+        throw SaveGameException(_fmt(_("Cannot write file '{0}'"), iFileName));
+    }
+    m_size = sizeof(header);
+    // Make sure the header is on the disk
+    m_nbUnsynced = 1;
+    sync();
+
+    m_game.accessNavigation().setObserver(this);
+    LOG_INFO("Journal {} started ({} turns, {} commands)",
+             iFileName, header.nbTurns, header.nbCommands);
+}
+
+
+Journal::~Journal()
+{
+    m_game.accessNavigation().setObserver(nullptr);
+    sync();
+    if (m_file != nullptr)
+        fclose(m_file);
+}
+
+
+void Journal::sync()
+{
+    if (m_file == nullptr || m_nbUnsynced == 0)
+        return;
+#ifdef HAVE_UNISTD_H
+    if (fsync(fileno(m_file)) != 0)
+        LOG_WARN("Cannot synchronize the journal {}", m_fileName);
+#endif
+    m_nbUnsynced = 0;
+}
+
+
+uint32_t Journal::Checksum(const string &iData)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : iData)
+    {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+void Journal::append(const string &iData)
+{
+    if (m_failed)
+        return;
+
+    string entry;
+    put<uint32_t>(entry, iData.size());
+    entry += iData;
+    put<uint32_t>(entry, Checksum(iData));
+    if (fwrite(entry.data(), entry.size(), 1, m_file) != 1 || fflush(m_file) != 0)
+    {
+        LOG_ERROR("Cannot write to the journal {}, the next modifications are lost",
+                  m_fileName);
+        m_failed = true;
+        fclose(m_file);
+        m_file = nullptr;
+        return;
+    }
+    m_size += entry.size();
+    ++m_nbEntries;
+    if (++m_nbUnsynced >= kSyncInterval)
+        sync();
+}
+
+
+bool Journal::isSaved(unsigned int iTurn, unsigned int iIndex) const
+{
+    const Turn &turn = *m_game.getNavigation().getTurns()[iTurn];
+    return BinWriter::IsSaved(*turn.getCommands()[iIndex]);
+}
+
+
+unsigned Journal::getSavedIndex(unsigned int iTurn, unsigned int iIndex) const
+{
+    const Turn &turn = *m_game.getNavigation().getTurns()[iTurn];
+    unsigned index = 0;
+    for (unsigned i = 0; i < iIndex; ++i)
+        index += BinWriter::IsSaved(*turn.getCommands()[i]);
+    return index;
+}
+
+
+void Journal::putRecord(string &ioData, unsigned int iTurn, unsigned int iIndex) const
+{
+    const Turn &turn = *m_game.getNavigation().getTurns()[iTurn];
+    BinWriter::putCommand(ioData, *turn.getCommands()[iIndex]);
+}
+
+
+void Journal::turnAdded()
+{
+    string data;
+    put<uint8_t>(data, kNEW_TURN);
+    append(data);
+}
+
+
+void Journal::commandAdded(unsigned int iTurn, unsigned int iIndex)
+{
+    if (!isSaved(iTurn, iIndex))
+        return;
+    string data;
+    put<uint8_t>(data, kADD);
+    putRecord(data, iTurn, iIndex);
+    append(data);
+}
+
+
+void Journal::commandInserted(unsigned int iTurn, unsigned int iIndex)
+{
+    if (!isSaved(iTurn, iIndex))
+        return;
+    string data;
+    put<uint8_t>(data, kINSERT);
+    put<uint32_t>(data, iTurn);
+    putRecord(data, iTurn, iIndex);
+    append(data);
+}
+
+
+void Journal::commandReplaced(unsigned int iTurn, unsigned int iIndex)
+{
+    if (!isSaved(iTurn, iIndex))
+        return;
+    string data;
+    put<uint8_t>(data, kREPLACE);
+    put<uint32_t>(data, iTurn);
+    put<uint32_t>(data, getSavedIndex(iTurn, iIndex));
+    putRecord(data, iTurn, iIndex);
+    append(data);
+}
+
+
+void Journal::commandDropped(unsigned int iTurn, unsigned int iIndex)
+{
+    if (!isSaved(iTurn, iIndex))
+        return;
+    string data;
+    put<uint8_t>(data, kDROP);
+    put<uint32_t>(data, iTurn);
+    put<uint32_t>(data, getSavedIndex(iTurn, iIndex));
+    append(data);
+}
+
+
+void Journal::commandsDroppedFrom(unsigned int iTurn, unsigned int iIndex)
+{
+    string data;
+    put<uint8_t>(data, kDROP_FROM);
+    put<uint32_t>(data, getSavedIndex(iTurn, iIndex));
+    append(data);
+}
+
+
+void Journal::futureCleared(unsigned int iTurn)
+{
+    string data;
+    put<uint8_t>(data, kCLEAR_FUTURE);
+    put<uint32_t>(data, iTurn);
+    append(data);
+}
+
+
+unsigned Journal::Replay(Game &ioGame, const string &iFileName)
+{
+    LOG_INFO("Replaying journal '{}'", iFileName);
+    ifstream file(iFileName.c_str(), ios::in | ios::binary);
+    if (!file.is_open())
+        throw LoadGameException(_fmt(_("Cannot open file '{0}'"), iFileName));
+    const string contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    auto fail = [&]() {
+        return LoadGameException(_fmt(_("Invalid journal: '{0}'"), iFileName));
+    };
+
+    // Check that the journal was started on this game.
+    // A journal which cannot be applied leaves the game unchanged
+    Navigation &navigation = ioGame.accessNavigation();
+    FileHeader header;
+    if (contents.size() < sizeof(header))
+    {
+        LOG_ERROR("Journal {}: truncated header, ignoring the journal", iFileName);
+        return 0;
+    }
+    memcpy(&header, contents.data(), sizeof(header));
+    if (memcmp(header.magic, kMAGIC, sizeof(kMAGIC)) != 0 ||
+        header.version != kVERSION || header.byteOrder != BinFormat::kBYTE_ORDER)
+    {
+        LOG_ERROR("Journal {}: incompatible format, ignoring the journal", iFileName);
+        return 0;
+    }
+    unsigned nbCommands = 0;
+    for (const Turn *turn : navigation.getTurns())
+    {
+        for (const Command *cmd : turn->getCommands())
+            nbCommands += BinWriter::IsSaved(*cmd);
+    }
+    // The saved games do not contain the last turn if it is empty
+    const bool addLastTurn = header.nbTurns == navigation.getNbTurns() + 1;
+    if (header.nbTurns != navigation.getNbTurns() + addLastTurn ||
+        header.nbCommands != nbCommands)
+    {
+        LOG_ERROR("Journal {}: it does not correspond to the saved game "
+                  "({} turns and {} commands, instead of {} and {}), ignoring the journal",
+                  iFileName, header.nbTurns, header.nbCommands,
+                  navigation.getNbTurns(), nbCommands);
+        return 0;
+    }
+    if (addLastTurn)
+        navigation.newTurn();
+
+    map<unsigned int, Player*> players;
+    for (unsigned i = 0; i < ioGame.getNPlayers(); ++i)
+        players[ioGame.getPlayer(i).getId()] = &ioGame.accessPlayer(i);
+
+    // Apply one entry. An invalid entry is detected before modifying the game
+    auto replayEntry = [&](const string &data) {
+        size_t dataPos = 1;
+        auto getIndex = [&]() {
+            uint32_t value;
+            if (data.size() < dataPos + sizeof(value))
+                throw fail();
+            memcpy(&value, data.data() + dataPos, sizeof(value));
+            dataPos += sizeof(value);
+            return value;
+        };
+        auto getCommand = [&]() {
+            const BinReader::Record &record =
+                BinReader::DecodeRecord(data.substr(dataPos), ioGame.getDic(), iFileName);
+            return unique_ptr<Command>(BinReader::CreateCommand(ioGame, players, record));
+        };
+        // Go to the given turn, to modify it
+        auto goToTurn = [&](unsigned iTurn) -> const vector<Command *> & {
+            if (iTurn >= navigation.getNbTurns())
+                throw fail();
+            if (iTurn + 1 == navigation.getNbTurns())
+                navigation.lastTurn();
+            else
+                navigation.goToTurn(iTurn);
+            return navigation.getCurrentTurn().getCommands();
+        };
+
+        if (data.empty())
+            throw fail();
+        const auto op = static_cast<Operation>(data[0]);
+        if (op == kNEW_TURN)
+            navigation.newTurn();
+        else if (op == kADD)
+        {
+            unique_ptr<Command> cmd(getCommand());
+            navigation.lastTurn();
+            navigation.addAndExecute(cmd.release());
+        }
+        else if (op == kINSERT)
+        {
+            const unsigned turn = getIndex();
+            unique_ptr<Command> cmd(getCommand());
+            if (!cmd->isInsertable() || !cmd->isAutoExecutable())
+                throw fail();
+            goToTurn(turn);
+            navigation.insertCommand(cmd.release());
+        }
+        else if (op == kREPLACE)
+        {
+            const unsigned turn = getIndex();
+            const unsigned index = getIndex();
+            const vector<Command *> &commands = goToTurn(turn);
+            unique_ptr<Command> cmd(getCommand());
+            if (index >= commands.size() ||
+                typeid(*commands[index]) != typeid(*cmd))
+            {
+                throw fail();
+            }
+            navigation.replaceCommand(*commands[index], cmd.release());
+        }
+        else if (op == kDROP)
+        {
+            const unsigned turn = getIndex();
+            const unsigned index = getIndex();
+            const vector<Command *> &commands = goToTurn(turn);
+            if (index >= commands.size() ||
+                !commands[index]->isInsertable() || !commands[index]->isAutoExecutable())
+            {
+                throw fail();
+            }
+            navigation.dropCommand(*commands[index]);
+        }
+        else if (op == kDROP_FROM)
+        {
+            const unsigned index = getIndex();
+            navigation.lastTurn();
+            const vector<Command *> &commands = navigation.getCurrentTurn().getCommands();
+            if (index > commands.size())
+                throw fail();
+            if (index < commands.size())
+                navigation.dropFrom(*commands[index]);
+        }
+        else if (op == kCLEAR_FUTURE)
+        {
+            const unsigned turn = getIndex();
+            goToTurn(turn);
+            // The future of the last turn is made of its non executed commands
+            const Turn &currTurn = navigation.getCurrentTurn();
+            if (turn + 1 == navigation.getNbTurns() &&
+                currTurn.isFullyExecuted() && currTurn.hasNonAutoExecCmd())
+            {
+                navigation.prevTurn();
+            }
+            navigation.clearFuture();
+        }
+        else
+            throw fail();
+    };
+
+    unsigned nbEntries = 0;
+    size_t pos = sizeof(header);
+    while (pos < contents.size())
+    {
+        // Stop at the first incomplete or corrupted entry: it can only be
+        // the last one, which was being written when the game was interrupted
+        uint32_t size;
+        uint32_t checksum;
+        if (contents.size() - pos < sizeof(size))
+            break;
+        memcpy(&size, contents.data() + pos, sizeof(size));
+        if ((contents.size() - pos - sizeof(size)) < size + sizeof(checksum))
+            break;
+        const string data = contents.substr(pos + sizeof(size), size);
+        memcpy(&checksum, contents.data() + pos + sizeof(size) + size, sizeof(checksum));
+        if (checksum != Checksum(data))
+            break;
+
+        // Stop at the first entry which cannot be applied as well: the
+        // following ones depend on it
+        try
+        {
+            replayEntry(data);
+        }
+        catch (const GameException &e)
+        {
+            LOG_ERROR("Journal {}: cannot apply entry {} ({})", iFileName, nbEntries, e.what());
+            break;
+        }
+        pos += sizeof(size) + size + sizeof(checksum);
+        ++nbEntries;
+    }
+    if (pos < contents.size())
+    {
+        LOG_WARN("Journal {}: ignoring {} bytes after entry {}",
+                 iFileName, contents.size() - pos, nbEntries);
+    }
+
+    navigation.lastTurn();
+    LOG_INFO("Journal replayed ({} entries)", nbEntries);
+    return nbEntries;
+}
+
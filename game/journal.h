@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include <string>
+#include <cstdio>
+#include <stdint.h>
+
+#include "logging.h"
+#include "navigation.h"
+
+class Game;
+
+using std::string;
+
+
+/**
+ * Append-only journal of the modifications of a game, allowing to recover
+ * the game after a crash without saving it completely after each action.
+ *
+ * The journal is started just after a full save of the game (the "base"
+ * save, in any format). Each modification of the commands done through
+ * the Navigation object is then appended to the file as a small entry,
+ * so the cost of saving does not depend on the size of the game anymore.
+ * Each entry is given to the system as soon as it is written (so it
+ * survives a crash of the application), but to limit the cost of the
+ * synchronization, the file is only flushed to the disk every
+ * kSyncInterval entries (and when calling sync()).
+ * The navigation in the history is not recorded.
+ *
+ * The file is made of a header, followed by the entries. Each entry is
+ * made of its size (u32), the data, and a checksum of the data (u32, FNV-1a).
+ * The data starts with the operation (u8, see Operation), followed by:
+ *  - for kINSERT: the turn (u32) and the record of the command;
+ *  - for kREPLACE: the turn (u32), the index (u32) and the new record;
+ *  - for kDROP: the turn (u32) and the index (u32);
+ *  - for kDROP_FROM: the index (u32), in the last turn;
+ *  - for kCLEAR_FUTURE: the turn (u32);
+ *  - for kADD: the record of the command, added to the last turn.
+ * The records are encoded like in the binary save format (see BinFormat),
+ * and the indices of the commands only count the saved commands.
+ *
+ * Replay() applies the entries to the loaded base save. An entry which was
+ * not completely written (because of a crash), or which is invalid, ends
+ * the replay.
+ */
+class Journal: public NavigationObserver
+{
+    DEFINE_LOGGER();
+public:
+    /**
+     * Create the journal (replacing any existing file), and start
+     * recording the modifications of the given game, which must have been
+     * saved just before. The game must outlive the journal.
+     * A SaveGameException is thrown if the file cannot be created.
+     */
+    Journal(Game &ioGame, const string &iFileName);
+
+    /// Synchronize the file, and stop recording the modifications
+    ~Journal() override;
+
+    Journal(const Journal &) = delete;
+    Journal & operator=(const Journal &) = delete;
+
+    /// Number of entries written between two synchronizations of the file
+    static const unsigned kSyncInterval = 16;
+
+    /// Write the pending entries to the disk
+    void sync();
+
+    const string & getFileName() const { return m_fileName; }
+    unsigned getNbEntries() const { return m_nbEntries; }
+    /// Size of the file, in bytes
+    size_t getSize() const { return m_size; }
+
+    /**
+     * Return true if an entry could not be written. The following
+     * modifications are not recorded anymore, so the game should be
+     * saved completely (and a new journal started).
+     */
+    bool hasFailed() const { return m_failed; }
+
+    /**
+     * Apply the entries of the given journal to the given game, which must
+     * be the base save of the journal, freshly loaded. The current turn is
+     * the last one at the end. Return the number of applied entries.
+     * The replay stops at the first entry which is incomplete or cannot be
+     * applied (and nothing is applied if the journal does not correspond
+     * to the game): the game then contains the entries applied so far.
+     * A LoadGameException is thrown if the file cannot be read.
+     */
+    static unsigned Replay(Game &ioGame, const string &iFileName);
+
+    // NavigationObserver interface
+    void turnAdded() override;
+    void commandAdded(unsigned int iTurn, unsigned int iIndex) override;
+    void commandInserted(unsigned int iTurn, unsigned int iIndex) override;
+    void commandReplaced(unsigned int iTurn, unsigned int iIndex) override;
+    void commandDropped(unsigned int iTurn, unsigned int iIndex) override;
+    void commandsDroppedFrom(unsigned int iTurn, unsigned int iIndex) override;
+    void futureCleared(unsigned int iTurn) override;
+
+private:
+    static constexpr char kMAGIC[8] = {'E', 'L', 'I', 'O', 'T', 'J', 'L', '\0'};
+    static const uint32_t kVERSION = 1;
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        /// Number of turns of the game when the journal was started
+        uint32_t nbTurns;
+        /// Number of saved commands of the game when the journal was started
+        uint32_t nbCommands;
+    };
+
+    enum Operation: uint8_t
+    {
+        kNEW_TURN = 0,
+        kADD = 1,
+        kINSERT = 2,
+        kREPLACE = 3,
+        kDROP = 4,
+        kDROP_FROM = 5,
+        kCLEAR_FUTURE = 6
+    };
+
+    Game &m_game;
+    string m_fileName;
+    FILE *m_file{nullptr};
+    unsigned m_nbEntries{0};
+    unsigned m_nbUnsynced{0};
+    size_t m_size{0};
+    bool m_failed{false};
+
+    /// Number of saved commands of the given turn before the given index
+    unsigned getSavedIndex(unsigned int iTurn, unsigned int iIndex) const;
+
+    /// Return true if the command at the given position is saved
+    bool isSaved(unsigned int iTurn, unsigned int iIndex) const;
+
+    /// Append the record of the command at the given position to ioData
+    void putRecord(string &ioData, unsigned int iTurn, unsigned int iIndex) const;
+
+    /// Append an entry with the given data to the file
+    void append(const string &iData);
+
+    static uint32_t Checksum(const string &iData);
+};
+
+#endif
+
@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include <fstream>
+#include <cstring>
+
+#ifdef HAVE_SYS_MMAN_H
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+#include "leave_table.h"
+#include "dic.h"
+#include "header.h"
+#include "rack.h"
+#include "random.h"
+#include "encoding.h"
+#include "game_exception.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, LeaveTable);
+
+static const char kMAGIC[8] = {'E', 'L', 'I', 'O', 'T', 'L', 'V', '\0'};
+static const uint32_t kVERSION = 1;
+static const uint32_t kBYTE_ORDER = 0x01020304;
+
+
+LeaveTable::LeaveTable(const string &iFileName, const Dictionary &iDic)
+    : m_fileName(iFileName)
+{
+#ifdef HAVE_SYS_MMAN_H
+    int fd = open(iFileName.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                m_mapping = addr;
+                m_mappingSize = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    if (m_mapping != nullptr)
+    {
+        try
+        {
+            init(static_cast<const char *>(m_mapping), m_mappingSize, iDic);
+        }
+        catch (...)
+        {
+            munmap(m_mapping, m_mappingSize);
+            throw;
+        }
+        return;
+    }
+#endif
+
+    // Read the whole file instead
+    ifstream file(iFileName.c_str(), ios::in | ios::binary | ios::ate);
+    if (!file.is_open())
+        throw GameException(_fmt(_("Cannot open file '{0}'"), iFileName));
+    const size_t size = file.tellg();
+    m_buffer.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(m_buffer.data()), size))
+        throw GameException(_fmt(_("Cannot read file '{0}'"), iFileName));
+    init(reinterpret_cast<const char *>(m_buffer.data()), size, iDic);
+}
+
+
+LeaveTable::~LeaveTable()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (m_mapping != nullptr)
+        munmap(m_mapping, m_mappingSize);
+#endif
+}
+
+
+void LeaveTable::init(const char *iData, size_t iSize, const Dictionary &iDic)
+{
+    FileHeader header;
+    if (iSize < sizeof(header))
+        throw GameException(_fmt(_("Invalid leave table: '{0}'"), m_fileName));
+    memcpy(&header, iData, sizeof(header));
+
+    if (memcmp(header.magic, kMAGIC, sizeof(kMAGIC)) != 0 ||
+        header.version != kVERSION || header.byteOrder != kBYTE_ORDER ||
+        header.nbBuckets == 0 || (header.nbBuckets & (header.nbBuckets - 1)) != 0 ||
+        header.nbLeaves >= header.nbBuckets ||
+        iSize < sizeof(header) + header.nbBuckets * sizeof(Entry))
+    {
+        throw GameException(_fmt(_("Invalid leave table: '{0}'"), m_fileName));
+    }
+    if (header.lettersHash != GetLettersHash(iDic))
+    {
+        throw GameException(_fmt(_("The leave table '{0}' was not generated "
+                                   "for this dictionary"), m_fileName));
+    }
+
+    m_entries = reinterpret_cast<const Entry *>(iData + sizeof(header));
+    m_mask = header.nbBuckets - 1;
+    m_nbLeaves = header.nbLeaves;
+    LOG_INFO("Loaded leave table {} ({} leaves)", m_fileName, m_nbLeaves);
+}
+
+
+uint64_t LeaveTable::MakeKey(const Rack &iRack)
+{
+    // The tiles are sorted by code
+    vector<Tile> tiles;
+    iRack.getTiles(tiles);
+    uint64_t key = kEMPTY_LEAVE;
+    for (const Tile &tile : tiles)
+        key = AddToKey(key, tile.toCode());
+    return key;
+}
+
+
+float LeaveTable::getValue(uint64_t iKey) const
+{
+    // A valid table always has an unused bucket, but a corrupted file
+    // must not make the lookup loop forever
+    uint64_t bucket = GetBucket(iKey, m_mask);
+    for (uint64_t probe = 0; probe <= m_mask; ++probe, bucket = (bucket + 1) & m_mask)
+    {
+        const Entry &entry = m_entries[bucket];
+        if (entry.key == iKey)
+            return entry.value;
+        if (entry.key == kUNUSED_KEY)
+            return 0;
+    }
+    return 0;
+}
+
+
+void LeaveTable::Save(const string &iFileName, const Dictionary &iDic,
+                      const map<uint64_t, float> &iValues)
+{
+    // Keep the load factor below 1/2, so that there is always an unused
+    // bucket to stop the lookups
+    uint32_t nbBuckets = 1;
+    while (nbBuckets < 2 * iValues.size() + 1)
+        nbBuckets *= 2;
+
+    vector<Entry> entries(nbBuckets, Entry{kUNUSED_KEY, 0, 0});
+    for (const auto &[key, value] : iValues)
+    {
+        ASSERT(key != kUNUSED_KEY, "Invalid leave key");
+        uint64_t bucket = GetBucket(key, nbBuckets - 1);
+        while (entries[bucket].key != kUNUSED_KEY)
+            bucket = (bucket + 1) & (nbBuckets - 1);
+        entries[bucket] = Entry{key, value, 0};
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMAGIC, sizeof(kMAGIC));
+    header.version = kVERSION;
+    header.byteOrder = kBYTE_ORDER;
+    header.lettersHash = GetLettersHash(iDic);
+    header.nbBuckets = nbBuckets;
+    header.nbLeaves = iValues.size();
+
+    ofstream file(iFileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!file.is_open())
+        throw GameException(_fmt(_("Cannot write file '{0}'"), iFileName));
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()),
+               entries.size() * sizeof(Entry));
+    if (!file)
+        throw GameException(_fmt(_("Cannot write file '{0}'"), iFileName));
+}
+
+
+uint64_t LeaveTable::GetLettersHash(const Dictionary &iDic)
+{
+    // FNV-1a hash of the letters, which define the codes of the tiles
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (wchar_t chr : iDic.getHeader().getLetters())
+    {
+        hash ^= (uint64_t)chr;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+uint64_t LeaveTable::GetBucket(uint64_t iKey, uint64_t iMask)
+{
+    // Spread the keys, which only differ by a few bits
+    return Random::mixBits(iKey) & iMask;
+}
+
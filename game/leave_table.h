@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef LEAVE_TABLE_H_
+#define LEAVE_TABLE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+#include "logging.h"
+
+using namespace std;
+
+class Dictionary;
+class Rack;
+
+
+/**
+ * Table giving the value, in points, of the tiles left on the rack after
+ * a move (the "leave"). A positive value means that the leave is expected
+ * to help during the next turn, a negative one that it is a burden.
+ *
+ * The table is generated offline by the eliotleaves tool, from self-play
+ * statistics, and saved in a binary file valid for the letters of a given
+ * dictionary. The file contains an open-addressing hash table, which is
+ * mapped in memory as is, so loading a table costs almost nothing and
+ * a lookup is usually a single probe.
+ *
+ * A leave is identified by a key built from the codes of its tiles, added
+ * in increasing order (see AddToKey()). Unknown leaves have a value of 0.
+ */
+class LeaveTable
+{
+    DEFINE_LOGGER();
+public:
+    /**
+     * Load the table from the given file.
+     * A GameException is thrown if the file cannot be read, or if it was
+     * not generated for the letters of the given dictionary.
+     */
+    LeaveTable(const string &iFileName, const Dictionary &iDic);
+    ~LeaveTable();
+
+    LeaveTable(const LeaveTable &) = delete;
+    LeaveTable & operator=(const LeaveTable &) = delete;
+
+    const string & getFileName() const { return m_fileName; }
+
+    /// Number of leaves in the table
+    unsigned getNbLeaves() const { return m_nbLeaves; }
+
+    /// Key of the empty leave
+    static const uint64_t kEMPTY_LEAVE = 0;
+
+    /**
+     * Add a tile, given by its code, to the key of a leave.
+     * The codes must be added by increasing order.
+     */
+    static uint64_t AddToKey(uint64_t iKey, unsigned iCode) { return iKey << 6 | iCode; }
+
+    /// Return the key of the leave made of the tiles of the given rack
+    static uint64_t MakeKey(const Rack &iRack);
+
+    /// Return the value of the leave with the given key (0 if it is unknown)
+    float getValue(uint64_t iKey) const;
+
+    /// Return the value of the leave made of the tiles of the given rack
+    float getValue(const Rack &iRack) const { return getValue(MakeKey(iRack)); }
+
+    /**
+     * Save a table containing the given values (indexed by leave keys),
+     * for the letters of the given dictionary.
+     * A GameException is thrown if the file cannot be written.
+     */
+    static void Save(const string &iFileName, const Dictionary &iDic,
+                     const map<uint64_t, float> &iValues);
+
+private:
+    /// Header of the file
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        /// Used to detect files written on a machine with another endianness
+        uint32_t byteOrder;
+        /// Hash of the letters of the dictionary
+        uint64_t lettersHash;
+        /// Number of buckets (a power of 2)
+        uint32_t nbBuckets;
+        uint32_t nbLeaves;
+    };
+
+    /// Bucket of the hash table, following the header in the file
+    struct Entry
+    {
+        uint64_t key;
+        float value;
+        uint32_t reserved;
+    };
+
+    /// Key of the empty buckets (no leave has this key)
+    static const uint64_t kUNUSED_KEY = ~(uint64_t)0;
+
+    string m_fileName;
+
+    /// Mapping of the file (nullptr when the file has been read instead)
+    void *m_mapping{nullptr};
+    size_t m_mappingSize{0};
+    /// Contents of the file, when it could not be mapped
+    vector<uint64_t> m_buffer;
+
+    const Entry *m_entries{nullptr};
+    uint64_t m_mask{0};
+    unsigned m_nbLeaves{0};
+
+    /// Check the contents of the file, and initialize the table
+    void init(const char *iData, size_t iSize, const Dictionary &iDic);
+
+    static uint64_t GetLettersHash(const Dictionary &iDic);
+    static uint64_t GetBucket(uint64_t iKey, uint64_t iMask);
+};
+
+#endif
+
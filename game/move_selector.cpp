@@ -19,12 +19,18 @@
  *****************************************************************************/
 
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
 #include "move_selector.h"
 #include "round.h"
 #include "results.h"
 #include "board.h"
 #include "board_layout.h"
 #include "rack.h"
+#include "leave_table.h"
+#include "settings.h"
 
 #include "dic.h"
 #include "debug.h"
@@ -42,9 +48,43 @@ INIT_LOGGER(game, MoveSelector);
 
 
 MoveSelector::MoveSelector(const Dictionary &iDic,
-                           const Board &iBoard, const Rack &iRack)
-    : m_dic(iDic), m_board(iBoard), m_rack(iRack)
+                           const Board &iBoard, const Rack &iRack,
+                           const LeaveTable *iLeaves)
+    : m_dic(iDic), m_board(iBoard), m_rack(iRack), m_leaves(iLeaves),
+    m_evalExtensions(Settings::Instance().getBool("duplicate.master-heuristics"))
 {
+    // The tiles are sorted by code
+    vector<Tile> tiles;
+    m_rack.getTiles(tiles);
+    ASSERT(tiles.size() <= kMAX_LEAVE, "Rack too big");
+    for (const Tile &tile : tiles)
+        m_rackCodes.push_back(tile.toCode());
+
+    if (!m_evalExtensions)
+        return;
+
+    // Count the tiles of the board, to find the letters still available
+    vector<unsigned> onBoard(m_dic.getTileNumber() + 1, 0);
+    for (int row = BOARD_MIN; row <= BOARD_MAX; ++row)
+    {
+        for (int col = BOARD_MIN; col <= BOARD_MAX; ++col)
+        {
+            if (m_board.isVacant(row, col))
+                continue;
+            const Tile &tile = m_board.isJoker(row, col) ?
+                Tile::Joker() : m_board.getTile(row, col);
+            ++onBoard[tile.toCode()];
+        }
+    }
+    const bool jokerAvailable =
+        onBoard[Tile::Joker().toCode()] < Tile::Joker().maxNumber();
+    for (const Tile &tile : m_dic.getAllTiles())
+    {
+        if (tile.isJoker())
+            continue;
+        if (jokerAvailable || onBoard[tile.toCode()] < tile.maxNumber())
+            m_availableLetters |= (uint64_t)1 << tile.toCode();
+    }
 }
 
 
@@ -74,17 +114,72 @@ Round MoveSelector::selectMaster(const BestResults &iResults) const
 }
 
 
+Round MoveSelector::selectBest(const Results &iResults) const
+{
+    ASSERT(!iResults.isEmpty(), "Nothing to select from");
+    ASSERT(m_leaves != nullptr, "No leave table");
+
+    int bestIndex = 0;
+    float bestValue = iResults.getPoints(0) + m_leaves->getValue(getLeaveKey(iResults.get(0)));
+    for (unsigned num = 1; num < iResults.size(); ++num)
+    {
+        const Round &round = iResults.get(num);
+        const float value = iResults.getPoints(num) + m_leaves->getValue(getLeaveKey(round));
+        if (bestValue < value)
+        {
+            bestValue = value;
+            bestIndex = num;
+        }
+    }
+
+    return iResults.get(bestIndex);
+}
+
+
+unsigned MoveSelector::getLeave(const Round &iRound, unsigned *oCodes) const
+{
+    unsigned nb = m_rackCodes.size();
+    std::copy(m_rackCodes.begin(), m_rackCodes.end(), oCodes);
+
+    // Remove the played tiles, keeping the other codes sorted
+    for (unsigned i = 0; i < iRound.getWordLen(); ++i)
+    {
+        if (!iRound.isPlayedFromRack(i))
+            continue;
+        const unsigned code = iRound.isJoker(i) ?
+            Tile::Joker().toCode() : iRound.getTile(i).toCode();
+        unsigned *pos = std::find(oCodes, oCodes + nb, code);
+        ASSERT(pos != oCodes + nb, "The rack does not contain the played tiles");
+        std::copy(pos + 1, oCodes + nb, pos);
+        --nb;
+    }
+    return nb;
+}
+
+
+uint64_t MoveSelector::getLeaveKey(const Round &iRound) const
+{
+    unsigned codes[kMAX_LEAVE];
+    const unsigned nb = getLeave(iRound, codes);
+    uint64_t key = LeaveTable::kEMPTY_LEAVE;
+    for (unsigned i = 0; i < nb; ++i)
+        key = LeaveTable::AddToKey(key, codes[i]);
+    return key;
+}
+
+
 int MoveSelector::evalScore(const Round &iRound) const
 {
     int score = 0;
     score += evalForJokersInRack(iRound);
     score += evalForRemainingLetters(iRound);
-    // Deactivated for now, as it breaks a few non-regression tests,
-    // and I don't have time to fix them at the moment... :)
-#if 0
-    score += evalForExtensions(iRound);
-    score += evalForBenjamins(iRound);
-#endif
+    // Deactivated by default, as it changes the results of a few
+    // non-regression tests
+    if (m_evalExtensions)
+    {
+        score += evalForExtensions(iRound);
+        score += evalForBenjamins(iRound);
+    }
     // TODO: add more heuristics
     return score;
 }
@@ -98,23 +193,25 @@ int MoveSelector::evalForJokersInRack(const Round &iRound) const
 
 int MoveSelector::evalForRemainingLetters(const Round &iRound) const
 {
-    // Compute the rack remaining after playing the round
-    Rack remaining = m_rack;
-    for (unsigned i = 0; i < iRound.getWordLen(); ++i)
-    {
-        if (iRound.isPlayedFromRack(i))
-        {
-            remaining.remove(iRound.isJoker(i) ? Tile::Joker() : iRound.getTile(i));
-        }
-    }
+    if (m_leaves != nullptr)
+        return lrintf(m_leaves->getValue(getLeaveKey(iRound)));
+
+    // Compute the tiles remaining after playing the round
+    unsigned codes[kMAX_LEAVE];
+    const unsigned nb = getLeave(iRound, codes);
 
     // If a letter is present at least 3 times in the rack, consider it bad
     // Note: the repetitions are only relevant if the rack is not rejected for
     // lack of vowels and/or consonants...
     int score = 0;
-    for (const Tile &t : m_dic.getAllTiles())
+    for (unsigned i = 0; i < nb; )
     {
-        const int count = remaining.count(t);
+        // The identical tiles are consecutive
+        unsigned next = i + 1;
+        while (next < nb && codes[next] == codes[i])
+            ++next;
+        const int count = next - i;
+        i = next;
         if (count >= 3)
         {
             if (count == 3)
@@ -132,72 +229,139 @@ int MoveSelector::evalForRemainingLetters(const Round &iRound) const
 }
 
 
+wstring MoveSelector::GetInternalWord(const Round &iRound)
+{
+    wstring word;
+    for (unsigned i = 0; i < iRound.getWordLen(); ++i)
+        word += iRound.getTile(i).toUpper().toChar();
+    return word;
+}
+
+
+uint64_t MoveSelector::getPlayableLetters(int iRow, int iCol, Coord::Direction iDir) const
+{
+    if (!m_board.getLayout().isValidCoord(iRow, iCol) || !m_board.isVacant(iRow, iCol))
+        return 0;
+
+    const Cross &cross = m_board.getCross(iRow, iCol, iDir);
+    if (cross.isAny())
+        return m_availableLetters;
+    uint64_t letters = 0;
+    for (const Tile &tile : m_dic.getAllTiles())
+    {
+        const uint64_t bit = (uint64_t)1 << tile.toCode();
+        if ((m_availableLetters & bit) && cross.check(tile))
+            letters |= bit;
+    }
+    return letters;
+}
+
+
 int MoveSelector::evalForExtensions(const Round &iRound) const
 {
-    // Find front and back extensions to the given round
-    const wstring &roundWord = iRound.getWord();
-    vector<wdstring> results;
-    m_dic.searchRacc(roundWord, results);
+    // Find the letters which can be added in front of and after the word
+    const wstring &word = GetInternalWord(iRound);
+    auto it = m_hooksCache.find(word);
+    if (it == m_hooksCache.end())
+    {
+        Hooks hooks;
+        m_dic.searchHooks(word, hooks.front, hooks.back);
+        it = m_hooksCache.emplace(word, hooks).first;
+    }
+    const Hooks &hooks = it->second;
+
+    // Only keep the letters still available, and allowed by the cross checks
+    // of the squares before and after the word. The square after the
+    // extension must be vacant, otherwise another word would be formed.
+    const Coord &coord = iRound.getCoord();
+    const Coord::Direction dir = coord.getDir();
+    const int dRow = dir == Coord::VERTICAL ? 1 : 0;
+    const int dCol = dir == Coord::HORIZONTAL ? 1 : 0;
+    const int len = iRound.getWordLen();
+    const int row = coord.getRow();
+    const int col = coord.getCol();
+    int nbExtensions = 0;
+    if (isVacantOrOutside(row - 2 * dRow, col - 2 * dCol))
+    {
+        nbExtensions += std::popcount(hooks.front &
+                                      getPlayableLetters(row - dRow, col - dCol, dir));
+    }
+    if (isVacantOrOutside(row + (len + 1) * dRow, col + (len + 1) * dCol))
+    {
+        nbExtensions += std::popcount(hooks.back &
+                                      getPlayableLetters(row + len * dRow, col + len * dCol, dir));
+    }
 
     // Give a bonus for each extension
-    // TODO: it would be better to give a bonus only for extensions
-    // corresponding to letters still in the bag, and allowed by the
-    // cross-checks...
-    return results.size() * EXTENSION_1;
+    return nbExtensions * EXTENSION_1;
 }
 
 
 int MoveSelector::evalForBenjamins(const Round &iRound) const
 {
-    // Compute the word multiplier in case of benjamin
-    // TODO: this only depends on the coordinates, so it could easily be cached
-    int wordMult = 1;
     const Coord &coord = iRound.getCoord();
-    const unsigned row = coord.getRow();
-    const unsigned col = coord.getCol();
-    if (coord.getDir() == Coord::HORIZONTAL)
+    const Coord::Direction dir = coord.getDir();
+    const int dRow = dir == Coord::VERTICAL ? 1 : 0;
+    const int dCol = dir == Coord::HORIZONTAL ? 1 : 0;
+    const int row = coord.getRow();
+    const int col = coord.getCol();
+
+    // Make sure there is space for a benjamin on the board
+    if ((dir == Coord::HORIZONTAL ? col : row) <= 3 ||
+        !m_board.isVacant(row - dRow, col - dCol) ||
+        !m_board.isVacant(row - 2 * dRow, col - 2 * dCol) ||
+        !m_board.isVacant(row - 3 * dRow, col - 3 * dCol) ||
+        !isVacantOrOutside(row - 4 * dRow, col - 4 * dCol))
     {
-        // Make sure there is space for a benjamin on the board
-        if (col <= 3 ||
-            !m_board.isVacant(row, col - 1) ||
-            !m_board.isVacant(row, col - 2) ||
-            !m_board.isVacant(row, col - 3))
-        {
-            return 0;
-        }
+        return 0;
+    }
+
+    // Compute the word multiplier, which only depends on the coordinates
+    unsigned char &wordMult =
+        m_benjMultCache[(dir * BOARD_REALDIM + row) * BOARD_REALDIM + col];
+    if (wordMult == 0)
+    {
+        const BoardLayout &layout = m_board.getLayout();
+        wordMult = layout.getWordMultiplier(row - dRow, col - dCol) *
+                   layout.getWordMultiplier(row - 2 * dRow, col - 2 * dCol) *
+                   layout.getWordMultiplier(row - 3 * dRow, col - 3 * dCol);
+    }
 
-        // Compute the word multiplier
-        wordMult *= m_board.getLayout().getWordMultiplier(row, col - 1);
-        wordMult *= m_board.getLayout().getWordMultiplier(row, col - 2);
-        wordMult *= m_board.getLayout().getWordMultiplier(row, col - 3);
+    // Find the possible benjamins
+    const wstring &word = GetInternalWord(iRound);
+    auto it = m_benjCache.find(word);
+    if (it == m_benjCache.end())
+    {
+        vector<array<dic_code_t, 3>> prefixes;
+        m_dic.searchBenjCodes(word, prefixes);
+        it = m_benjCache.emplace(word, std::move(prefixes)).first;
     }
-    else
+
+    // Only keep the benjamins made of available letters, allowed by the
+    // cross checks of the 3 squares
+    const uint64_t letters[3] = {
+        getPlayableLetters(row - 3 * dRow, col - 3 * dCol, dir),
+        getPlayableLetters(row - 2 * dRow, col - 2 * dCol, dir),
+        getPlayableLetters(row - dRow, col - dCol, dir)
+    };
+    int nbBenjamins = 0;
+    for (const array<dic_code_t, 3> &prefix : it->second)
     {
-        // Same thing for vertical words
-        if (row <= 3 ||
-            !m_board.isVacant(row - 1, col) ||
-            !m_board.isVacant(row - 2, col) ||
-            !m_board.isVacant(row - 3, col))
+        if ((letters[0] >> prefix[0] & 1) &&
+            (letters[1] >> prefix[1] & 1) &&
+            (letters[2] >> prefix[2] & 1))
         {
-            return 0;
+            ++nbBenjamins;
         }
-
-        // Compute the word multiplier
-        wordMult *= m_board.getLayout().getWordMultiplier(row - 1, col);
-        wordMult *= m_board.getLayout().getWordMultiplier(row - 2, col);
-        wordMult *= m_board.getLayout().getWordMultiplier(row - 3, col);
     }
 
-    // Find possible benjamins
-    const wstring &roundWord = iRound.getWord();
-    vector<wdstring> results;
-    m_dic.searchBenj(roundWord, results);
-
-    // Give a bonus for each extension
-    // TODO: it would be better to give a bonus only for benjamins
-    // corresponding to letters still in the bag, and allowed by the
-    // cross-checks...
-    return results.size() * wordMult * BENJAMIN;
+    // Give a bonus for each benjamin
+    return nbBenjamins * wordMult * BENJAMIN;
 }
 
 
+bool MoveSelector::isVacantOrOutside(int iRow, int iCol) const
+{
+    return !m_board.getLayout().isValidCoord(iRow, iCol) || m_board.isVacant(iRow, iCol);
+}
+
@@ -21,13 +21,23 @@
 #ifndef MOVE_SELECTOR_H_
 #define MOVE_SELECTOR_H_
 
+#include <vector>
+#include <map>
+#include <array>
+#include <string>
+#include <stdint.h>
+
+#include "board_grid.h"
+#include "coord.h"
 #include "logging.h"
 
 class Round;
+class Results;
 class BestResults;
 class Dictionary;
 class Board;
 class Rack;
+class LeaveTable;
 
 
 /**
@@ -35,6 +45,14 @@ class Rack;
  * is the "best" for a given situation. At the moment, only one situation
  * is implemented, namely choosing an appropriate master move for duplicate
  * games.
+ *
+ * When a leave table is given, the value of the letters remaining on the
+ * rack is read from the table, instead of being estimated with a few
+ * simple rules.
+ *
+ * An object of this class is meant to be used for a single turn: the
+ * extensions and benjamins of the words are cached, as well as the word
+ * multipliers of the benjamin squares.
  */
 class MoveSelector
 {
@@ -42,7 +60,8 @@ class MoveSelector
 public:
 
     MoveSelector(const Dictionary &iDic,
-                 const Board &iBoard, const Rack &iRack);
+                 const Board &iBoard, const Rack &iRack,
+                 const LeaveTable *iLeaves = nullptr);
 
     /**
      * Return a move to be used as "master move" in a duplicate game.
@@ -57,10 +76,63 @@ public:
      */
     Round selectMaster(const BestResults &iResults) const;
 
+    /**
+     * Return the move maximizing the sum of its score and of the value
+     * of the letters remaining on the rack after playing it.
+     * In case of equality, the first move wins.
+     * A leave table must have been given to the constructor.
+     */
+    Round selectBest(const Results &iResults) const;
+
 private:
     const Dictionary &m_dic;
     const Board &m_board;
     const Rack &m_rack;
+    const LeaveTable *m_leaves;
+
+    /// Maximal number of tiles in a leave
+    static const unsigned kMAX_LEAVE = 10;
+
+    /// Codes of the tiles of the rack, in increasing order
+    std::vector<unsigned> m_rackCodes;
+
+    /// True to take the extensions and benjamins into account in evalScore()
+    bool m_evalExtensions;
+
+    /**
+     * Mask of the codes of the letters which can still be played, i.e.
+     * which are not all on the board (all the letters if a joker can still
+     * be played)
+     */
+    uint64_t m_availableLetters{0};
+
+    /// Letters which can be added to a word (see Dictionary::searchHooks())
+    struct Hooks
+    {
+        uint64_t front;
+        uint64_t back;
+    };
+
+    /// Cache of the hooks, by word
+    mutable std::map<std::wstring, Hooks> m_hooksCache;
+    /// Cache of the prefixes of the benjamins, by word
+    mutable std::map<std::wstring, std::vector<std::array<unsigned char, 3>>> m_benjCache;
+    /**
+     * Cache of the product of the word multipliers of the 3 squares before
+     * a square, for the benjamins (0 if it is not computed yet), indexed
+     * by the direction and by the coordinates of the square
+     */
+    mutable std::array<unsigned char, 2 * BOARD_REALDIM * BOARD_REALDIM> m_benjMultCache{};
+
+    /**
+     * Fill oCodes with the codes of the tiles remaining on the rack after
+     * playing the given round, in increasing order, and return their number.
+     * oCodes must have room for kMAX_LEAVE codes.
+     */
+    unsigned getLeave(const Round &iRound, unsigned *oCodes) const;
+
+    /// Return the key of the leave of the given round, in the leave table
+    uint64_t getLeaveKey(const Round &iRound) const;
 
     int evalScore(const Round &iRound) const;
     int evalForJokersInRack(const Round &iRound) const;
@@ -68,6 +140,18 @@ private:
     int evalForExtensions(const Round &iRound) const;
     int evalForBenjamins(const Round &iRound) const;
 
+    /// Return the word of the round, in internal characters
+    static std::wstring GetInternalWord(const Round &iRound);
+
+    /**
+     * Return the mask of the available letters which can be placed on the
+     * given square, as part of a word in the given direction (0 if the
+     * square is not a vacant square of the board)
+     */
+    uint64_t getPlayableLetters(int iRow, int iCol, Coord::Direction iDir) const;
+
+    bool isVacantOrOutside(int iRow, int iCol) const;
+
 };
 
 #endif
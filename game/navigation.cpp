@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <algorithm>
+
 #include "navigation.h"
 #include "turn.h"
 #include "command.h"
@@ -46,12 +48,21 @@ Navigation::~Navigation()
 }
 
 
+void Navigation::setStateHandler(GameStateHandler *iHandler)
+{
+    m_stateHandler = iHandler;
+    m_snapshots.clear();
+}
+
+
 void Navigation::newTurn()
 {
     LOG_INFO("New turn");
     lastTurn();
     m_allTurns.push_back(new Turn);
     ++m_currTurn;
+    if (m_observer != nullptr)
+        m_observer->turnAdded();
 }
 
 
@@ -59,7 +70,11 @@ void Navigation::addAndExecute(Command *iCmd)
 {
     if (!isLastTurn())
         throw GameException("Cannot add a command to an old turn");
+    if (m_allTurns[m_currTurn]->getCommands().empty())
+        saveSnapshot();
     m_allTurns[m_currTurn]->addAndExecute(iCmd);
+    if (m_observer != nullptr)
+        m_observer->commandAdded(m_currTurn, m_allTurns[m_currTurn]->getCommands().size() - 1);
 }
 
 
@@ -108,6 +123,7 @@ void Navigation::prevTurn()
     ASSERT(m_currTurn > 0, "Trying to go before the first turn");
     ASSERT(turn->isPartiallyExecuted(), "Unexpected turn state");
     turn->undo();
+    saveSnapshot();
 
     --m_currTurn;
     m_allTurns[m_currTurn]->partialUndo();
@@ -129,6 +145,7 @@ void Navigation::nextTurn()
         turn->execute();
 
         ++m_currTurn;
+        saveSnapshot();
         m_allTurns[m_currTurn]->partialExecute();
     }
     else
@@ -142,6 +159,7 @@ void Navigation::nextTurn()
 void Navigation::firstTurn()
 {
     LOG_DEBUG("Navigating to the first turn");
+    restoreSnapshot(0);
     while (!isFirstTurn())
     {
         prevTurn();
@@ -152,6 +170,7 @@ void Navigation::firstTurn()
 void Navigation::lastTurn()
 {
     LOG_DEBUG("Navigating to the last turn");
+    restoreSnapshot(m_allTurns.size() - 1);
     while (!isLastTurn())
     {
         nextTurn();
@@ -159,9 +178,26 @@ void Navigation::lastTurn()
 }
 
 
+void Navigation::goToTurn(unsigned int iTurn)
+{
+    ASSERT(iTurn < m_allTurns.size(), "Invalid turn number");
+    LOG_DEBUG("Navigating to turn {}", iTurn);
+    restoreSnapshot(iTurn);
+    while (m_currTurn > iTurn)
+    {
+        prevTurn();
+    }
+    while (m_currTurn < iTurn)
+    {
+        nextTurn();
+    }
+}
+
+
 void Navigation::clearFuture()
 {
     LOG_INFO("Erasing all the future turns");
+    const unsigned initialTurn = m_currTurn;
 
     // Replay the auto-execution turns (i.e. turns where only the AI was involved).
     // This is needed for a correct handling of free games
@@ -187,37 +223,57 @@ void Navigation::clearFuture()
     // Destroy non executed commands for the current turn
     ASSERT(turn->isPartiallyExecuted(), "Invalid state");
     turn->dropNonExecutedCommands();
+    dropSnapshotsAfter(m_currTurn);
 
     // Sanity checks
     ASSERT(isLastTurn(),
            "After removing the next turns, we should be at the last turn");
     ASSERT(turn->isFullyExecuted(), "Invalid final state");
+
+    if (m_observer != nullptr)
+        m_observer->futureCleared(initialTurn);
 }
 
 
 void Navigation::dropFrom(const Command &iCmd)
 {
     ASSERT(isLastTurn(), "Only possible in the last turn");
+    const unsigned idx = findCommand(iCmd);
     m_allTurns.back()->dropFrom(iCmd);
+    dropSnapshotsAfter(m_currTurn);
+    if (m_observer != nullptr)
+        m_observer->commandsDroppedFrom(m_currTurn, idx);
 }
 
 
 void Navigation::dropCommand(const Command &iCmd)
 {
+    const unsigned idx = findCommand(iCmd);
+    // The command is deleted by the drop
+    if (m_observer != nullptr)
+        m_observer->commandDropped(m_currTurn, idx);
     m_allTurns[m_currTurn]->dropCommand(iCmd);
+    dropSnapshotsAfter(m_currTurn);
 }
 
 
 void Navigation::insertCommand(Command *iCmd)
 {
     m_allTurns[m_currTurn]->insertCommand(iCmd);
+    dropSnapshotsAfter(m_currTurn);
+    if (m_observer != nullptr)
+        m_observer->commandInserted(m_currTurn, findCommand(*iCmd));
 }
 
 
 void Navigation::replaceCommand(const Command &iOldCmd,
                                 Command *iNewCmd)
 {
+    const unsigned idx = findCommand(iOldCmd);
     m_allTurns[m_currTurn]->replaceCommand(iOldCmd, iNewCmd);
+    dropSnapshotsAfter(m_currTurn);
+    if (m_observer != nullptr)
+        m_observer->commandReplaced(m_currTurn, idx);
 }
 
 
@@ -233,6 +289,65 @@ const Turn & Navigation::getCurrentTurn() const
 }
 
 
+void Navigation::saveSnapshot()
+{
+    if (m_stateHandler == nullptr || m_currTurn % kSnapshotInterval != 0)
+        return;
+    const unsigned idx = m_currTurn / kSnapshotInterval;
+    if (idx < m_snapshots.size() && m_snapshots[idx] != nullptr)
+        return;
+
+    ASSERT(m_allTurns[m_currTurn]->isNotAtAllExecuted(), "Unexpected turn state");
+    LOG_DEBUG("Saving the game state of turn {}", m_currTurn);
+    if (m_snapshots.size() <= idx)
+        m_snapshots.resize(idx + 1);
+    m_snapshots[idx] = m_stateHandler->saveState();
+}
+
+
+void Navigation::dropSnapshotsAfter(unsigned int iTurn)
+{
+    const unsigned nbKept = iTurn / kSnapshotInterval + 1;
+    if (m_snapshots.size() > nbKept)
+        m_snapshots.resize(nbKept);
+}
+
+
+void Navigation::restoreSnapshot(unsigned int iTurn)
+{
+    if (m_stateHandler == nullptr)
+        return;
+
+    // Find the closest snapshot before the given turn
+    unsigned idx = std::min<size_t>(iTurn / kSnapshotInterval + 1, m_snapshots.size());
+    while (idx > 0 && m_snapshots[idx - 1] == nullptr)
+        --idx;
+    if (idx == 0)
+        return;
+    const unsigned snapshotTurn = (idx - 1) * kSnapshotInterval;
+
+    // Navigating normally may be faster
+    const unsigned distance = iTurn > m_currTurn ? iTurn - m_currTurn : m_currTurn - iTurn;
+    if (iTurn - snapshotTurn >= distance)
+        return;
+
+    if (!m_stateHandler->restoreState(*m_snapshots[idx - 1]))
+    {
+        LOG_DEBUG("Cannot restore the game state of turn {}", snapshotTurn);
+        return;
+    }
+    LOG_DEBUG("Restored the game state of turn {}", snapshotTurn);
+
+    // Update the execution state of the commands accordingly
+    for (unsigned i = 0; i < m_allTurns.size(); ++i)
+    {
+        m_allTurns[i]->markExecuted(i < snapshotTurn);
+    }
+    m_currTurn = snapshotTurn;
+    m_allTurns[m_currTurn]->partialExecute();
+}
+
+
 void Navigation::print() const
 {
 #ifdef USE_LOGGING
@@ -249,3 +364,12 @@ void Navigation::print() const
 #endif
 }
 
+
+unsigned int Navigation::findCommand(const Command &iCmd) const
+{
+    const vector<Command *> &commands = m_allTurns[m_currTurn]->getCommands();
+    auto it = find(commands.begin(), commands.end(), &iCmd);
+    ASSERT(it != commands.end(), "Cannot find command");
+    return it - commands.begin();
+}
+
@@ -22,6 +22,7 @@
 #define NAVIGATION_H_
 
 #include <vector>
+#include <memory>
 #include "logging.h"
 
 class Turn;
@@ -30,6 +31,79 @@ class Command;
 using namespace std;
 
 
+/**
+ * Copy of the state of a game modified by the commands (board, bag,
+ * histories, ...), saved by Navigation at the beginning of some turns.
+ */
+class GameState
+{
+    public:
+        virtual ~GameState() = default;
+};
+
+
+/**
+ * Interface used by Navigation to save and restore the state of the game
+ * (see Navigation::setStateHandler()).
+ */
+class GameStateHandler
+{
+    public:
+        virtual ~GameStateHandler() = default;
+
+        /// Return a copy of the current state
+        virtual unique_ptr<GameState> saveState() const = 0;
+
+        /**
+         * Restore the given state, and return true.
+         * If the state cannot be restored (for instance because players
+         * were added after saving it), nothing is changed and false
+         * is returned.
+         */
+        virtual bool restoreState(const GameState &iState) = 0;
+};
+
+
+/**
+ * Interface used by Navigation to report the modifications of the
+ * commands of the game (see Navigation::setObserver()).
+ * The methods are called after the modification (except commandDropped(),
+ * see below), with the index of the current turn before the modification,
+ * and the index of the command in the turn. Navigating in the history is
+ * not reported.
+ */
+class NavigationObserver
+{
+    public:
+        virtual ~NavigationObserver() = default;
+
+        /// A new (empty) turn was added
+        virtual void turnAdded() = 0;
+
+        /// A command was added at the end of the last turn
+        virtual void commandAdded(unsigned int iTurn, unsigned int iIndex) = 0;
+
+        /// A command was inserted in the given turn
+        virtual void commandInserted(unsigned int iTurn, unsigned int iIndex) = 0;
+
+        /// The command at the given index was replaced with another one
+        virtual void commandReplaced(unsigned int iTurn, unsigned int iIndex) = 0;
+
+        /**
+         * The command at the given index is about to be removed.
+         * This method is called before the removal, so that the command
+         * can still be inspected.
+         */
+        virtual void commandDropped(unsigned int iTurn, unsigned int iIndex) = 0;
+
+        /// The commands of the last turn were removed, starting from the given one
+        virtual void commandsDroppedFrom(unsigned int iTurn, unsigned int iIndex) = 0;
+
+        /// The future turns were removed, from the given current turn
+        virtual void futureCleared(unsigned int iTurn) = 0;
+};
+
+
 /**
  * Handle the navigation in the game history.
  *
@@ -42,6 +116,14 @@ using namespace std;
  *    and is fully executed
  *
  * Many assertions are there to help enforce this design.
+ *
+ * To avoid executing or undoing all the commands of the game when
+ * jumping to a distant turn, the state of the game is saved at the
+ * beginning of every kSnapshotInterval turns (when a state handler is
+ * given). Navigation then restores the closest snapshot before the
+ * target turn, and only replays the turns after it.
+ * A snapshot only depends on the commands of the previous turns, so
+ * modifying the commands of a turn drops the snapshots after it.
  */
 class Navigation
 {
@@ -50,6 +132,18 @@ class Navigation
         Navigation();
         ~Navigation();
 
+        /**
+         * Set the object used to save and restore the state of the game.
+         * Without it (or with nullptr), no snapshot is taken.
+         */
+        void setStateHandler(GameStateHandler *iHandler);
+
+        /**
+         * Set the object notified of the modifications of the commands
+         * (nullptr to stop the notifications)
+         */
+        void setObserver(NavigationObserver *iObserver) { m_observer = iObserver; }
+
         void newTurn();
         void addAndExecute(Command *iCmd);
 
@@ -62,6 +156,11 @@ class Navigation
         void prevTurn();
         void nextTurn();
         void lastTurn();
+        /**
+         * Go to the given turn (starting from 0), which is left in
+         * the "partially executed" state
+         */
+        void goToTurn(unsigned int iTurn);
         /**
          * Get rid of the future turns of the game, the current turn
          * becoming the last one.
@@ -101,8 +200,41 @@ class Navigation
         void print() const;
 
     private:
+        /// Number of turns between two snapshots of the game state
+        static const unsigned kSnapshotInterval = 5;
+
         vector<Turn *> m_allTurns;
         unsigned int m_currTurn{0};
+
+        GameStateHandler *m_stateHandler{nullptr};
+        NavigationObserver *m_observer{nullptr};
+
+        /**
+         * Snapshot of the game state at the beginning of the turn
+         * i * kSnapshotInterval (before executing any of its commands),
+         * or nullptr if it is not known (yet)
+         */
+        vector<unique_ptr<GameState>> m_snapshots;
+
+        /**
+         * Save the state of the game for the current turn, if needed.
+         * The current turn must not be executed at all, and the previous
+         * turns must be fully executed.
+         */
+        void saveSnapshot();
+
+        /// Drop the snapshots of the turns after the given one
+        void dropSnapshotsAfter(unsigned int iTurn);
+
+        /**
+         * Restore the closest snapshot before the given turn, if this is
+         * faster than navigating from the current turn. The turn of the
+         * snapshot becomes the current one (partially executed).
+         */
+        void restoreSnapshot(unsigned int iTurn);
+
+        /// Return the index of the given command in the current turn
+        unsigned int findCommand(const Command &iCmd) const;
 };
 
 #endif
@@ -55,6 +55,7 @@ public:
     void setNew(const Rack &iRack);
     void setManual(const wstring& iLetters);
     void setReject(bool iReject = true) { m_reject = iReject; }
+    bool isReject() const { return m_reject; }
 
     unsigned int getNbTiles() const  { return getNbNew() + getNbOld(); }
     unsigned int getNbNew() const    { return m_newTiles.size(); }
@@ -18,6 +18,17 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <fstream>
+#include <cstdio>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
 #include "public_game.h"
 #include "game_params.h"
 #include "game.h"
@@ -25,10 +36,13 @@
 #include "duplicate.h"
 #include "arbitration.h"
 #include "freegame.h"
+#include "endgame_solver.h"
 #include "topping.h"
 #include "game_factory.h"
 #include "game_exception.h"
 #include "xml_writer.h"
+#include "bin_writer.h"
+#include "journal.h"
 #include "player.h"
 #include "pldrack.h"
 
@@ -41,6 +55,8 @@ PublicGame::PublicGame(Game &iGame)
 
 PublicGame::~PublicGame()
 {
+    // The journal refers to the game
+    m_journal.reset();
     delete &m_game;
 }
 
@@ -228,6 +244,12 @@ void PublicGame::trainingSearch()
 }
 
 
+void PublicGame::trainingSetResults(const LimitResults &iResults)
+{
+    getTypedGame<Training>(m_game).setResults(iResults);
+}
+
+
 const Results& PublicGame::trainingGetResults() const
 {
     return getTypedGame<Training>(m_game).getResults();
@@ -309,6 +331,12 @@ int PublicGame::freeGamePass(const wstring &iToChange)
     return getTypedGame<FreeGame>(m_game).pass(iToChange);
 }
 
+
+EndgameResult PublicGame::freeGameSolveEndgame(unsigned iTimeLimit) const
+{
+    return getTypedGame<FreeGame>(m_game).solveEndgame(iTimeLimit);
+}
+
 /***************************/
 
 void PublicGame::arbitrationSetRackRandom()
@@ -404,9 +432,47 @@ PublicGame *PublicGame::load(const string &iFileName, const Dictionary &iDic)
 }
 
 
-void PublicGame::save(const string &iFileName) const
+void PublicGame::save(const string &iFileName, SaveFormat iFormat) const
+{
+    if (iFormat == kBINARY)
+        BinWriter::write(m_game, iFileName);
+    else
+        XmlWriter::write(m_game, iFileName);
+}
+
+
+void PublicGame::startJournal(const string &iFileName)
 {
-    XmlWriter::write(m_game, iFileName);
+    m_journal.reset();
+    // The base save is replaced atomically, so the previous save and its
+    // journal stay usable until the new save is completely on the disk
+    BinWriter::write(m_game, iFileName);
+    // The previous journal does not correspond to the new save
+    const string &journalFileName = GetJournalFileName(iFileName);
+    remove(journalFileName.c_str());
+    m_journal = std::make_unique<Journal>(m_game, journalFileName);
+}
+
+
+void PublicGame::stopJournal()
+{
+    m_journal.reset();
+}
+
+
+string PublicGame::GetJournalFileName(const string &iFileName)
+{
+    return iFileName + ".journal";
+}
+
+
+PublicGame *PublicGame::recover(const string &iFileName, const Dictionary &iDic)
+{
+    unique_ptr<Game> game(GameFactory::Instance()->load(iFileName, iDic));
+    const string &journalFileName = GetJournalFileName(iFileName);
+    if (ifstream(journalFileName.c_str()).good())
+        Journal::Replay(*game, journalFileName);
+    return new PublicGame(*game.release());
 }
 
 /***************************/
@@ -460,6 +526,14 @@ void PublicGame::lastTurn()
 }
 
 
+void PublicGame::goToTurn(unsigned int iTurn)
+{
+    if (iTurn == 0 || iTurn > getNbTurns())
+        throw GameException(_("Invalid turn number"));
+    m_game.accessNavigation().goToTurn(iTurn - 1);
+}
+
+
 void PublicGame::clearFuture()
 {
     m_game.accessNavigation().clearFuture();
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 class GameParams;
 class Game;
@@ -37,6 +38,8 @@ class Results;
 class LimitResults;
 class Move;
 class PlayedRack;
+class Journal;
+struct EndgameResult;
 
 using namespace std;
 
@@ -199,6 +202,7 @@ public:
      ***************/
 
     void trainingSearch();
+    void trainingSetResults(const LimitResults &iResults);
     const Results& trainingGetResults() const;
     int trainingPlayResult(unsigned int iResultIndex);
 
@@ -275,6 +279,14 @@ public:
      */
     int freeGamePass(const wstring &iToChange);
 
+    /**
+     * Search the best move for the current player, once the bag is empty.
+     * The game is not modified.
+     * @exception GameException if there are not 2 players, or if the bag
+     * is not empty
+     */
+    EndgameResult freeGameSolveEndgame(unsigned iTimeLimit) const;
+
     /***************
      * Arbitration games
      * These methods throw an exception if the current game is not in
@@ -317,15 +329,48 @@ public:
      ***************/
 
     /**
-     * Return the loaded game, from an XML file.
+     * Return the loaded game, from an XML or binary file
+     * (the format is detected automatically).
      * An exception is thrown in case of problem.
      */
     static PublicGame * load(const string &iFileName, const Dictionary &iDic);
 
+    enum SaveFormat
+    {
+        kXML,
+        /// Compact format, much faster to load (see BinFormat)
+        kBINARY
+    };
+
+    /**
+     * Save a game to a file, in the given format
+     */
+    void save(const string &iFileName, SaveFormat iFormat = kXML) const;
+
+    /**
+     * Save the game in the binary format, and start recording its next
+     * modifications in the journal of the file (see Journal), which is
+     * much cheaper than saving the whole game after each modification.
+     * A previous journal is stopped (and replaced).
+     */
+    void startJournal(const string &iFileName);
+
+    /// Stop recording the modifications (the journal file is kept)
+    void stopJournal();
+
+    /// Return the journal of the game, or nullptr if it is not started
+    const Journal * getJournal() const { return m_journal.get(); }
+
+    /// Return the name of the journal associated to the given saved game
+    static string GetJournalFileName(const string &iFileName);
+
     /**
-     * Save a game to a XML file
+     * Load the given saved game, and replay its journal (if any),
+     * to recover the state of the game after an interruption.
+     * The entries of the journal which cannot be applied are ignored (see
+     * Journal::Replay()). An exception is thrown if the game cannot be loaded.
      */
-    void save(const string &iFileName) const;
+    static PublicGame * recover(const string &iFileName, const Dictionary &iDic);
 
     /***************
      * Navigation in the game history
@@ -340,6 +385,8 @@ public:
     void prevTurn();
     void nextTurn();
     void lastTurn();
+    /// Go to the given turn (starting from 1, like getCurrTurn())
+    void goToTurn(unsigned int iTurn);
 
     /**
      * Get rid of the future turns of the game, the current turn
@@ -355,6 +402,9 @@ public:
 private:
     /// Wrapped game
     Game &m_game;
+
+    /// Journal of the modifications, if started
+    unique_ptr<Journal> m_journal;
 };
 
 #endif
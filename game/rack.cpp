@@ -20,7 +20,9 @@
  *****************************************************************************/
 
 #include "rack.h"
+#include "round.h"
 #include "dic.h"
+#include "random.h"
 #include "encoding.h"
 #include "debug.h"
 
@@ -43,6 +45,16 @@ void Rack::remove(const Tile &t)
 }
 
 
+void Rack::removePlayedTiles(const Round &iRound)
+{
+    for (unsigned i = 0; i < iRound.getWordLen(); ++i)
+    {
+        if (iRound.isPlayedFromRack(i))
+            remove(iRound.isJoker(i) ? Tile::Joker() : iRound.getTile(i));
+    }
+}
+
+
 void Rack::clear()
 {
     for (unsigned int & tile : m_tiles)
@@ -64,6 +76,18 @@ void Rack::getTiles(vector<Tile> &oTiles) const
 }
 
 
+uint64_t Rack::getHash() const
+{
+    uint64_t hash = m_nbTiles;
+    for (unsigned i = 1; i < m_tiles.size(); i++)
+    {
+        if (m_tiles[i] != 0)
+            hash = Random::mixBits(hash ^ (i << 8 | m_tiles[i]));
+    }
+    return hash;
+}
+
+
 wstring Rack::toString() const
 {
     wstring rs;
@@ -24,10 +24,13 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include "tile.h"
 #include "logging.h"
 
+class Round;
+
 using namespace std;
 
 
@@ -49,9 +52,14 @@ public:
 
     void add(const Tile &t)     { m_tiles[t.toCode()]++; m_nbTiles++; }
     void remove(const Tile &t);
+    /// Remove the tiles of the rack played in the given round
+    void removePlayedTiles(const Round &iRound);
     void clear();
     void getTiles(vector<Tile> &oTiles) const;
 
+    /// Hash of the tiles of the rack (their order does not matter)
+    uint64_t getHash() const;
+
     wstring toString() const;
 
     bool operator==(const Rack &iOther) const;
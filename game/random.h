@@ -22,6 +22,7 @@
 #define RANDOM_H_
 
 #include <random>
+#include <cstdint>
 
 class Random {
 public:
@@ -29,6 +30,8 @@ public:
     Random() = delete;
 
     static std::mt19937& getEngine() {
+        if (t_engine != nullptr)
+            return *t_engine;
         return s_engine;
     }
 
@@ -41,6 +44,40 @@ public:
         return s_currentSeed;
     }
 
+    /**
+     * Mix the bits of iValue (finalizer of the SplitMix64 generator).
+     * This does not use the engine: it is meant to build hash keys.
+     */
+    static uint64_t mixBits(uint64_t iValue) {
+        iValue = (iValue ^ (iValue >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        iValue = (iValue ^ (iValue >> 27)) * 0x94D049BB133111EBULL;
+        return iValue ^ (iValue >> 31);
+    }
+
+    /**
+     * While an object of this class exists, the engine returned by
+     * getEngine() in the current thread is the given one, instead of
+     * the shared engine. This allows playing several games in parallel
+     * threads, each one with its own reproducible random sequence.
+     */
+    class ThreadEngine {
+    public:
+        explicit ThreadEngine(std::mt19937 &iEngine)
+            : m_previous(t_engine) {
+            t_engine = &iEngine;
+        }
+
+        ~ThreadEngine() {
+            t_engine = m_previous;
+        }
+
+        ThreadEngine(const ThreadEngine &) = delete;
+        ThreadEngine & operator=(const ThreadEngine &) = delete;
+
+    private:
+        std::mt19937 *m_previous;
+    };
+
 private:
     // Seed used to initialize the engine
     inline static unsigned int s_currentSeed = 0;
@@ -54,6 +91,9 @@ private:
     // The shared engine, initialized via the helper function above
     inline static std::mt19937 s_engine = initEngine();
 
+    // Engine used by the current thread instead of the shared one, if any
+    inline static thread_local std::mt19937 *t_engine = nullptr;
+
 };
 
 #endif
@@ -20,57 +20,201 @@
  *****************************************************************************/
 
 #include <algorithm>
+#include <cstring>
+#include <format>
 
 #include "results.h"
+#include "search_control.h"
 #include "tile.h"
 #include "round.h"
 #include "board.h"
 #include "move_selector.h"
+#include "search_cache.h"
+#include "settings.h"
+#include "dic.h"
+#include "header.h"
+#include "rack.h"
 #include "debug.h"
 
 
 INIT_LOGGER(game, Results);
 
 
-bool tileCompare(const Tile &t1, const Tile &t2)
+PackedRound::PackedRound(const Round &iRound)
+    : m_len(iRound.getWordLen()),
+    m_row(iRound.getCoord().getRow()),
+    m_col(iRound.getCoord().getCol()),
+    m_horizontal(iRound.getCoord().getDir() == Coord::HORIZONTAL),
+    m_bonus(iRound.getBonus()),
+    m_rackOrigin(0),
+    m_points(iRound.getPoints())
 {
-    return t1.toCode() < t2.toCode();
+    ASSERT(m_points >= 0, "Invalid number of points");
+    memset(m_key, 0, kKeySize);
+
+    // Points, in decreasing order
+    const uint32_t points = 0x7FFFFFFF - m_points;
+    m_key[kPointsOffset] = points >> 24;
+    m_key[kPointsOffset + 1] = (points >> 16) & 0xFF;
+    m_key[kPointsOffset + 2] = (points >> 8) & 0xFF;
+    m_key[kPointsOffset + 3] = points & 0xFF;
+
+    // Tiles and jokers
+    unsigned int jokers = 0;
+    for (unsigned int i = 0; i < m_len; ++i)
+    {
+        const Tile &tile = iRound.getTile(i);
+        m_key[kCodesOffset + i] = tile.toCode();
+        if (tile.isJoker())
+            jokers |= 1 << (15 - i);
+        if (iRound.isPlayedFromRack(i))
+            m_rackOrigin |= 1 << i;
+    }
+    m_key[kJokersOffset] = jokers >> 8;
+    m_key[kJokersOffset + 1] = jokers & 0xFF;
+
+    // Coordinates, with the same characters as Coord::toString()
+    uint8_t *coord = m_key + kCoordOffset;
+    const uint8_t rowChar = 'A' + m_row - 1;
+    if (!m_horizontal)
+    {
+        if (m_col >= 10)
+            *coord++ = '0' + m_col / 10;
+        *coord++ = '0' + m_col % 10;
+        *coord = rowChar;
+    }
+    else
+    {
+        *coord++ = rowChar;
+        if (m_col >= 10)
+            *coord++ = '0' + m_col / 10;
+        *coord = '0' + m_col % 10;
+    }
+}
+
+
+bool PackedRound::isJoker(unsigned int iIndex) const
+{
+    const unsigned int jokers = (m_key[kJokersOffset] << 8) | m_key[kJokersOffset + 1];
+    return jokers & (1 << (15 - iIndex));
+}
+
+
+Round PackedRound::unpack() const
+{
+    Round round;
+    for (unsigned int i = 0; i < m_len; ++i)
+    {
+        round.addRightFromRack(Tile(m_key[kCodesOffset + i], isJoker(i)), false);
+        if (!(m_rackOrigin & (1 << i)))
+            round.setFromBoard(i);
+    }
+    round.accessCoord() = getCoord();
+    round.setPoints(m_points);
+    round.setBonus(m_bonus);
+    return round;
+}
+
+
+Coord PackedRound::getCoord() const
+{
+    return Coord(m_row, m_col, m_horizontal ? Coord::HORIZONTAL : Coord::VERTICAL);
+}
+
+
+bool PackedRound::operator<(const PackedRound &iOther) const
+{
+    return memcmp(m_key, iOther.m_key, kKeySize) < 0;
 }
 
 
-const Round & Results::get(unsigned int i) const
+Round Results::get(unsigned int i) const
 {
     ASSERT(i < size(), "Results index out of bounds");
-    return m_rounds[i];
+    return m_rounds[i].unpack();
+}
+
+
+void Results::search(const Dictionary &iDic, const Board &iBoard,
+                     const Rack &iRack, bool iFirstWord)
+{
+    const string cacheKey = getCacheKey();
+    if (cacheKey.empty())
+    {
+        doSearch(iDic, iBoard, iRack, iFirstWord);
+        return;
+    }
+
+    SearchCache &cache = SearchCache::Instance();
+    const Header &header = iDic.getHeader();
+    const uint64_t dicSignature =
+        (uint64_t)header.getNbWords() << 32 | header.getNbEdgesUsed();
+    const SearchCache::Key key{&iDic, dicSignature, iBoard.getHash(),
+                               iRack.toString(), iFirstWord, cacheKey};
+    clear();
+    if (cache.lookup(key, m_rounds))
+    {
+        LOG_DEBUG("Search results found in the cache");
+        return;
+    }
+
+    doSearch(iDic, iBoard, iRack, iFirstWord);
+    // An interrupted search is incomplete
+    if (m_control != nullptr && m_control->isCancelled())
+        return;
+    cache.store(key, m_rounds);
+}
+
+
+void Results::merge(const Results &iOther)
+{
+    for (const PackedRound &round : iOther.m_rounds)
+    {
+        add(round.unpack());
+    }
 }
 
 
 void Results::sort()
 {
-    std::ranges::sort(m_rounds, [](const Round& r1, const Round& r2) {
-        // We want higher scores first, so we use descending order
-        if (auto cmp = r1.getPoints() <=> r2.getPoints(); cmp != 0) // NOLINT(modernize-use-nullptr)
-            return cmp > 0; // NOLINT(modernize-use-nullptr)
+    // The sort key of the rounds gives the expected order
+    std::sort(m_rounds.begin(), m_rounds.end());
+}
 
-        // Next, do case-insensitive sorting
-        if (std::ranges::lexicographical_compare(r1.getTiles(), r2.getTiles(), tileCompare))
-            return true;
-        if (std::ranges::lexicographical_compare(r2.getTiles(), r1.getTiles(), tileCompare))
-            return false;
 
-        // If the rounds are still equal, compare coordinates
-        if (auto cmp = r1.getCoord().toString() <=> r2.getCoord().toString(); cmp != 0) // NOLINT(modernize-use-nullptr)
-            return cmp < 0; // NOLINT(modernize-use-nullptr)
+BestResults::BestResults()
+    : m_sharedBestScore(make_shared<atomic<int>>(0))
+{
+}
+
 
-        // Finally, compare taking the case into account.
-        // After that, we are sure that the rounds will be different...
-        return r1.getWord() < r2.getWord();
-    });
+BestResults::BestResults(const shared_ptr<atomic<int>> &iSharedBestScore)
+    : m_sharedBestScore(iSharedBestScore)
+{
 }
 
 
-void BestResults::search(const Dictionary &iDic, const Board &iBoard,
-                         const Rack &iRack, bool iFirstWord)
+BestResults::BestResults(const BestResults &iOther)
+    : Results(iOther), m_bestScore(iOther.m_bestScore),
+    m_sharedBestScore(make_shared<atomic<int>>(iOther.m_sharedBestScore->load()))
+{
+}
+
+
+BestResults & BestResults::operator=(const BestResults &iOther)
+{
+    if (this != &iOther)
+    {
+        Results::operator=(iOther);
+        m_bestScore = iOther.m_bestScore;
+        m_sharedBestScore = make_shared<atomic<int>>(iOther.m_sharedBestScore->load());
+    }
+    return *this;
+}
+
+
+void BestResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                           const Rack &iRack, bool iFirstWord)
 {
     clear();
 
@@ -94,8 +238,25 @@ void BestResults::add(const Round &iRound)
         // New best score: clear the stored results
         m_bestScore = iRound.getPoints();
         m_rounds.clear();
+
+        // Let the other sinks know about it
+        int shared = m_sharedBestScore->load(std::memory_order_relaxed);
+        while (shared < m_bestScore &&
+               !m_sharedBestScore->compare_exchange_weak(shared, m_bestScore,
+                                                         std::memory_order_relaxed))
+        {
+        }
     }
-    m_rounds.push_back(iRound);
+    m_rounds.emplace_back(iRound);
+}
+
+
+int BestResults::getMinScore() const
+{
+    // The rounds found by the other sinks are merged with the ones
+    // kept here, so any round with a lower score will be discarded
+    return std::max(m_bestScore,
+                    m_sharedBestScore->load(std::memory_order_relaxed));
 }
 
 
@@ -103,6 +264,19 @@ void BestResults::clear()
 {
     m_rounds.clear();
     m_bestScore = 0;
+    m_sharedBestScore->store(0);
+}
+
+
+Results * BestResults::createSink() const
+{
+    return new BestResults(m_sharedBestScore);
+}
+
+
+string BestResults::getCacheKey() const
+{
+    return "best";
 }
 
 
@@ -116,7 +290,7 @@ class Predicate
 {
 public:
     Predicate(int iPoints) : m_chosenPoints(iPoints) {}
-    bool operator()(const Round &iRound) const
+    bool operator()(const PackedRound &iRound) const
     {
         return iRound.getPoints() != m_chosenPoints;
     }
@@ -126,8 +300,8 @@ private:
 };
 
 
-void PercentResults::search(const Dictionary &iDic, const Board &iBoard,
-                            const Rack &iRack, bool iFirstWord)
+void PercentResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                              const Rack &iRack, bool iFirstWord)
 {
     clear();
 
@@ -143,7 +317,7 @@ void PercentResults::search(const Dictionary &iDic, const Board &iBoard,
 
     // Find the lowest score at least equal to the min_score
     int chosenPoints = m_bestScore;
-    for (const Round &iRound : m_rounds)
+    for (const PackedRound &iRound : m_rounds)
     {
         int points = iRound.getPoints();
         if (points >= m_minScore && points < chosenPoints)
@@ -170,9 +344,18 @@ void PercentResults::add(const Round &iRound)
     if (m_bestScore < iRound.getPoints())
     {
         m_bestScore = iRound.getPoints();
-        m_minScore = lrint(ceil(m_bestScore * m_percent));
+        const int minScore = lrint(ceil(m_bestScore * m_percent));
+        if (minScore > m_minScore)
+        {
+            // Forget the rounds which cannot be chosen anymore,
+            // to keep the memory usage low during the search
+            m_minScore = minScore;
+            std::erase_if(m_rounds, [minScore](const PackedRound &iRound) {
+                return iRound.getPoints() < minScore;
+            });
+        }
     }
-    m_rounds.push_back(iRound);
+    m_rounds.emplace_back(iRound);
 }
 
 
@@ -184,6 +367,18 @@ void PercentResults::clear()
 }
 
 
+Results * PercentResults::createSink() const
+{
+    return new PercentResults(m_percent);
+}
+
+
+string PercentResults::getCacheKey() const
+{
+    return std::format("percent {}", m_percent);
+}
+
+
 
 LimitResults::LimitResults(int iLimit)
     : m_limit(iLimit)
@@ -191,8 +386,8 @@ LimitResults::LimitResults(int iLimit)
 }
 
 
-void LimitResults::search(const Dictionary &iDic, const Board &iBoard,
-                          const Rack &iRack, bool iFirstWord)
+void LimitResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                            const Rack &iRack, bool iFirstWord)
 {
     clear();
 
@@ -209,7 +404,7 @@ void LimitResults::search(const Dictionary &iDic, const Board &iBoard,
 
     // Truncate the results to respect the limit
     if (m_limit != 0 && m_rounds.size() > (unsigned int) m_limit)
-        m_rounds.resize(m_limit);
+        m_rounds.erase(m_rounds.begin() + m_limit, m_rounds.end());
 }
 
 
@@ -218,7 +413,7 @@ void LimitResults::add(const Round &iRound)
     // If we ignore the limit, simply add the round
     if (m_limit == 0)
     {
-        m_rounds.push_back(iRound);
+        m_rounds.emplace_back(iRound);
         return;
     }
 
@@ -227,7 +422,7 @@ void LimitResults::add(const Round &iRound)
         return;
 
     // Add the round
-    m_rounds.push_back(iRound);
+    m_rounds.emplace_back(iRound);
     ++m_total;
     ++m_scoresCount[iRound.getPoints()];
 
@@ -257,10 +452,171 @@ void LimitResults::clear()
 }
 
 
-void MasterResults::search(const Dictionary &iDic, const Board &iBoard,
-                           const Rack &iRack, bool iFirstWord)
+Results * LimitResults::createSink() const
+{
+    return new LimitResults(m_limit);
+}
+
+
+string LimitResults::getCacheKey() const
+{
+    return std::format("limit {}", m_limit);
+}
+
+
+TopResults::TopResults(unsigned int iLimit)
+    : m_limit(iLimit)
+{
+    ASSERT(m_limit > 0, "The limit must be positive");
+}
+
+
+void TopResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                          const Rack &iRack, bool iFirstWord)
+{
+    clear();
+    m_rounds.reserve(m_limit);
+
+    if (iFirstWord)
+        iBoard.searchFirst(iDic, iRack, *this);
+    else
+        iBoard.search(iDic, iRack, *this);
+
+    // Sort the rounds
+    sort();
+}
+
+
+void TopResults::add(const Round &iRound)
+{
+    // Fill the heap
+    if (m_rounds.size() < m_limit)
+    {
+        m_rounds.emplace_back(iRound);
+        std::push_heap(m_rounds.begin(), m_rounds.end());
+        return;
+    }
+
+    // Ignore too low scores, without building the packed round
+    if (m_rounds.front().getPoints() > iRound.getPoints())
+        return;
+
+    // Replace the worst kept round, if the new one is better
+    PackedRound round(iRound);
+    if (round < m_rounds.front())
+    {
+        std::pop_heap(m_rounds.begin(), m_rounds.end());
+        m_rounds.back() = round;
+        std::push_heap(m_rounds.begin(), m_rounds.end());
+    }
+}
+
+
+int TopResults::getMinScore() const
+{
+    // The heap is full: rounds with a lower score than the worst
+    // kept one will be ignored
+    if (m_rounds.size() < m_limit)
+        return -1;
+    return m_rounds.front().getPoints();
+}
+
+
+void TopResults::clear()
+{
+    m_rounds.clear();
+}
+
+
+Results * TopResults::createSink() const
+{
+    return new TopResults(m_limit);
+}
+
+
+string TopResults::getCacheKey() const
+{
+    return std::format("top {}", m_limit);
+}
+
+
+void StatsResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                            const Rack &iRack, bool iFirstWord)
+{
+    clear();
+
+    if (iFirstWord)
+        iBoard.searchFirst(iDic, iRack, *this);
+    else
+        iBoard.search(iDic, iRack, *this);
+}
+
+
+void StatsResults::add(const Round &iRound)
+{
+    ++m_nbRounds;
+    if (iRound.getBonus())
+        ++m_nbBingos;
+    ++m_scoresCount[iRound.getPoints()];
+
+    // Keep only the best round
+    if (!m_rounds.empty() && m_rounds.front().getPoints() > iRound.getPoints())
+        return;
+    PackedRound round(iRound);
+    if (m_rounds.empty())
+        m_rounds.push_back(round);
+    else if (round < m_rounds.front())
+        m_rounds.front() = round;
+}
+
+
+void StatsResults::clear()
+{
+    m_rounds.clear();
+    m_nbRounds = 0;
+    m_nbBingos = 0;
+    m_scoresCount.clear();
+}
+
+
+Results * StatsResults::createSink() const
+{
+    return new StatsResults;
+}
+
+
+void StatsResults::merge(const Results &iOther)
+{
+    const StatsResults *other = dynamic_cast<const StatsResults *>(&iOther);
+    ASSERT(other != nullptr, "Cannot merge StatsResults with other results");
+
+    m_nbRounds += other->m_nbRounds;
+    m_nbBingos += other->m_nbBingos;
+    for (const auto &[score, count] : other->m_scoresCount)
+        m_scoresCount[score] += count;
+
+    if (!other->m_rounds.empty() &&
+        (m_rounds.empty() || other->m_rounds.front() < m_rounds.front()))
+    {
+        m_rounds.clear();
+        m_rounds.push_back(other->m_rounds.front());
+    }
+}
+
+
+int StatsResults::getBestScore() const
+{
+    if (m_rounds.empty())
+        return 0;
+    return m_rounds.front().getPoints();
+}
+
+
+void MasterResults::doSearch(const Dictionary &iDic, const Board &iBoard,
+                             const Rack &iRack, bool iFirstWord)
 {
     // Perform the search of the best results
+    m_bestResults.setControl(getControl());
     m_bestResults.search(iDic, iBoard, iRack, iFirstWord);
 
     // If the search yields no result, there is nothing else to do
@@ -270,7 +626,7 @@ void MasterResults::search(const Dictionary &iDic, const Board &iBoard,
     // Find the best round, according to the heuristics in MoveSelector
     MoveSelector selector(iDic, iBoard, iRack);
     const Round &round = selector.selectMaster(m_bestResults);
-    m_rounds.push_back(round);
+    m_rounds.emplace_back(round);
 }
 
 
@@ -287,3 +643,18 @@ void MasterResults::clear()
 }
 
 
+Results * MasterResults::createSink() const
+{
+    // Only the best rounds are needed to select the master move
+    return m_bestResults.createSink();
+}
+
+
+string MasterResults::getCacheKey() const
+{
+    // The selected round depends on the heuristics used by MoveSelector
+    return std::format("master {}",
+                       Settings::Instance().getBool("duplicate.master-heuristics"));
+}
+
+
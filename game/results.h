@@ -24,6 +24,10 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <stdint.h>
 #include "round.h"
 #include "logging.h"
 
@@ -33,6 +37,59 @@ class Dictionary;
 class Board;
 class Rack;
 class Bag;
+class SearchControl;
+
+
+/**
+ * Compact representation of a Round, used by the Results classes to store
+ * the rounds found during a search. The record has a fixed size, so storing
+ * a round does not allocate any memory (apart from the growth of the
+ * container).
+ *
+ * Most of the information is stored in a binary sort key, built once,
+ * such that comparing the keys of 2 rounds with memcmp() gives the order
+ * described in the Results class. The key is made of:
+ *  - the points, in decreasing order;
+ *  - the codes of the tiles, without the joker information;
+ *  - the characters of the coordinates, as returned by Coord::toString();
+ *  - a bit for each tile set if it is a joker, the first tile being the
+ *    most significant one. Since the display string of a joker is the
+ *    lowercase version of the one of the letter, this gives the same
+ *    order as comparing the words returned by Round::getWord().
+ */
+class PackedRound
+{
+public:
+    PackedRound(const Round &iRound);
+
+    /// Rebuild the complete round
+    Round unpack() const;
+
+    int getPoints() const { return m_points; }
+    unsigned int getWordLen() const { return m_len; }
+    Coord getCoord() const;
+
+    /// Order the rounds according to their sort key
+    bool operator<(const PackedRound &iOther) const;
+
+private:
+    static const unsigned int kPointsOffset = 0;
+    static const unsigned int kCodesOffset = kPointsOffset + 4;
+    static const unsigned int kCoordOffset = kCodesOffset + Round::kMaxLen;
+    static const unsigned int kJokersOffset = kCoordOffset + 3;
+    static const unsigned int kKeySize = kJokersOffset + 2;
+
+    uint8_t m_key[kKeySize];
+    uint8_t m_len;
+    uint8_t m_row;
+    uint8_t m_col;
+    bool m_horizontal;
+    bool m_bonus;
+    uint16_t m_rackOrigin;
+    int32_t m_points;
+
+    bool isJoker(unsigned int iIndex) const;
+};
 
 
 /**
@@ -52,16 +109,22 @@ class Results
 public:
     virtual ~Results() = default;
     unsigned int size() const { return m_rounds.size(); }
-    const Round & get(unsigned int) const;
+    /// Return the i-th round (it is rebuilt from its compact form)
+    Round get(unsigned int) const;
+    /// Return the points of the i-th round (cheaper than get(i).getPoints())
+    int getPoints(unsigned int i) const { return m_rounds[i].getPoints(); }
     bool isEmpty() const { return m_rounds.empty(); }
 
     /**
      * Perform a search on the board. Every time a word is found,
      * the add() method will be called. At the end of the search,
      * results are sorted.
+     * If the same search was performed recently, the rounds are simply
+     * taken from the SearchCache. In this case, only the kept rounds are
+     * restored: the internal state used during the search is not.
      */
-    virtual void search(const Dictionary &iDic, const Board &iBoard,
-                        const Rack &iRack, bool iFirstWord) = 0;
+    void search(const Dictionary &iDic, const Board &iBoard,
+                const Rack &iRack, bool iFirstWord);
 
     /** Add a round */
     virtual void add(const Round &iRound) = 0;
@@ -69,9 +132,58 @@ public:
     /** Clear the stored rounds, and get ready for a new search */
     virtual void clear() = 0;
 
+    /**
+     * Return a score such that add() would ignore any round with fewer
+     * points, given the rounds added so far. The search uses it to skip
+     * the parts of the board which cannot give such a score.
+     * A negative value means that no round can be ignored.
+     */
+    virtual int getMinScore() const { return -1; }
+
+    /**
+     * Create a new, empty, Results object suitable to collect the rounds
+     * of a part of the search (for instance the rounds of a single row),
+     * typically in another thread. The rounds kept by the returned object
+     * must be a superset of the ones this object would keep from the same
+     * part of the search, so that merging them with merge() gives the same
+     * result as adding the rounds directly.
+     * The caller is responsible for deleting the returned object.
+     */
+    virtual Results * createSink() const = 0;
+
+    /**
+     * Add all the rounds kept so far by iOther (in the order they were
+     * kept), as if add() had been called directly on this object.
+     * iOther is expected to be created by createSink().
+     */
+    virtual void merge(const Results &iOther);
+
+    /**
+     * Set the object used to interrupt the next searches or to follow
+     * their progress (see SearchControl), or nullptr. The control is not
+     * owned by the results, and must outlive the searches.
+     */
+    void setControl(SearchControl *iControl) { m_control = iControl; }
+    SearchControl * getControl() const { return m_control; }
+
 protected:
-    vector<Round> m_rounds;
+    vector<PackedRound> m_rounds;
     void sort();
+
+    /// Actual search, called by search() when the cache cannot be used
+    virtual void doSearch(const Dictionary &iDic, const Board &iBoard,
+                          const Rack &iRack, bool iFirstWord) = 0;
+
+    /**
+     * Return a string identifying the kind of results and its parameters,
+     * for the SearchCache. Results giving the same string must keep the
+     * same rounds for a given search.
+     * An empty string means that the results cannot be cached.
+     */
+    virtual string getCacheKey() const { return ""; }
+
+private:
+    SearchControl *m_control{nullptr};
 };
 
 /**
@@ -82,14 +194,32 @@ protected:
 class BestResults: public Results
 {
 public:
-    BestResults() = default;
-    void search(const Dictionary &iDic, const Board &iBoard,
-                        const Rack &iRack, bool iFirstWord) override;
+    BestResults();
+    /// The copies do not share their best score with the original
+    BestResults(const BestResults &iOther);
+    BestResults & operator=(const BestResults &iOther);
     void clear() override;
     void add(const Round &iRound) override;
+    int getMinScore() const override;
+    Results * createSink() const override;
+
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+    string getCacheKey() const override;
 
 private:
     int m_bestScore{0};
+
+    /**
+     * Best score found by this object or by any of its sinks.
+     * It is shared with the sinks (and only with them), so that the
+     * search of a row can skip the rounds which cannot beat the best
+     * score found in the other rows.
+     */
+    shared_ptr<atomic<int>> m_sharedBestScore;
+
+    BestResults(const shared_ptr<atomic<int>> &iSharedBestScore);
 };
 
 /**
@@ -104,10 +234,15 @@ class PercentResults: public Results
 public:
     /** The percentage is given as a float between 0 (0%) and 1 (100%) */
     PercentResults(float iPercent);
-    void search(const Dictionary &iDic, const Board &iBoard,
-                        const Rack &iRack, bool iFirstWord) override;
     void clear() override;
     void add(const Round &iRound) override;
+    int getMinScore() const override { return m_minScore; }
+    Results * createSink() const override;
+
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+    string getCacheKey() const override;
 
 private:
     const float m_percent;
@@ -125,13 +260,17 @@ class LimitResults: public Results
 {
 public:
     LimitResults(int iLimit);
-    void search(const Dictionary &iDic, const Board &iBoard,
-                        const Rack &iRack, bool iFirstWord) override;
     void clear() override;
     void add(const Round &iRound) override;
+    Results * createSink() const override;
 
     void setLimit(int iNewLimit) { m_limit = iNewLimit; }
 
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+    string getCacheKey() const override;
+
 private:
     int m_limit;
     map<int, int> m_scoresCount;
@@ -139,6 +278,70 @@ private:
     int m_minScore{-1};
 };
 
+/**
+ * This implementation keeps the N first rounds, in the order described
+ * above, N being the given limit (which must be positive).
+ * Contrary to LimitResults, the rounds are kept in a heap of capacity N
+ * during the search (the worst kept round being on top), so the memory
+ * used does not depend on the number of rounds found.
+ * Another difference is that the kept rounds do not depend on the order
+ * in which the rounds are found: when several rounds have the score of
+ * the N-th round, LimitResults may ignore some of them depending on the
+ * search order, while this class keeps the first ones in sorted order.
+ */
+class TopResults: public Results
+{
+public:
+    TopResults(unsigned int iLimit);
+    void clear() override;
+    void add(const Round &iRound) override;
+    int getMinScore() const override;
+    Results * createSink() const override;
+
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+    string getCacheKey() const override;
+
+private:
+    const unsigned int m_limit;
+};
+
+/**
+ * This implementation does not keep the rounds found by the search.
+ * It only computes aggregated data about them: the number of rounds,
+ * the number of bingos, and the number of rounds for each score.
+ * Only the best round is kept, so the size() method will always
+ * return 0 (if no round can be played at all) or 1.
+ */
+class StatsResults: public Results
+{
+public:
+    StatsResults() = default;
+    void clear() override;
+    void add(const Round &iRound) override;
+    Results * createSink() const override;
+    void merge(const Results &iOther) override;
+
+    /// Number of rounds found by the search
+    unsigned getNbRounds() const { return m_nbRounds; }
+    /// Number of rounds using all the letters of the rack
+    unsigned getNbBingos() const { return m_nbBingos; }
+    /// Best score (0 if no round was found)
+    int getBestScore() const;
+    /// Number of rounds found for each score
+    const map<int, unsigned> & getScoresCount() const { return m_scoresCount; }
+
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+
+private:
+    unsigned m_nbRounds{0};
+    unsigned m_nbBingos{0};
+    map<int, unsigned> m_scoresCount;
+};
+
 /**
  * This implementation starts with finding the rounds corresponding to the best
  * score, like BestResults would do.
@@ -151,10 +354,15 @@ class MasterResults: public Results
 {
 public:
     MasterResults() = default;
-    void search(const Dictionary &iDic, const Board &iBoard,
-                        const Rack &iRack, bool iFirstWord) override;
     void clear() override;
     void add(const Round &iRound) override;
+    int getMinScore() const override { return m_bestResults.getMinScore(); }
+    Results * createSink() const override;
+
+protected:
+    void doSearch(const Dictionary &iDic, const Board &iBoard,
+                  const Rack &iRack, bool iFirstWord) override;
+    string getCacheKey() const override;
 
 private:
     BestResults m_bestResults;
@@ -0,0 +1,252 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "results_index.h"
+#include "results.h"
+#include "round.h"
+#include "board_grid.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, ResultsIndex);
+
+
+void ResultsIndex::clear()
+{
+    m_words.clear();
+    m_coords.clear();
+    m_points.clear();
+    m_played.clear();
+    m_playedOffsets.clear();
+    m_byWord.clear();
+    m_byPoints.clear();
+    m_byCoord.clear();
+    m_byLetter.clear();
+}
+
+
+void ResultsIndex::build(const Results &iResults)
+{
+    clear();
+
+    const unsigned nbRounds = iResults.size();
+    m_words.reserve(nbRounds);
+    m_coords.reserve(nbRounds);
+    m_points.reserve(nbRounds);
+    m_playedOffsets.reserve(nbRounds + 1);
+    m_byCoord.resize(2 * BOARD_REALDIM * BOARD_REALDIM);
+
+    m_playedOffsets.push_back(0);
+    for (unsigned i = 0; i < nbRounds; ++i)
+    {
+        const Round &round = iResults.get(i);
+        wstring word;
+        for (unsigned j = 0; j < round.getWordLen(); ++j)
+        {
+            word += round.getTile(j).toUpper().toChar();
+            if (round.isPlayedFromRack(j))
+            {
+                const Tile &tile = round.isJoker(j) ? Tile::Joker() : round.getTile(j);
+                m_played.push_back(getLetterCode(tile));
+            }
+        }
+        m_words.push_back(word);
+        m_points.push_back(round.getPoints());
+        const unsigned coordKey = getCoordKey(round.getCoord());
+        m_coords.push_back(coordKey);
+        m_byCoord[coordKey].push_back(i);
+
+        // Posting lists of the played tiles. The rounds are processed
+        // in increasing order, so the lists are sorted.
+        const auto begin = m_played.begin() + m_playedOffsets.back();
+        std::sort(begin, m_played.end());
+        for (auto it = begin; it != m_played.end(); )
+        {
+            const unsigned code = *it;
+            const unsigned count = std::upper_bound(it, m_played.end(), *it) - it;
+            if (m_byLetter.size() <= code)
+                m_byLetter.resize(code + 1);
+            if (m_byLetter[code].size() < count)
+                m_byLetter[code].resize(count);
+            for (unsigned n = 0; n < count; ++n)
+                m_byLetter[code][n].push_back(i);
+            it += count;
+        }
+        m_playedOffsets.push_back(m_played.size());
+    }
+
+    m_byWord.resize(nbRounds);
+    m_byPoints.resize(nbRounds);
+    for (unsigned i = 0; i < nbRounds; ++i)
+    {
+        m_byWord[i] = i;
+        m_byPoints[i] = i;
+    }
+    std::sort(m_byWord.begin(), m_byWord.end(),
+              [this](unsigned a, unsigned b) { return m_words[a] < m_words[b]; });
+    // The results are normally already sorted by points,
+    // the sort is only a safety net
+    std::stable_sort(m_byPoints.begin(), m_byPoints.end(),
+                     [this](unsigned a, unsigned b) { return m_points[a] > m_points[b]; });
+
+    LOG_DEBUG("Indexed {} rounds", nbRounds);
+}
+
+
+unsigned ResultsIndex::getCoordKey(const Coord &iCoord)
+{
+    ASSERT(iCoord.isValid(), "Invalid coordinates");
+    const unsigned dir = iCoord.getDir() == Coord::HORIZONTAL ? 1 : 0;
+    return (dir * BOARD_REALDIM + iCoord.getRow()) * BOARD_REALDIM + iCoord.getCol();
+}
+
+
+unsigned ResultsIndex::getLetterCode(const Tile &iTile)
+{
+    return iTile.isJoker() ? Tile::Joker().toCode() : iTile.toCode();
+}
+
+
+ResultsIndex::Range ResultsIndex::findPrefix(const wstring &iPrefix) const
+{
+    // The words starting with the prefix are contiguous in m_byWord
+    const size_t len = iPrefix.size();
+    const auto begin = std::partition_point(
+        m_byWord.begin(), m_byWord.end(),
+        [&](unsigned i) { return m_words[i].compare(0, len, iPrefix) < 0; });
+    const auto end = std::partition_point(
+        begin, m_byWord.end(),
+        [&](unsigned i) { return m_words[i].compare(0, len, iPrefix) == 0; });
+    return Range{m_byWord.data() + (begin - m_byWord.begin()),
+                 m_byWord.data() + (end - m_byWord.begin())};
+}
+
+
+ResultsIndex::Range ResultsIndex::findPoints(int iMin, int iMax) const
+{
+    // m_byPoints is sorted by decreasing points
+    auto begin = m_byPoints.begin();
+    auto end = m_byPoints.end();
+    if (iMax >= 0)
+    {
+        begin = std::partition_point(begin, end,
+                                     [&](unsigned i) { return m_points[i] > iMax; });
+    }
+    if (iMin >= 0)
+    {
+        end = std::partition_point(begin, end,
+                                   [&](unsigned i) { return m_points[i] >= iMin; });
+    }
+    return Range{m_byPoints.data() + (begin - m_byPoints.begin()),
+                 m_byPoints.data() + (end - m_byPoints.begin())};
+}
+
+
+ResultsIndex::Range ResultsIndex::findCoord(const Coord &iCoord) const
+{
+    const vector<unsigned> &rounds = m_byCoord[getCoordKey(iCoord)];
+    return Range{rounds.data(), rounds.data() + rounds.size()};
+}
+
+
+ResultsIndex::Range ResultsIndex::findLetter(unsigned iCode, unsigned iCount) const
+{
+    if (iCode >= m_byLetter.size() || iCount > m_byLetter[iCode].size())
+        return Range();
+    const vector<unsigned> &rounds = m_byLetter[iCode][iCount - 1];
+    return Range{rounds.data(), rounds.data() + rounds.size()};
+}
+
+
+bool ResultsIndex::matches(unsigned iIndex, const Query &iQuery,
+                           const vector<unsigned> &iLetterCounts) const
+{
+    if (!iQuery.prefix.empty() &&
+        m_words[iIndex].compare(0, iQuery.prefix.size(), iQuery.prefix) != 0)
+    {
+        return false;
+    }
+    if (iQuery.coord.isValid() && m_coords[iIndex] != getCoordKey(iQuery.coord))
+        return false;
+    if (iQuery.minPoints >= 0 && m_points[iIndex] < iQuery.minPoints)
+        return false;
+    if (iQuery.maxPoints >= 0 && m_points[iIndex] > iQuery.maxPoints)
+        return false;
+
+    // The played codes of a round are sorted
+    const auto begin = m_played.begin() + m_playedOffsets[iIndex];
+    const auto end = m_played.begin() + m_playedOffsets[iIndex + 1];
+    for (unsigned code = 0; code < iLetterCounts.size(); ++code)
+    {
+        if (iLetterCounts[code] == 0)
+            continue;
+        const auto range = std::equal_range(begin, end, code);
+        if (static_cast<unsigned>(range.second - range.first) < iLetterCounts[code])
+            return false;
+    }
+    return true;
+}
+
+
+vector<unsigned> ResultsIndex::find(const Query &iQuery) const
+{
+    if (m_words.empty())
+        return vector<unsigned>();
+
+    // Collect the candidates given by each criterion, and keep the smallest set
+    vector<Range> ranges;
+    ranges.push_back(Range{m_byPoints.data(), m_byPoints.data() + m_byPoints.size()});
+    if (!iQuery.prefix.empty())
+        ranges.push_back(findPrefix(iQuery.prefix));
+    if (iQuery.minPoints >= 0 || iQuery.maxPoints >= 0)
+        ranges.push_back(findPoints(iQuery.minPoints, iQuery.maxPoints));
+    if (iQuery.coord.isValid())
+        ranges.push_back(findCoord(iQuery.coord));
+
+    vector<unsigned> letterCounts;
+    for (const Tile &tile : iQuery.letters)
+    {
+        const unsigned code = getLetterCode(tile);
+        if (letterCounts.size() <= code)
+            letterCounts.resize(code + 1, 0);
+        ++letterCounts[code];
+    }
+    for (unsigned code = 0; code < letterCounts.size(); ++code)
+    {
+        if (letterCounts[code] > 0)
+            ranges.push_back(findLetter(code, letterCounts[code]));
+    }
+
+    const Range &smallest = *std::min_element(
+        ranges.begin(), ranges.end(),
+        [](const Range &a, const Range &b) { return a.size() < b.size(); });
+
+    vector<unsigned> found;
+    for (const unsigned *it = smallest.begin; it != smallest.end; ++it)
+    {
+        if (matches(*it, iQuery, letterCounts))
+            found.push_back(*it);
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
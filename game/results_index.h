@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef RESULTS_INDEX_H_
+#define RESULTS_INDEX_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "coord.h"
+#include "tile.h"
+#include "logging.h"
+
+using namespace std;
+
+class Results;
+class Round;
+
+
+/**
+ * Index on the rounds of a Results object, to filter them quickly.
+ * It is meant for the complete list of the rounds playable with a rack
+ * (which can contain tens of thousands of rounds), when the filter is
+ * changed interactively.
+ *
+ * The rounds are indexed by:
+ *  - word, sorted alphabetically, to find the words with a given prefix;
+ *  - coordinates, with a list of rounds for each square and direction;
+ *  - points, sorted by decreasing values, to find a range of scores;
+ *  - letters played from the rack: for each tile and each count n,
+ *    the list of the rounds using at least n times this tile.
+ * A query starts with the smallest list of candidates given by the
+ * indexes, and checks the other criteria on each candidate only, so its
+ * cost depends on the number of matching rounds rather than on the total
+ * number of rounds.
+ *
+ * The index refers to the rounds by their position in the Results object,
+ * so it must be rebuilt whenever the results change.
+ */
+class ResultsIndex
+{
+    DEFINE_LOGGER();
+public:
+    /// Criteria of a query. The default values match all the rounds.
+    struct Query
+    {
+        /// Prefix of the word, in uppercase (jokers are not distinguished)
+        wstring prefix;
+        /// Coordinates of the round (ignored if invalid)
+        Coord coord;
+        /// Range of points (bounds included, negative for no bound)
+        int minPoints{-1};
+        int maxPoints{-1};
+        /// Tiles which must be played from the rack (with repetitions)
+        vector<Tile> letters;
+    };
+
+    /// Index the rounds of the given results
+    void build(const Results &iResults);
+
+    void clear();
+
+    unsigned size() const { return m_words.size(); }
+
+    /**
+     * Return the positions (in the indexed Results object) of the rounds
+     * matching all the criteria of the query, in increasing order
+     */
+    vector<unsigned> find(const Query &iQuery) const;
+
+private:
+    /// Word of each round, in uppercase
+    vector<wstring> m_words;
+    /// Packed coordinates of each round (see getCoordKey())
+    vector<uint16_t> m_coords;
+    /// Points of each round
+    vector<int> m_points;
+    /// Codes of the tiles played from the rack, for round i they are
+    /// between m_playedOffsets[i] and m_playedOffsets[i + 1]
+    vector<uint8_t> m_played;
+    vector<unsigned> m_playedOffsets;
+
+    /// Rounds sorted by word
+    vector<unsigned> m_byWord;
+    /// Rounds sorted by decreasing points
+    vector<unsigned> m_byPoints;
+    /// Rounds for each packed coordinates, in increasing order
+    vector<vector<unsigned>> m_byCoord;
+    /// m_byLetter[code][n] contains the rounds playing at least n + 1
+    /// times the tile with the given code, in increasing order
+    vector<vector<vector<unsigned>>> m_byLetter;
+
+    /// Candidates given by one of the indexes
+    struct Range
+    {
+        const unsigned *begin{nullptr};
+        const unsigned *end{nullptr};
+        size_t size() const { return end - begin; }
+    };
+
+    static unsigned getCoordKey(const Coord &iCoord);
+    static unsigned getLetterCode(const Tile &iTile);
+
+    Range findPrefix(const wstring &iPrefix) const;
+    Range findPoints(int iMin, int iMax) const;
+    Range findCoord(const Coord &iCoord) const;
+    Range findLetter(unsigned iCode, unsigned iCount) const;
+
+    /// Check all the criteria of the query on the given round
+    bool matches(unsigned iIndex, const Query &iQuery,
+                 const vector<unsigned> &iLetterCounts) const;
+};
+
+#endif
+
@@ -20,6 +20,7 @@
  *****************************************************************************/
 
 #include <string>
+#include <algorithm>
 #include "tile.h"
 #include "round.h"
 #include "encoding.h"
@@ -37,79 +38,83 @@ Round::Round()
 
 void Round::setWord(const vector<Tile> &iTiles)
 {
-    m_word = iTiles;
+    ASSERT(iTiles.size() <= kMaxLen, "Word too long");
+    m_len = iTiles.size();
+    std::ranges::copy(iTiles, m_word);
     // XXX: always from rack?
-    m_rackOrigin = vector<bool>(iTiles.size(), true);
+    m_rackOrigin = (1 << m_len) - 1;
 }
 
 
 void Round::setTile(unsigned int iIndex, const Tile &iTile)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_len, "Invalid index");
     m_word[iIndex] = iTile;
 }
 
 
 void Round::setFromRack(unsigned int iIndex)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-    m_rackOrigin[iIndex] = true;
+    ASSERT(iIndex < m_len, "Invalid index");
+    m_rackOrigin |= 1 << iIndex;
 }
 
 
 void Round::setFromBoard(unsigned int iIndex)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-    m_rackOrigin[iIndex] = false;
+    ASSERT(iIndex < m_len, "Invalid index");
+    m_rackOrigin &= ~(1 << iIndex);
 }
 
 
 bool Round::isJoker(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_len, "Invalid index");
      return m_word[iIndex].isJoker();
 }
 
 
 const Tile& Round::getTile(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_len, "Invalid index");
      return m_word[iIndex];
 }
 
 
 bool Round::isPlayedFromRack(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-     return m_rackOrigin[iIndex];
+    ASSERT(iIndex < m_len, "Invalid index");
+     return m_rackOrigin & (1 << iIndex);
 }
 
 
 void Round::addRightFromBoard(const Tile &iTile)
 {
+    ASSERT(m_len < kMaxLen, "Word too long");
     // The call to toUpper() is necessary to avoid that a joker
     // on the board appears as a joker in the Round
-    m_word.push_back(iTile.toUpper());
-    m_rackOrigin.push_back(false);
+    m_word[m_len] = iTile.toUpper();
+    ++m_len;
 }
 
 
 void Round::addRightFromRack(const Tile &iTile, bool iJoker)
 {
+    ASSERT(m_len < kMaxLen, "Word too long");
     if (iJoker)
-        m_word.push_back(iTile.toLower());
+        m_word[m_len] = iTile.toLower();
     else
-        m_word.push_back(iTile);
-    m_rackOrigin.push_back(true);
+        m_word[m_len] = iTile;
+    m_rackOrigin |= 1 << m_len;
+    ++m_len;
 }
 
 
 void Round::removeRight()
 {
-    ASSERT(!m_word.empty() && !m_rackOrigin.empty(),
-           "Trying to remove tiles that were never added");
-    m_word.pop_back();
-    m_rackOrigin.pop_back();
+    ASSERT(m_len > 0, "Trying to remove tiles that were never added");
+    --m_len;
+    m_rackOrigin &= ~(1 << m_len);
 }
 
 
@@ -154,7 +159,7 @@ wstring Round::toString() const
 
 bool Round::operator==(const Round &iOther) const
 {
-    return m_word == iOther.m_word
+    return std::ranges::equal(getTiles(), iOther.getTiles())
         && m_rackOrigin == iOther.m_rackOrigin
         && m_coord == iOther.m_coord
         && m_points == iOther.m_points
@@ -23,6 +23,8 @@
 #define ROUND_H_
 
 #include <vector>
+#include <span>
+#include <stdint.h>
 #include "tile.h"
 #include "coord.h"
 #include "logging.h"
@@ -40,6 +42,11 @@ class Round
 {
     DEFINE_LOGGER();
 public:
+    /**
+     * Maximum number of tiles in a round. The tiles are stored inline,
+     * so that building a round does not allocate any memory.
+     */
+    static const unsigned int kMaxLen = 15;
 
     Round();
 
@@ -68,10 +75,10 @@ public:
     const Tile& getTile  (unsigned int iIndex) const;
 
     wstring getWord() const;
-    unsigned int getWordLen() const { return m_word.size(); }
+    unsigned int getWordLen() const { return m_len; }
     int getPoints() const           { return m_points; }
     bool getBonus() const           { return m_bonus; }
-    const vector<Tile> &getTiles() const { return m_word; }
+    std::span<const Tile> getTiles() const { return {m_word, m_len}; }
 
     unsigned countJokersFromRack() const;
 
@@ -88,8 +95,10 @@ public:
     bool operator==(const Round &iOther) const;
 
 private:
-    vector<Tile> m_word;
-    vector<bool> m_rackOrigin;
+    Tile m_word[kMaxLen];
+    unsigned int m_len{0};
+    /// Bit i is set if the tile i is played from the rack
+    uint16_t m_rackOrigin{0};
     Coord m_coord;
     int m_points{0};
     bool m_bonus{false};
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <functional>
+
+#include "search_cache.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, SearchCache);
+
+std::atomic<SearchCache*> SearchCache::m_instance{nullptr};
+std::mutex SearchCache::m_instanceMutex;
+
+// Default number of searches kept in the cache
+static const unsigned kDefaultCapacity = 64;
+// Default total number of rounds kept in the cache (about 40 MB)
+static const size_t kDefaultMaxRounds = 1000000;
+
+
+SearchCache & SearchCache::Instance()
+{
+    SearchCache *instance = m_instance.load(std::memory_order_acquire);
+    if (instance == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_instanceMutex);
+        instance = m_instance.load(std::memory_order_relaxed);
+        if (instance == nullptr)
+        {
+            instance = new SearchCache(kDefaultCapacity, kDefaultMaxRounds);
+            m_instance.store(instance, std::memory_order_release);
+        }
+    }
+    return *instance;
+}
+
+
+void SearchCache::Destroy()
+{
+    std::lock_guard<std::mutex> lock(m_instanceMutex);
+    delete m_instance.exchange(nullptr);
+}
+
+
+SearchCache::SearchCache(unsigned iCapacity, size_t iMaxRounds)
+    : m_capacity(iCapacity), m_maxRounds(iMaxRounds)
+{
+}
+
+
+size_t SearchCache::KeyHash::operator()(const Key &iKey) const
+{
+    size_t hash = std::hash<uint64_t>()(iKey.boardHash ^ iKey.dicSignature);
+    hash = hash * 31 + std::hash<const Dictionary*>()(iKey.dic);
+    hash = hash * 31 + std::hash<wstring>()(iKey.rack);
+    hash = hash * 31 + std::hash<string>()(iKey.results);
+    return hash * 2 + iKey.firstWord;
+}
+
+
+bool SearchCache::lookup(const Key &iKey, vector<PackedRound> &oRounds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(iKey);
+    if (it == m_index.end())
+        return false;
+
+    // Mark the entry as the most recently used one
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    oRounds = it->second->second;
+    return true;
+}
+
+
+void SearchCache::store(const Key &iKey, const vector<PackedRound> &iRounds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Storing the search would evict all the others, and it could not
+    // even fit itself
+    if (m_capacity == 0 || iRounds.size() > m_maxRounds)
+        return;
+
+    auto it = m_index.find(iKey);
+    if (it != m_index.end())
+    {
+        // Another thread performed the same search in the meantime
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    m_entries.emplace_front(iKey, iRounds);
+    m_index.emplace(iKey, m_entries.begin());
+    m_nbRounds += iRounds.size();
+    shrink();
+}
+
+
+void SearchCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+    m_nbRounds = 0;
+}
+
+
+void SearchCache::setCapacity(unsigned iCapacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = iCapacity;
+    shrink();
+}
+
+
+void SearchCache::setMaxRounds(size_t iMaxRounds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxRounds = iMaxRounds;
+    shrink();
+}
+
+
+void SearchCache::shrink()
+{
+    while (m_entries.size() > m_capacity || m_nbRounds > m_maxRounds)
+    {
+        m_nbRounds -= m_entries.back().second.size();
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SEARCH_CACHE_H_
+#define SEARCH_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+#include "results.h"
+#include "logging.h"
+
+using namespace std;
+
+class Dictionary;
+
+
+/**
+ * Cache of the rounds found by the most recent searches, so that
+ * repeating a search on an unchanged position is only a lookup.
+ * It implements the Singleton pattern.
+ *
+ * A search is identified by the dictionary, the board (through its
+ * hash, which also covers the game parameters used by the search),
+ * the rack, and the kind of results (see Results::getCacheKey()).
+ * The cache is limited both by the number of searches and by the total
+ * number of stored rounds, since a single unlimited search can find tens
+ * of thousands of rounds. When one of the limits is reached, the least
+ * recently used searches are forgotten, and a search which would exceed
+ * the limit of rounds on its own is not stored at all.
+ *
+ * The cache can be used from several threads at the same time.
+ */
+class SearchCache
+{
+    DEFINE_LOGGER();
+public:
+    /// Access to the singleton (it can be created by any thread)
+    static SearchCache& Instance();
+    /**
+     * Destroy the singleton cleanly.
+     * No other thread may be using the cache at this time.
+     */
+    static void Destroy();
+
+    /// Identification of a search
+    struct Key
+    {
+        /// The address alone is not enough, because another
+        /// dictionary could be loaded at the same address later
+        const Dictionary *dic;
+        uint64_t dicSignature;
+        uint64_t boardHash;
+        wstring rack;
+        bool firstWord;
+        string results;
+
+        bool operator==(const Key &iOther) const = default;
+    };
+
+    /**
+     * Copy in oRounds the rounds stored for the given search, and
+     * return true. If the search is not in the cache, return false
+     * without modifying oRounds.
+     */
+    bool lookup(const Key &iKey, vector<PackedRound> &oRounds);
+
+    /// Store the rounds found by the given search
+    void store(const Key &iKey, const vector<PackedRound> &iRounds);
+
+    /// Forget all the searches
+    void clear();
+
+    /// Set the maximum number of searches kept in the cache
+    void setCapacity(unsigned iCapacity);
+    unsigned getCapacity() const { return m_capacity; }
+
+    /// Set the maximum total number of rounds kept in the cache
+    void setMaxRounds(size_t iMaxRounds);
+    size_t getMaxRounds() const { return m_maxRounds; }
+
+private:
+    /// Singleton instance
+    static std::atomic<SearchCache*> m_instance;
+    /// Protect the creation of the singleton
+    static std::mutex m_instanceMutex;
+    SearchCache(unsigned iCapacity, size_t iMaxRounds);
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &iKey) const;
+    };
+
+    typedef pair<Key, vector<PackedRound>> Entry;
+
+    /// Protect the fields below
+    mutable std::mutex m_mutex;
+
+    unsigned m_capacity;
+    size_t m_maxRounds;
+
+    /// Total number of rounds in m_entries
+    size_t m_nbRounds{0};
+
+    /// Cached searches, the most recently used first
+    list<Entry> m_entries;
+    unordered_map<Key, list<Entry>::iterator, KeyHash> m_index;
+
+    void shrink();
+};
+
+#endif
+
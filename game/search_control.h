@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SEARCH_CONTROL_H_
+#define SEARCH_CONTROL_H_
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+class Results;
+
+using std::function;
+
+
+/**
+ * Allows to interrupt a search running in another thread, and to follow
+ * its progress. It is given to the searched Results object with
+ * Results::setControl().
+ *
+ * The board is searched row by row (in both directions), and the rounds
+ * found in each row are given to the progress callback as soon as the
+ * row is done, possibly from several threads (the calls are serialized).
+ * The rounds of a row are a superset of the ones which will be kept in
+ * the final results, and they are not sorted.
+ *
+ * When the search is cancelled, it stops at the next anchor: the
+ * results then only contain some of the rounds, and they are not stored
+ * in the SearchCache.
+ */
+class SearchControl
+{
+public:
+    typedef function<void(const Results &)> ProgressCallback;
+
+    explicit SearchControl(ProgressCallback iCallback = nullptr)
+        : m_callback(std::move(iCallback)) {}
+
+    /// Interrupt the search (can be called from any thread)
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    /// Called by the search with the rounds of a part of the board
+    void notifyProgress(const Results &iPartialResults)
+    {
+        if (m_callback == nullptr || isCancelled())
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_callback(iPartialResults);
+    }
+
+private:
+    std::atomic<bool> m_cancelled{false};
+    ProgressCallback m_callback;
+    std::mutex m_mutex;
+};
+
+#endif
+
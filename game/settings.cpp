@@ -217,6 +217,10 @@ Settings::Settings()
     // not get a second chance
     dupli.add("reject-invalid", Setting::TypeBoolean) = true;
 
+    // If true, the master move is also chosen according to the extensions
+    // and benjamins it offers (in all the modes using a master move)
+    dupli.add("master-heuristics", Setting::TypeBoolean) = false;
+
     // ============== Freegame mode options ==============
     Setting &freegame = m_conf->getRoot().add("freegame", Setting::TypeGroup);
 
@@ -227,6 +231,10 @@ Settings::Settings()
     // be rejected in any case.
     freegame.add("reject-invalid", Setting::TypeBoolean) = true;
 
+    // Time given to the AI players to solve the end of the game, once the
+    // bag is empty (in milliseconds). 0 disables the endgame solver.
+    freegame.add("endgame-time", Setting::TypeInt) = 0;
+
     // ============== Arbitration mode options ==============
     Setting &arbitration = m_conf->getRoot().add("arbitration", Setting::TypeGroup);
 
@@ -274,7 +282,9 @@ Settings::Settings()
         copySetting<int>(tmpConf, *m_conf, "duplicate.solo-players");
         copySetting<int>(tmpConf, *m_conf, "duplicate.solo-value");
         copySetting<bool>(tmpConf, *m_conf, "duplicate.reject-invalid");
+        copySetting<bool>(tmpConf, *m_conf, "duplicate.master-heuristics");
         copySetting<bool>(tmpConf, *m_conf, "freegame.reject-invalid");
+        copySetting<int>(tmpConf, *m_conf, "freegame.endgame-time");
         copySetting<bool>(tmpConf, *m_conf, "arbitration.fill-rack");
         copySetting<int>(tmpConf, *m_conf, "arbitration.search-limit");
         copySetting<bool>(tmpConf, *m_conf, "arbitration.solo-auto");
@@ -337,6 +347,8 @@ bool Settings::getBool(const string &iName) const
     }
 #else
     // Dummy implementation
+    if (iName == "duplicate.master-heuristics")
+        return false;
     return true;
 #endif
 }
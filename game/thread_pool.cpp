@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "thread_pool.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, ThreadPool);
+
+std::atomic<ThreadPool*> ThreadPool::m_instance{nullptr};
+std::mutex ThreadPool::m_instanceMutex;
+
+// True when the current thread is running tasks of a batch
+static thread_local bool t_inBatch = false;
+
+
+ThreadPool & ThreadPool::Instance()
+{
+    ThreadPool *instance = m_instance.load(std::memory_order_acquire);
+    if (instance == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_instanceMutex);
+        instance = m_instance.load(std::memory_order_relaxed);
+        if (instance == nullptr)
+        {
+            unsigned nbThreads = std::thread::hardware_concurrency();
+            instance = new ThreadPool(nbThreads > 1 ? nbThreads - 1 : 0);
+            m_instance.store(instance, std::memory_order_release);
+        }
+    }
+    return *instance;
+}
+
+
+void ThreadPool::Destroy()
+{
+    std::lock_guard<std::mutex> lock(m_instanceMutex);
+    delete m_instance.exchange(nullptr);
+}
+
+
+ThreadPool::ThreadPool(unsigned iNbWorkers)
+{
+    LOG_DEBUG("Starting {} worker threads", iNbWorkers);
+    for (unsigned i = 0; i < iNbWorkers; ++i)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (std::thread &worker : m_workers)
+        worker.join();
+}
+
+
+void ThreadPool::run(unsigned iNbTasks, const function<void(unsigned)> &iTask)
+{
+    // Run the tasks sequentially if there is nothing to gain,
+    // or if the pool is already busy
+    std::unique_lock<std::mutex> batchLock(m_batchMutex, std::defer_lock);
+    if (m_workers.empty() || iNbTasks < 2 || t_inBatch || !batchLock.try_lock())
+    {
+        for (unsigned i = 0; i < iNbTasks; ++i)
+            iTask(i);
+        return;
+    }
+
+    // Publish the new batch
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &iTask;
+        m_nbTasks = iNbTasks;
+        m_nextTask = 0;
+        m_exception = nullptr;
+        m_busyWorkers = m_workers.size();
+        ++m_generation;
+    }
+    m_wakeUp.notify_all();
+
+    // Help the workers
+    processTasks();
+
+    // Wait until all the workers are done with this batch
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_batchDone.wait(lock, [this]{ return m_busyWorkers == 0; });
+        m_task = nullptr;
+        exception = m_exception;
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+
+void ThreadPool::processTasks()
+{
+    t_inBatch = true;
+    for (unsigned i = m_nextTask++; i < m_nbTasks; i = m_nextTask++)
+    {
+        try
+        {
+            (*m_task)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception)
+                m_exception = std::current_exception();
+        }
+    }
+    t_inBatch = false;
+}
+
+
+void ThreadPool::workerLoop()
+{
+    unsigned lastGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [&]{ return m_stopping || m_generation != lastGeneration; });
+            if (m_stopping)
+                return;
+            lastGeneration = m_generation;
+        }
+
+        processTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ASSERT(m_busyWorkers > 0, "Bug in ThreadPool");
+            --m_busyWorkers;
+        }
+        m_batchDone.notify_one();
+    }
+}
+
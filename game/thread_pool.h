@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+#include "logging.h"
+
+using std::vector;
+using std::function;
+
+
+/**
+ * Small pool of worker threads, used to split CPU-bound computations
+ * (such as the search of the rounds on the board) into independent tasks.
+ * It implements the Singleton pattern.
+ *
+ * The pool only runs one batch of tasks at a time: when a batch is
+ * submitted while another one is running (from another thread, or from
+ * one of the tasks itself), the new batch is simply run sequentially
+ * by the calling thread. This keeps nested or concurrent uses safe,
+ * without any risk of deadlock.
+ */
+class ThreadPool
+{
+    DEFINE_LOGGER();
+public:
+    /// Access to the singleton (it can be created by any thread)
+    static ThreadPool& Instance();
+    /**
+     * Destroy the singleton cleanly.
+     * No other thread may be using the pool at this time.
+     */
+    static void Destroy();
+
+    ~ThreadPool();
+
+    /**
+     * Return the number of threads working on a batch of tasks,
+     * including the calling thread. A value of 1 means that all
+     * the tasks are run sequentially.
+     */
+    unsigned getNbThreads() const { return m_workers.size() + 1; }
+
+    /**
+     * Call iTask(i) for each i in [0, iNbTasks), possibly in parallel,
+     * and return when all the calls are finished.
+     * The calling thread takes part in the work.
+     * If one of the tasks throws an exception, the first one caught
+     * is rethrown once the batch is finished.
+     */
+    void run(unsigned iNbTasks, const function<void(unsigned)> &iTask);
+
+private:
+    /// Singleton instance
+    static std::atomic<ThreadPool*> m_instance;
+    /// Protect the creation of the singleton
+    static std::mutex m_instanceMutex;
+    ThreadPool(unsigned iNbWorkers);
+
+    vector<std::thread> m_workers;
+
+    /// Serialize the batches submitted to the pool
+    std::mutex m_batchMutex;
+
+    /// Protect the fields below
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_batchDone;
+    bool m_stopping{false};
+    /// Incremented for each new batch, to wake up the workers
+    unsigned m_generation{0};
+    /// Number of workers still busy with the current batch
+    unsigned m_busyWorkers{0};
+
+    /// Current batch
+    const function<void(unsigned)> *m_task{nullptr};
+    unsigned m_nbTasks{0};
+    std::atomic<unsigned> m_nextTask{0};
+    std::exception_ptr m_exception;
+
+    void workerLoop();
+    void processTasks();
+};
+
+#endif
+
@@ -59,6 +59,11 @@ public:
     int play(const wstring &iCoord, const wstring &iWord) override;
 
     void search();
+    /**
+     * Use the results of a search done outside of the game (typically
+     * in another thread), for the current rack and board
+     */
+    void setResults(const LimitResults &iResults) { m_results = iResults; }
     const Results& getResults() const { return m_results; }
     int playResult(unsigned int iResultIndex);
 
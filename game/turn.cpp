@@ -79,6 +79,16 @@ void Turn::partialUndo()
 }
 
 
+void Turn::markExecuted(bool iExecuted)
+{
+    for (Command *cmd : m_commands)
+    {
+        cmd->markExecuted(iExecuted);
+    }
+    m_firstNotExecuted = iExecuted ? m_commands.size() : 0;
+}
+
+
 void Turn::dropNonExecutedCommands()
 {
     if (!isFullyExecuted())
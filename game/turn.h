@@ -106,6 +106,13 @@ class Turn
         /// Undo all the non AE commands, to reach the "isPartiallyExecuted" state
         void partialUndo();
 
+        /**
+         * Mark all the commands as executed (or not executed), without
+         * executing or undoing them. This is only valid when the state of
+         * the game has been restored accordingly (see Navigation).
+         */
+        void markExecuted(bool iExecuted);
+
         /// Drop the non-executed commands. Use it with care...
         void dropNonExecutedCommands();
 
@@ -39,6 +39,9 @@
 #include "freegame.h"
 #include "player.h"
 #include "ai_percent.h"
+#include "ai_leave.h"
+#include "ai_montecarlo.h"
+#include "leave_table.h"
 #include "encoding.h"
 #include "cmd/game_rack_cmd.h"
 #include "cmd/game_move_cmd.h"
@@ -133,7 +136,7 @@ static Game* createGame(const pugi::xml_node& gameNode, const Dictionary& iDic)
 }
 
 
-static Player* createPlayer(const pugi::xml_node& playerNode)
+static Player* createPlayer(const pugi::xml_node& playerNode, const Dictionary& iDic)
 {
     string playerId = playerNode.attribute("id").value();
 
@@ -144,7 +147,43 @@ static Player* createPlayer(const pugi::xml_node& playerNode)
     else if (playerType == "computer")
     {
         int level = toInt(playerNode.child_value("Level"));
-        p = new AIPercent(0.01 * level);
+        shared_ptr<const LeaveTable> leaves;
+        string leaveTable = playerNode.child_value("LeaveTable");
+        if (leaveTable != "")
+        {
+            try
+            {
+                leaves = std::make_shared<const LeaveTable>(leaveTable, iDic);
+            }
+            catch (const GameException &)
+            {
+                // The table is not available anymore: fall back
+                // to the usual AI, to be able to load the game anyway
+            }
+        }
+        const pugi::xml_node mcNode = playerNode.child("MonteCarlo");
+        if (mcNode)
+        {
+            const int nbCandidates = toInt(mcNode.attribute("candidates").value());
+            const int nbPlies = toInt(mcNode.attribute("plies").value());
+            const int timeBudget = toInt(mcNode.attribute("time").value());
+            const int maxIterations = toInt(mcNode.attribute("iterations").value());
+            if (nbCandidates <= 0 || nbPlies < 0 || timeBudget < 0 || maxIterations < 0 ||
+                (timeBudget == 0 && maxIterations == 0))
+            {
+                throw LoadGameException(_("Invalid Monte-Carlo parameters"));
+            }
+            AIMonteCarlo::Params params;
+            params.nbCandidates = nbCandidates;
+            params.nbPlies = nbPlies;
+            params.timeBudget = timeBudget;
+            params.maxIterations = maxIterations;
+            p = new AIMonteCarlo(params, leaves);
+        }
+        else if (leaves)
+            p = new AILeave(leaves);
+        else
+            p = new AIPercent(0.01 * level);
     }
     else
         throw LoadGameException(_fmt(_("Invalid player type: {0}"), playerType));
@@ -251,7 +290,7 @@ Game * XmlReader::read(const string &iFileName, const Dictionary &iDic)
 
     map<unsigned int, Player*> all_players;
     for (pugi::xml_node playerNode : gameNode.children("Player")) {
-        Player *player = createPlayer(playerNode);
+        Player *player = createPlayer(playerNode, iDic);
         if (all_players.find(player->getId()) != all_players.end())
             throw LoadGameException(_fmt(_("A player ID must be unique: {0}"), player->getId()));
         all_players[player->getId()] = player;
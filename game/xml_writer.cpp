@@ -40,6 +40,9 @@
 #include "game.h"
 #include "player.h"
 #include "ai_percent.h"
+#include "ai_leave.h"
+#include "ai_montecarlo.h"
+#include "leave_table.h"
 #include "game_exception.h"
 #include "turn.h"
 #include "cmd/game_rack_cmd.h"
@@ -173,9 +176,30 @@ void XmlWriter::write(const Game& iGame, const std::string& iFileName)
         if (!player.isHuman())
         {
             const auto *ai = dynamic_cast<const AIPercent *>(&player);
-            if (ai == nullptr)
+            const auto *aiLeave = dynamic_cast<const AILeave *>(&player);
+            if (ai != nullptr)
+                pNode.append_child("Level").text().set(std::to_string(lrint(ai->getPercent() * 100)));
+            else if (aiLeave != nullptr)
+            {
+                // The level is used if the leave table cannot be loaded
+                pNode.append_child("Level").text().set("100");
+                pNode.append_child("LeaveTable").text().set(aiLeave->getLeaveTable().getFileName());
+            }
+            else if (const auto *aiMC = dynamic_cast<const AIMonteCarlo *>(&player))
+            {
+                // The level is used by the versions not knowing this AI
+                pNode.append_child("Level").text().set("100");
+                const AIMonteCarlo::Params &params = aiMC->getParams();
+                pugi::xml_node mcNode = pNode.append_child("MonteCarlo");
+                mcNode.append_attribute("candidates").set_value(params.nbCandidates);
+                mcNode.append_attribute("plies").set_value(params.nbPlies);
+                mcNode.append_attribute("time").set_value(params.timeBudget);
+                mcNode.append_attribute("iterations").set_value(params.maxIterations);
+                if (aiMC->getLeaveTable() != nullptr)
+                    pNode.append_child("LeaveTable").text().set(aiMC->getLeaveTable()->getFileName());
+            }
+            else
                 throw SaveGameException(_fmt(_("Invalid player type for player %1%"), i));
-            pNode.append_child("Level").text().set(std::to_string(lrint(ai->getPercent() * 100)));
         }
         pNode.append_child("TableNb").text().set(std::to_string(player.getTableNb()));
     }
@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <algorithm>
+
 #include <QStandardItemModel>
 #include <QSortFilterProxyModel>
 #include <QMenu>
@@ -32,11 +34,14 @@
 #include "play_word_mediator.h"
 #include "custom_popup.h"
 #include "play_model.h"
+#include "search_service.h"
 
 #include "public_game.h"
+#include "board.h"
 #include "player.h"
 #include "rack.h"
 #include "results.h"
+#include "results_index.h"
 #include "settings.h"
 #include "game_params.h"
 #include "dic.h"
@@ -53,6 +58,51 @@ static const int TYPE_ADDED = 2; // The result can be valid or invalid, it was m
 INIT_LOGGER(qt, ArbitrationWidget);
 
 
+/**
+ * Proxy model filtering the search results with the rows found by
+ * a ResultsIndex query, so that changing the filter does not require
+ * matching a string against every row.
+ * The rows of the manually added moves (after the search results) are
+ * always accepted.
+ */
+class ResultsFilterProxy: public QSortFilterProxyModel
+{
+public:
+    explicit ResultsFilterProxy(QObject *parent)
+        : QSortFilterProxyModel(parent), m_filtering(false) {}
+
+    /// Accept only the given search results (sorted row numbers)
+    void setAcceptedResults(const vector<unsigned> &iRows, unsigned iNbResults)
+    {
+        m_accepted.assign(iNbResults, false);
+        for (unsigned row : iRows)
+            m_accepted[row] = true;
+        m_filtering = true;
+        invalidateFilter();
+    }
+
+    /// Accept all the rows
+    void acceptAll()
+    {
+        m_accepted.clear();
+        m_filtering = false;
+        invalidateFilter();
+    }
+
+protected:
+    bool filterAcceptsRow(int iSourceRow, const QModelIndex &) const override
+    {
+        return !m_filtering ||
+            static_cast<unsigned>(iSourceRow) >= m_accepted.size() ||
+            m_accepted[iSourceRow];
+    }
+
+private:
+    bool m_filtering;
+    vector<bool> m_accepted;
+};
+
+
 ArbitrationWidget::ArbitrationWidget(QWidget *parent,
                                      PublicGame *iGame, PlayModel &iPlayModel)
     : QWidget(parent), m_game(iGame), m_playModel(iPlayModel), m_results(10)
@@ -74,6 +124,12 @@ ArbitrationWidget::ArbitrationWidget(QWidget *parent,
 
     m_keyAccum = new KeyAccumulator(this, 400);
 
+    m_searchService = new SearchService(this);
+    QObject::connect(m_searchService, &SearchService::searchProgress,
+                     this, &ArbitrationWidget::searchProgress);
+    QObject::connect(m_searchService, &SearchService::searchDone,
+                     this, &ArbitrationWidget::searchDone);
+
     // The players widget uses more space by default
     splitter->setStretchFactor(0, 1);
     splitter->setStretchFactor(1, 2);
@@ -94,10 +150,8 @@ ArbitrationWidget::ArbitrationWidget(QWidget *parent,
 
     // Associate a model to the results view.
     // We use a proxy, to enable easy sorting/filtering of the results.
-    m_proxyResultsModel = new QSortFilterProxyModel(this);
+    m_proxyResultsModel = new ResultsFilterProxy(this);
     m_proxyResultsModel->setDynamicSortFilter(true);
-    m_proxyResultsModel->setFilterKeyColumn(0);
-    m_proxyResultsModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     m_resultsModel = new QStandardItemModel(this);
     m_proxyResultsModel->setSourceModel(m_resultsModel);
     treeViewResults->setModel(m_proxyResultsModel);
@@ -162,6 +216,12 @@ ArbitrationWidget::ArbitrationWidget(QWidget *parent,
                      this, &ArbitrationWidget::showPreview);
 
     // Dynamic filters for search results
+    lineEditFilterWord->setToolTip(_q("Show only the results starting with the given letters.\n"
+                                      "A term with digits filters the coordinates (e.g. H8 or 8H),\n"
+                                      "and a term starting with '+' filters the letters played\n"
+                                      "from the rack (e.g. +Z or +?). Terms are separated by spaces."));
+    lineEditFilterPoints->setToolTip(_q("Show only the results with the given score,\n"
+                                        "or in the given range (e.g. 30-40, 30- or -40)."));
     QObject::connect(lineEditFilterWord, &QLineEdit::textChanged,
                      this, &ArbitrationWidget::resultsFilterWordChanged);
     QObject::connect(lineEditFilterPoints, &QLineEdit::textChanged,
@@ -218,6 +278,7 @@ ArbitrationWidget::ArbitrationWidget(QWidget *parent,
 
 void ArbitrationWidget::refresh()
 {
+    cancelStaleSearch();
     const PlayedRack &pldRack = m_game->getCurrentRack();
     // Update the rack only if needed, to avoid losing cursor position
     QString qrack = qfw(pldRack.toString(PlayedRack::RACK_SIMPLE));
@@ -445,8 +506,7 @@ void ArbitrationWidget::resultsFilterWordChanged(const QString &iFilter)
     lineEditFilterPoints->blockSignals(false);
 
     treeViewResults->clearSelection();
-    m_proxyResultsModel->setFilterKeyColumn(0);
-    m_proxyResultsModel->setFilterFixedString(iFilter);
+    applyResultsFilter(parseWordFilter(iFilter));
     emit gameUpdated();
 }
 
@@ -459,12 +519,89 @@ void ArbitrationWidget::resultsFilterPointsChanged(const QString &iFilter)
     lineEditFilterWord->blockSignals(false);
 
     treeViewResults->clearSelection();
-    m_proxyResultsModel->setFilterKeyColumn(2);
-    m_proxyResultsModel->setFilterFixedString(iFilter);
+    applyResultsFilter(parsePointsFilter(iFilter));
     emit gameUpdated();
 }
 
 
+ResultsIndex::Query ArbitrationWidget::parseWordFilter(const QString &iFilter) const
+{
+    ResultsIndex::Query query;
+    const Dictionary &dic = m_game->getDic();
+    const QStringList &terms = iFilter.toUpper().split(' ', Qt::SkipEmptyParts);
+    for (const QString &term : terms)
+    {
+        if (std::any_of(term.begin(), term.end(),
+                        [](QChar c) { return c.isDigit(); }))
+        {
+            // Ignore incomplete coordinates, the filter is
+            // updated while the user is typing
+            Coord coord(wfq(term));
+            if (coord.isValid())
+                query.coord = coord;
+        }
+        else if (term.startsWith('+'))
+        {
+            const wstring &letters = dic.convertFromInput(wfq(term.mid(1)));
+            if (!dic.validateLetters(letters, L"?"))
+                continue;
+            for (wchar_t ch : letters)
+                query.letters.push_back(Tile(ch));
+        }
+        else
+        {
+            const wstring &prefix = dic.convertFromInput(wfq(term));
+            if (dic.validateLetters(prefix))
+                query.prefix = prefix;
+        }
+    }
+    return query;
+}
+
+
+ResultsIndex::Query ArbitrationWidget::parsePointsFilter(const QString &iFilter) const
+{
+    ResultsIndex::Query query;
+    const QString &filter = iFilter.trimmed();
+    const int sep = filter.indexOf('-');
+    if (sep < 0)
+    {
+        bool ok;
+        const int points = filter.toInt(&ok);
+        if (ok && points >= 0)
+        {
+            query.minPoints = points;
+            query.maxPoints = points;
+        }
+        return query;
+    }
+
+    bool ok;
+    const int minPoints = filter.left(sep).toInt(&ok);
+    if (ok && minPoints >= 0)
+        query.minPoints = minPoints;
+    const int maxPoints = filter.mid(sep + 1).toInt(&ok);
+    if (ok && maxPoints >= 0)
+        query.maxPoints = maxPoints;
+    return query;
+}
+
+
+void ArbitrationWidget::applyResultsFilter(const ResultsIndex::Query &iQuery)
+{
+    // The search results are the first rows of the model, in the same order
+    if (iQuery.prefix.empty() && !iQuery.coord.isValid() &&
+        iQuery.minPoints < 0 && iQuery.maxPoints < 0 && iQuery.letters.empty())
+    {
+        m_proxyResultsModel->acceptAll();
+        return;
+    }
+    const vector<unsigned> &rows = m_resultsIndex.find(iQuery);
+    LOG_DEBUG("Filter: {} results out of {}", rows.size(), m_resultsIndex.size());
+    m_proxyResultsModel->setAcceptedResults(rows, m_resultsIndex.size());
+}
+
+
 void ArbitrationWidget::updateCoordText(const Coord &iNewCoord)
 {
     if (iNewCoord.isValid() && lineEditCoords->text() != qfw(iNewCoord.toString()))
@@ -493,8 +630,39 @@ void ArbitrationWidget::searchResults()
 {
     m_game->removeTestRound();
     emit notifyInfo(_q("Searching with rack '%1'...").arg(lineEditRack->text()));
-    m_results.clear();
-    m_game->arbitrationSearch(m_results);
+
+    // The search runs in the background, a previous search is cancelled
+    const int limit = Settings::Instance().getInt("arbitration.search-limit");
+    m_pendingResults = std::make_shared<LimitResults>(limit);
+    m_searchTurn = m_game->getCurrTurn();
+    m_searchBoardHash = m_game->getBoard().getHash();
+    m_searchService->start(m_game->getDic(), m_game->getBoard(),
+                           m_game->getCurrentRack().getRack(),
+                           m_game->getHistory().beforeFirstRound(),
+                           m_pendingResults);
+}
+
+
+void ArbitrationWidget::searchProgress(unsigned, unsigned iNbRounds, int iBestScore)
+{
+    emit notifyInfo(_q("Searching with rack '%1'... %2 rounds found (best score: %3)")
+                    .arg(lineEditRack->text()).arg(iNbRounds).arg(iBestScore));
+}
+
+
+void ArbitrationWidget::searchDone(unsigned, std::shared_ptr<Results>)
+{
+    ASSERT(m_pendingResults != nullptr, "No pending search");
+    if (cancelStaleSearch())
+        return;
+    m_results = std::move(*m_pendingResults);
+    m_pendingResults.reset();
+    m_resultsIndex.build(m_results);
+    // Apply the current filter to the new results
+    if (!lineEditFilterPoints->text().isEmpty())
+        applyResultsFilter(parsePointsFilter(lineEditFilterPoints->text()));
+    else
+        applyResultsFilter(parseWordFilter(lineEditFilterWord->text()));
     emit notifyInfo(_q("Search done"));
     emit gameUpdated();
 
@@ -509,6 +677,24 @@ void ArbitrationWidget::searchResults()
 }
 
 
+bool ArbitrationWidget::cancelStaleSearch()
+{
+    if (m_pendingResults == nullptr)
+        return false;
+    // The results are useless if the game changed since the search
+    // was started (when navigating in the history, for instance)
+    if (m_game->getCurrTurn() == m_searchTurn &&
+        m_game->getBoard().getHash() == m_searchBoardHash)
+    {
+        return false;
+    }
+    m_searchService->cancel();
+    m_pendingResults.reset();
+    emit notifyInfo(_q("Search cancelled"));
+    return true;
+}
+
+
 void ArbitrationWidget::populateResultsMenu(QMenu &iMenu, const QPoint &iPoint)
 {
     const QModelIndex &index = treeViewResults->indexAt(iPoint);
@@ -681,8 +867,12 @@ Move ArbitrationWidget::getSelectedMove() const
 
 void ArbitrationWidget::clearResults()
 {
+    // The running search (if any) is for the previous rack
+    m_searchService->cancel();
+    m_pendingResults.reset();
     m_game->removeTestRound();
     m_results.clear();
+    m_resultsIndex.clear();
     m_addedMoves.clear();
     m_resultsModel->removeRows(0, m_resultsModel->rowCount());
 }
@@ -21,10 +21,13 @@
 #ifndef ARBITRATION_WIDGET_H_
 #define ARBITRATION_WIDGET_H_
 
+#include <cstdint>
+#include <memory>
 #include <QWidget>
 
 #include "ui_arbitration_widget.h"
 #include "results.h"
+#include "results_index.h"
 #include "move.h"
 #include "logging.h"
 
@@ -34,7 +37,8 @@ class PlayModel;
 class CustomPopup;
 class KeyAccumulator;
 class QStandardItemModel;
-class QSortFilterProxyModel;
+class ResultsFilterProxy;
+class SearchService;
 class QMenu;
 class QPoint;
 class QValidator;
@@ -65,6 +69,8 @@ private slots:
     void rackEdited(const QString &);
     void rackChanged();
     void searchResults();
+    void searchProgress(unsigned iSearchId, unsigned iNbRounds, int iBestScore);
+    void searchDone(unsigned iSearchId, std::shared_ptr<Results> iResults);
     void resultsFilterWordChanged(const QString &);
     void resultsFilterPointsChanged(const QString &);
     void enableCheckWordButton();
@@ -90,10 +96,22 @@ private:
     /// Search results
     LimitResults m_results;
 
+    /// Service running the searches in the background
+    SearchService *m_searchService;
+
+    /// Results of the running search, if any
+    std::shared_ptr<LimitResults> m_pendingResults;
+    /// Turn and board hash of the game when the running search was started
+    unsigned m_searchTurn{0};
+    uint64_t m_searchBoardHash{0};
+
+    /// Index on the search results, used by the filters
+    ResultsIndex m_resultsIndex;
+
     /// Model for the search results
     QStandardItemModel *m_resultsModel;
     /// Proxy for the results model
-    QSortFilterProxyModel *m_proxyResultsModel;
+    ResultsFilterProxy *m_proxyResultsModel;
 
     /// Popup menu for the search results
     CustomPopup *m_resultsPopup;
@@ -129,6 +147,30 @@ private:
     /// Clear search results
     void clearResults();
 
+    /**
+     * Cancel the running search if the game changed since it was started.
+     * Return true if the search was cancelled.
+     */
+    bool cancelStaleSearch();
+
+    /**
+     * Build a query for the results index from the text of the word filter.
+     * The text contains space-separated terms: a term with a digit gives
+     * the coordinates of the round, a term starting with '+' gives letters
+     * which must be played from the rack, and any other term is a prefix
+     * of the word.
+     */
+    ResultsIndex::Query parseWordFilter(const QString &iFilter) const;
+
+    /**
+     * Build a query for the results index from the text of the points
+     * filter, which is either a number or a range ("30-40", "30-", "-40")
+     */
+    ResultsIndex::Query parsePointsFilter(const QString &iFilter) const;
+
+    /// Show only the search results matching the given query
+    void applyResultsFilter(const ResultsIndex::Query &iQuery);
+
     /**
      * Give the focus to the result corresponding to the given row number.
      * If logical is true, the row number is adapted to respect a possible
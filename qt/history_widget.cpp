@@ -116,13 +116,26 @@ void HistoryWidget::setHistory(const History *iHistory,
     m_model->setHeaderData(m_colPercent, Qt::Horizontal, _q("Game %"));
     m_model->setHeaderData(m_colPlayer, Qt::Horizontal, _q("Player"));
 
+    m_needUpdate = true;
     refresh();
 }
 
 
 void HistoryWidget::refresh()
 {
-    updateModel();
+    // Should we align the rack with its solution?
+    QSettings qs;
+    const bool align = qs.value(PrefsDialog::kINTF_ALIGN_HISTORY).toBool();
+
+    // The percentages of a player depend on the game history,
+    // so both histories must be unchanged to keep the model
+    if (!m_needUpdate && align == m_align &&
+        (m_history == nullptr || m_history->getRevision() == m_revision) &&
+        (m_game == nullptr || m_game->getHistory().getRevision() == m_gameRevision))
+    {
+        return;
+    }
+    updateModel(align);
 }
 
 
@@ -141,17 +154,18 @@ void HistoryWidget::populateMenu(QMenu &iMenu, const QPoint &iPoint)
 }
 
 
-void HistoryWidget::updateModel()
+void HistoryWidget::updateModel(bool iAlign)
 {
+    m_needUpdate = false;
+    m_align = iAlign;
+    m_revision = m_history == nullptr ? 0 : m_history->getRevision();
+    m_gameRevision = m_game == nullptr ? 0 : m_game->getHistory().getRevision();
+
     m_model->removeRows(0, m_model->rowCount());
 
     if (m_history != nullptr && m_history->getSize() != 0)
     {
-        // Should we align the rack with its solution?
-        QSettings qs;
-        bool align = qs.value(PrefsDialog::kINTF_ALIGN_HISTORY).toBool();
-
-        if (!align)
+        if (!iAlign)
             m_model->insertRow(0);
 
         int totalScore = 0;
@@ -161,7 +175,7 @@ void HistoryWidget::updateModel()
             int rowNum = m_model->rowCount();
             m_model->insertRow(rowNum);
             int prevRowNum;
-            if (align)
+            if (iAlign)
                 prevRowNum = rowNum;
             else
                 prevRowNum = rowNum - 1;
@@ -245,7 +259,7 @@ void HistoryWidget::updateModel()
             for (int col = 0; col < m_model->columnCount(); ++col)
             {
                 int row = rowNum;
-                if (!align && col < 2)
+                if (!iAlign && col < 2)
                     row = prevRowNum;
                 m_model->setData(m_model->index(row, col),
                                  QBrush(color), Qt::ForegroundRole);
@@ -344,10 +358,11 @@ void HistoryTabWidget::refresh()
         {
             const Player &player = m_game->getPlayer(i);
             unsigned count = player.getWarningsNb();
-            if (count == 0)
-                setTabText(i + 1, qfw(player.getName()));
-            else
-                setTabText(i + 1, QString("%1 (%2)").arg(qfw(player.getName())).arg(count));
+            QString text = qfw(player.getName());
+            if (count != 0)
+                text = QString("%1 (%2)").arg(text).arg(count);
+            if (tabText(i + 1) != text)
+                setTabText(i + 1, text);
         }
     }
 
@@ -68,6 +68,15 @@ private:
     bool m_forPlayer{false};
     bool m_isFreeGame{false};
 
+    /**
+     * State of the histories when the model was last updated, used by
+     * refresh() to skip the histories which did not change
+     */
+    bool m_needUpdate{true};
+    unsigned m_revision{0};
+    unsigned m_gameRevision{0};
+    bool m_align{false};
+
     int m_colTurn;
     int m_colRack;
     int m_colWord;
@@ -87,7 +96,7 @@ private:
     CustomPopup *m_customPopup;
 
     /// Force synchronizing the model with the contents of the history
-    void updateModel();
+    void updateModel(bool iAlign);
 
     /// Helper method to set the data in a table cell
     void setCellData(int iRow, int iCol, const QVariant &iData);
@@ -43,6 +43,8 @@
 #include "base_exception.h"
 #include "debug.h"
 #include "main_window.h"
+#include "search_cache.h"
+#include "thread_pool.h"
 
 using namespace std;
 
@@ -179,9 +181,16 @@ int main(int argc, char **argv)
 
     try
     {
-        MainWindow qmain;
-        qmain.show();
-        return app.exec();
+        int ret;
+        {
+            MainWindow qmain;
+            qmain.show();
+            ret = app.exec();
+        }
+        // The searches of the window are finished once it is destroyed
+        SearchCache::Destroy();
+        ThreadPool::Destroy();
+        return ret;
     }
     catch (const BaseException &e)
     {
@@ -44,6 +44,7 @@
 #include "game_factory.h"
 #include "game.h"
 #include "public_game.h"
+#include "journal.h"
 #include "player.h"
 #include "history.h"
 #include "turn_data.h"
@@ -90,7 +91,7 @@ MainWindow::MainWindow(QWidget *iParent)
 #endif
 
     // Path to the auto-saved game
-    m_autoSaveGame = Settings::GetConfigFileDir() + "autosave.xml";
+    m_autoSaveGame = Settings::GetConfigFileDir() + "autosave.bin";
 
     LOG_DEBUG("Creating main window");
     m_ui.setupUi(this);
@@ -273,10 +274,17 @@ void MainWindow::refresh()
         if (m_game->isFinished())
             displayInfoMsg(_q("End of the game"));
 
-        // Update the auto-saved game
+        // Update the auto-saved game. The modifications are recorded in
+        // its journal, and it is only saved completely for a new game or
+        // when the journal becomes too big
         try
         {
-            m_game->save(m_autoSaveGame);
+            const Journal *journal = m_game->getJournal();
+            if (journal == nullptr || journal->hasFailed() ||
+                journal->getSize() > kMaxJournalSize)
+            {
+                m_game->startJournal(m_autoSaveGame);
+            }
         }
         catch (const std::exception &e)
         {
@@ -944,11 +952,11 @@ void MainWindow::onGameLoad()
 
 void MainWindow::onGameLoadAutoSave()
 {
-    loadGame(qfl(m_autoSaveGame));
+    loadGame(qfl(m_autoSaveGame), true);
 }
 
 
-void MainWindow::loadGame(QString fileName)
+void MainWindow::loadGame(QString fileName, bool iRecover)
 {
     if (m_dic == nullptr)
     {
@@ -972,7 +980,9 @@ void MainWindow::loadGame(QString fileName)
     {
         try
         {
-            PublicGame *tmpGame = PublicGame::load(lfq(fileName), *m_dic);
+            PublicGame *tmpGame = iRecover ?
+                PublicGame::recover(lfq(fileName), *m_dic) :
+                PublicGame::load(lfq(fileName), *m_dic);
             destroyCurrentGame();
             m_game = tmpGame;
         }
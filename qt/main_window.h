@@ -180,6 +180,10 @@ private:
 
     static const char * m_windowName;
 
+    /// Size of the journal of the auto-saved game triggering a full save
+    static const size_t kMaxJournalSize = 256 * 1024;
+
+    /// Auto-saved game, updated through its journal
     string m_autoSaveGame;
 
     /// Auxiliary windows
@@ -240,8 +244,9 @@ private:
     /**
      * Load the game saved in the given file. If iFileName is an empty string,
      * the auto-saved game will be loaded.
+     * With iRecover, the journal of the file is replayed (see PublicGame::recover())
      */
-    void loadGame(QString iFileName);
+    void loadGame(QString iFileName, bool iRecover = false);
 
 };
 
@@ -0,0 +1,134 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+#include <QThread>
+
+#include "search_service.h"
+
+#include "dic.h"
+#include "board.h"
+#include "game_params.h"
+#include "rack.h"
+#include "results.h"
+#include "search_control.h"
+#include "encoding.h"
+#include "debug.h"
+
+
+INIT_LOGGER(qt, SearchService);
+
+
+/// Copy of the data used by a search
+struct SearchService::Snapshot
+{
+    GameParams params;
+    Board board;
+    Rack rack;
+
+    Snapshot(const Board &iBoard, const Rack &iRack)
+        : params(iBoard.getParams()), board(iBoard, params), rack(iRack) {}
+};
+
+
+SearchService::SearchService(QObject *parent)
+    : QObject(parent)
+{
+}
+
+
+SearchService::~SearchService()
+{
+    cancel();
+    for (QThread *thread : m_threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+}
+
+
+unsigned SearchService::start(const Dictionary &iDic, const Board &iBoard,
+                              const Rack &iRack, bool iFirstWord,
+                              std::shared_ptr<Results> ioResults)
+{
+    cancel();
+
+    const unsigned id = ++m_lastId;
+    LOG_DEBUG("Starting search {} for rack {}", id, lfw(iRack.toString()));
+
+    // The progress is accumulated in the worker thread (the calls of the
+    // callback are serialized by the control), and sent to this thread
+    auto nbRounds = std::make_shared<unsigned>(0);
+    auto bestScore = std::make_shared<int>(-1);
+    auto control = std::make_shared<SearchControl>(
+        [this, id, nbRounds, bestScore](const Results &iPartialResults) {
+            *nbRounds += iPartialResults.size();
+            for (unsigned i = 0; i < iPartialResults.size(); ++i)
+                *bestScore = std::max(*bestScore, iPartialResults.getPoints(i));
+            const unsigned nb = *nbRounds;
+            const int best = *bestScore;
+            QMetaObject::invokeMethod(this, [this, id, nb, best]() {
+                if (id == m_lastId && m_current != nullptr)
+                    emit searchProgress(id, nb, best);
+            }, Qt::QueuedConnection);
+        });
+    m_current = control;
+
+    // The board (with its parameters) and the rack are copied,
+    // the worker does not depend on the game anymore
+    auto snapshot = std::make_shared<Snapshot>(iBoard, iRack);
+    QThread *thread = QThread::create(
+        [this, id, &iDic, snapshot, iFirstWord,
+         results = std::move(ioResults), control]() {
+            results->setControl(control.get());
+            results->search(iDic, snapshot->board, snapshot->rack, iFirstWord);
+            results->setControl(nullptr);
+            if (control->isCancelled())
+                return;
+            QMetaObject::invokeMethod(this, [this, id, results]() {
+                // The search may have been cancelled in the meantime
+                if (id != m_lastId || m_current == nullptr)
+                    return;
+                m_current.reset();
+                LOG_DEBUG("Search {} done: {} results", id, results->size());
+                emit searchDone(id, results);
+            }, Qt::QueuedConnection);
+        });
+    QObject::connect(thread, &QThread::finished, this, [this, thread]() {
+        m_threads.removeOne(thread);
+        thread->deleteLater();
+    });
+    m_threads.append(thread);
+    thread->start();
+
+    return id;
+}
+
+
+void SearchService::cancel()
+{
+    if (m_current == nullptr)
+        return;
+    LOG_DEBUG("Cancelling search {}", m_lastId);
+    m_current->cancel();
+    m_current.reset();
+}
+
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SEARCH_SERVICE_H_
+#define SEARCH_SERVICE_H_
+
+#include <memory>
+#include <QObject>
+#include <QList>
+
+#include "logging.h"
+
+class Dictionary;
+class Board;
+class Rack;
+class Results;
+class SearchControl;
+class QThread;
+
+
+/**
+ * Service running the searches of the interface in worker threads,
+ * so that the interface remains responsive during big searches.
+ *
+ * Each search works on its own copy of the board and of the rack, so the
+ * game can be modified while it runs. Starting a new search cancels the
+ * current one, without waiting for it: the cancelled search stops as soon
+ * as possible in the background, and its results are never delivered.
+ *
+ * The signals are always emitted in the thread of the service (i.e. the
+ * GUI thread), and only for the current search.
+ * The dictionary must outlive the searches: the destructor cancels the
+ * running searches and waits for them.
+ */
+class SearchService: public QObject
+{
+    Q_OBJECT;
+    DEFINE_LOGGER();
+
+public:
+    explicit SearchService(QObject *parent = nullptr);
+    ~SearchService() override;
+
+    /**
+     * Start searching the rounds playable with iRack on iBoard, and return
+     * an identifier of the search. The given results object is filled by
+     * the worker thread, it must not be accessed before searchDone() is
+     * emitted for this search.
+     */
+    unsigned start(const Dictionary &iDic, const Board &iBoard,
+                   const Rack &iRack, bool iFirstWord,
+                   std::shared_ptr<Results> ioResults);
+
+    /// Cancel the current search, if any
+    void cancel();
+
+    /// Return true if the current search is still running
+    bool isSearching() const { return m_current != nullptr; }
+
+signals:
+    /**
+     * Progress of the current search: the number of rounds found so far,
+     * and the best score among them
+     */
+    void searchProgress(unsigned iSearchId, unsigned iNbRounds, int iBestScore);
+
+    /// The current search is complete
+    void searchDone(unsigned iSearchId, std::shared_ptr<Results> iResults);
+
+private:
+    struct Snapshot;
+
+    /// Identifier of the last started search
+    unsigned m_lastId{0};
+
+    /// Control of the current search (nullptr when there is none)
+    std::shared_ptr<SearchControl> m_current;
+
+    /// Threads not finished yet (including the cancelled searches)
+    QList<QThread*> m_threads;
+};
+
+#endif
+
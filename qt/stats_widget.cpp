@@ -31,6 +31,7 @@
 #include <QPrintPreviewDialog>
 #include <QLocale>
 
+#include <algorithm>
 #include <cmath> // For floor()
 
 #include "stats_widget.h"
@@ -63,7 +64,19 @@ const QColor StatsWidget::InvalidBrush(255, 0, 0);
 class FlippedModel : public QAbstractItemModel
 {
     public:
-        FlippedModel(QAbstractItemModel *iRefModel) : m_refModel(iRefModel) {}
+        FlippedModel(QAbstractItemModel *iRefModel) : m_refModel(iRefModel)
+        {
+            // Forward the updates of the cells, so that the flipped view
+            // follows the incremental updates of the model
+            QObject::connect(m_refModel, &QAbstractItemModel::dataChanged, this,
+                             [this](const QModelIndex &iTopLeft,
+                                    const QModelIndex &iBottomRight,
+                                    const QList<int> &iRoles) {
+                emit dataChanged(index(iTopLeft.column(), iTopLeft.row(), {}),
+                                 index(iBottomRight.column(), iBottomRight.row(), {}),
+                                 iRoles);
+            });
+        }
 
         int columnCount(const QModelIndex &) const override
         {
@@ -167,11 +180,34 @@ StatsWidget::StatsWidget(QWidget *parent, const PublicGame *iGame)
 void StatsWidget::setGame(const PublicGame *iGame)
 {
     m_game = iGame;
+    m_needFullRefresh = true;
     refresh();
 }
 
 
 void StatsWidget::refresh()
+{
+    if (canUpdatePlayers())
+        updatePlayers();
+    else
+        fillModel();
+}
+
+
+bool StatsWidget::canUpdatePlayers() const
+{
+    // A new turn, a navigation in the game or a change of the game moves
+    // modify the columns of the turns, so the model is rebuilt
+    return !m_needFullRefresh && m_game != nullptr &&
+        m_game->getNbPlayers() == m_playersRevisions.size() &&
+        m_game->getHistory().getSize() == m_histSize &&
+        m_game->getCurrTurn() == m_currTurn &&
+        m_game->getHistory().getRevision() == m_gameRevision &&
+        Settings::Instance().getInt("duplicate.solo-players") == m_soloPlayers;
+}
+
+
+void StatsWidget::fillModel()
 {
     m_model->removeRows(0, m_model->rowCount());
 
@@ -189,9 +225,10 @@ void StatsWidget::refresh()
         m_game->getParams().getMode() == GameParams::kFREEGAME;
     const bool isTopping = m_game != nullptr &&
         m_game->getParams().getMode() == GameParams::kTOPPING;
+    m_soloPlayers = Settings::Instance().getInt("duplicate.solo-players");
     const bool canHaveSolos = m_game != nullptr &&
         m_game->getParams().getMode() == GameParams::kDUPLICATE &&
-        Settings::Instance().getInt("duplicate.solo-players") <= (int)m_game->getNbPlayers();
+        m_soloPlayers <= (int)m_game->getNbPlayers();
 
     // Define columns (or rows, depending on the orientation)
     int col = 0;
@@ -229,6 +266,7 @@ void StatsWidget::refresh()
     setSectionHidden(col, isTopping);
     setModelHeader(col++, _q("Game %"), false);
     setSectionHidden(col, isTraining || isTopping);
+    m_rankingCol = col;
     setModelHeader(col++, _q("Ranking"), false);
 
     // Define the header for the Game pseudo-player
@@ -241,7 +279,6 @@ void StatsWidget::refresh()
     const History &gHistory = m_game->getHistory();
 
     // Game data
-    int gameTotal = 0;
     {
         const int row = 0;
         int col = 0;
@@ -263,65 +300,130 @@ void StatsWidget::refresh()
         // Skip the ranking column
         ++col;
 
-        gameTotal = score;
+        m_gameTotal = score;
     }
 
+    m_histSize = histSize;
+    m_currTurn = m_game->getCurrTurn();
+    m_gameRevision = gHistory.getRevision();
+    m_needFullRefresh = false;
+
     // Players data
+    m_playersRevisions.clear();
     for (unsigned i = 0; i < nbPlayers; ++i)
     {
-        const Player &player = m_game->getPlayer(i);
-        int col = 0;
-        setModelHeader(i + 1, qfw(player.getName()), true);
+        setModelPlayerData(i);
+        m_playersRevisions.push_back(m_game->getPlayer(i).getHistory().getRevision());
+    }
+    setModelRankings(false);
+
+    // Resize
+    m_table->resizeRowsToContents();
+    if (m_autoResizeColumns)
+        m_table->resizeColumnsToContents();
+}
 
-        // Table number
-        setModelText(getIndex(i + 1, col++), player.getTableNb());
 
-        // Normal turns
-        for (unsigned j = 0; j < gHistory.getSize(); ++j)
+void StatsWidget::updatePlayers()
+{
+    std::vector<unsigned> modified;
+    for (unsigned i = 0; i < m_game->getNbPlayers(); ++i)
+    {
+        const Player &player = m_game->getPlayer(i);
+        const unsigned revision = player.getHistory().getRevision();
+        if (revision != m_playersRevisions[i])
         {
-            const History &pHistory = player.getHistory();
-            setModelTurnData(getIndex(i + 1, col++),
-                             pHistory.getTurn(j), gHistory.getTurn(j));
+            setModelPlayerData(i);
+            m_playersRevisions[i] = revision;
+            modified.push_back(i);
         }
-
-        // Sub-total
-        const int subTotal = player.getMovePoints();
-        setModelText(getIndex(i + 1, col++), subTotal, subTotal >= gameTotal);
-
-        // Events columns
-        for (int j = 0; j <= 3; ++j)
+        else if (m_model->headerData(i + 1, Qt::Horizontal).toString() != qfw(player.getName()))
         {
-            setModelEventData(getIndex(i + 1, col++), j, player);
+            setModelHeader(i + 1, qfw(player.getName()), true);
         }
+    }
+    if (modified.empty())
+        return;
+
+    LOG_DEBUG("Updating {} players", modified.size());
+    setModelRankings(true);
 
-        // Final score
-        const int totalScore = player.getTotalScore();
-        setModelText(getIndex(i + 1, col++), totalScore, totalScore >= gameTotal);
-
-        // Diff with game total
-        setModelText(getIndex(i + 1, col++), totalScore - gameTotal);
-        // Global score percentage
-        setModelText(getIndex(i + 1, col++),
-                     locale.toString(100. * totalScore / gameTotal, 'f', 1) + "%",
-                     totalScore >= gameTotal);
-
-        // Ranking
-        // FIXME: quadratic complexity, we can probably do better
-        int rank = 1;
-        for (unsigned j = 0; j < nbPlayers; ++j)
+    if (m_autoResizeColumns)
+    {
+        // Without flipping, each player is displayed in a column
+        if (isFlipped())
+            m_table->resizeColumnsToContents();
+        else
         {
-            if (i == j)
-                continue;
-            if (player.getTotalScore() < m_game->getPlayer(j).getTotalScore())
-                ++rank;
+            for (unsigned i : modified)
+                m_table->resizeColumnToContents(i + 1);
         }
-        setModelText(getIndex(i + 1, col++), rank, rank == 1);
     }
+}
 
-    // Resize
-    m_table->resizeRowsToContents();
-    if (m_autoResizeColumns)
-        m_table->resizeColumnsToContents();
+
+void StatsWidget::setModelPlayerData(unsigned iPlayer)
+{
+    QLocale locale;
+    const History &gHistory = m_game->getHistory();
+    const Player &player = m_game->getPlayer(iPlayer);
+    const int row = iPlayer + 1;
+    int col = 0;
+    setModelHeader(row, qfw(player.getName()), true);
+
+    // Table number
+    setModelText(getIndex(row, col++), player.getTableNb());
+
+    // Normal turns
+    const History &pHistory = player.getHistory();
+    for (unsigned j = 0; j < gHistory.getSize(); ++j)
+    {
+        setModelTurnData(getIndex(row, col++),
+                         pHistory.getTurn(j), gHistory.getTurn(j));
+    }
+
+    // Sub-total
+    const int subTotal = player.getMovePoints();
+    setModelText(getIndex(row, col++), subTotal, subTotal >= m_gameTotal);
+
+    // Events columns
+    for (int j = 0; j <= 3; ++j)
+    {
+        setModelEventData(getIndex(row, col++), j, player);
+    }
+
+    // Final score
+    const int totalScore = player.getTotalScore();
+    setModelText(getIndex(row, col++), totalScore, totalScore >= m_gameTotal);
+
+    // Diff with game total
+    setModelText(getIndex(row, col++), totalScore - m_gameTotal);
+    // Global score percentage
+    setModelText(getIndex(row, col++),
+                 locale.toString(100. * totalScore / m_gameTotal, 'f', 1) + "%",
+                 totalScore >= m_gameTotal);
+}
+
+
+void StatsWidget::setModelRankings(bool iOnlyChanged)
+{
+    const unsigned nbPlayers = m_game->getNbPlayers();
+    std::vector<int> scores;
+    scores.reserve(nbPlayers);
+    for (unsigned i = 0; i < nbPlayers; ++i)
+        scores.push_back(m_game->getPlayer(i).getTotalScore());
+    std::sort(scores.begin(), scores.end());
+
+    for (unsigned i = 0; i < nbPlayers; ++i)
+    {
+        // 1 + number of players with a better score
+        const int score = m_game->getPlayer(i).getTotalScore();
+        const int rank = 1 + (scores.end() - std::upper_bound(scores.begin(), scores.end(), score));
+        const QModelIndex &index = getIndex(i + 1, m_rankingCol);
+        if (iOnlyChanged && m_model->data(index) == rank)
+            continue;
+        setModelText(index, rank, rank == 1);
+    }
 }
 
 
@@ -362,6 +464,8 @@ void StatsWidget::setModelHeader(int index, const QString &iText, bool iPlayerNa
 void StatsWidget::setModelText(const QModelIndex &iIndex,
                                const QVariant &iData, bool useBoldFont)
 {
+    // The cell may be updated, forget its previous data
+    m_model->clearItemData(iIndex);
     m_model->setData(iIndex, iData);
     m_model->setData(iIndex, Qt::AlignCenter, Qt::TextAlignmentRole);
     if (useBoldFont)
@@ -376,6 +480,8 @@ void StatsWidget::setModelText(const QModelIndex &iIndex,
 void StatsWidget::setModelTurnData(const QModelIndex &iIndex,
                                    const TurnData &iTurn, const TurnData &iGameTurn)
 {
+    m_model->clearItemData(iIndex);
+
     // Set the text (score for the turn)
     int score = iTurn.getMove().getScore();
     if (score != 0)
@@ -507,6 +613,7 @@ void StatsWidget::flipTable()
         m_table->sortByColumn(col, Qt::AscendingOrder);
         m_table->horizontalHeader()->setSortIndicator(col, Qt::AscendingOrder);
     }
+    m_needFullRefresh = true;
     refresh();
 }
 
@@ -21,6 +21,7 @@
 #ifndef STATS_WIDGET_H_
 #define STATS_WIDGET_H_
 
+#include <vector>
 #include <QWidget>
 
 #include "logging.h"
@@ -71,6 +72,22 @@ private:
     /// Indicate whether the columns should be resized automatically
     bool m_autoResizeColumns{true};
 
+    /**
+     * State of the game when the model was last filled. As long as the
+     * turns are the same, refresh() only updates the players whose
+     * history has changed since then.
+     */
+    bool m_needFullRefresh{true};
+    unsigned m_histSize{0};
+    unsigned m_currTurn{0};
+    unsigned m_gameRevision{0};
+    std::vector<unsigned> m_playersRevisions;
+    int m_gameTotal{0};
+    /// Column of the rankings, defined by fillModel()
+    int m_rankingCol{0};
+    /// Setting used to hide the solo columns
+    int m_soloPlayers{0};
+
     static const QColor WarningBrush;
     static const QColor PenaltyBrush;
     static const QColor SoloBrush;
@@ -78,6 +95,16 @@ private:
     static const QColor InvalidBrush;
 
 
+    /// Rebuild the whole model
+    void fillModel();
+    /// Return true if refresh() can update only the modified players
+    bool canUpdatePlayers() const;
+    /// Update the data of the players whose history has changed
+    void updatePlayers();
+
+    void setModelPlayerData(unsigned iPlayer);
+    void setModelRankings(bool iOnlyChanged);
+
     QModelIndex getIndex(int row, int col) const;
     QString getTooltip(const TurnData &iTurn, const TurnData &iGameTurn) const;
 
@@ -28,13 +28,16 @@
 #include "play_word_mediator.h"
 #include "custom_popup.h"
 #include "validator_factory.h"
+#include "search_service.h"
 
 #include "dic.h"
 #include "bag.h"
+#include "board.h"
 #include "public_game.h"
 #include "game_exception.h"
 #include "player.h"
 #include "results.h"
+#include "settings.h"
 #include "debug.h"
 
 using namespace std;
@@ -136,12 +139,23 @@ TrainingWidget::TrainingWidget(QWidget *parent, PlayModel &iPlayModel, PublicGam
     QObject::connect(lineEditRack, &QLineEdit::textChanged,
                      this, &TrainingWidget::rackUpdated);
 
+    // The searches run in the background, and the running search
+    // (if any) becomes useless when the rack changes
+    m_searchService = new SearchService(this);
+    QObject::connect(m_searchService, &SearchService::searchProgress,
+                     this, &TrainingWidget::searchProgress);
+    QObject::connect(m_searchService, &SearchService::searchDone,
+                     this, &TrainingWidget::searchDone);
+    QObject::connect(lineEditRack, &QLineEdit::textChanged,
+                     m_searchService, &SearchService::cancel);
+
     refresh();
 }
 
 
 void TrainingWidget::refresh()
 {
+    cancelStaleSearch();
     updateModel();
     if (m_game == nullptr)
     {
@@ -355,13 +369,55 @@ void TrainingWidget::search()
 {
     m_game->removeTestRound();
     emit notifyInfo(_q("Searching with rack '%1'...").arg(lineEditRack->text()));
-    m_game->trainingSearch();
+    const int limit = Settings::Instance().getInt("training.search-limit");
+    m_pendingResults = std::make_shared<LimitResults>(limit);
+    m_searchTurn = m_game->getCurrTurn();
+    m_searchBoardHash = m_game->getBoard().getHash();
+    m_searchService->start(m_game->getDic(), m_game->getBoard(),
+                           m_game->getCurrentRack().getRack(),
+                           m_game->getHistory().beforeFirstRound(),
+                           m_pendingResults);
+}
+
+
+void TrainingWidget::searchProgress(unsigned, unsigned iNbRounds, int iBestScore)
+{
+    emit notifyInfo(_q("Searching with rack '%1'... %2 rounds found (best score: %3)")
+                    .arg(lineEditRack->text()).arg(iNbRounds).arg(iBestScore));
+}
+
+
+void TrainingWidget::searchDone(unsigned, std::shared_ptr<Results>)
+{
+    ASSERT(m_pendingResults != nullptr, "No pending search");
+    if (cancelStaleSearch())
+        return;
+    m_game->trainingSetResults(*m_pendingResults);
+    m_pendingResults.reset();
     emit notifyInfo(_q("Search done"));
     emit gameUpdated();
     treeViewResults->setFocus();
 }
 
 
+bool TrainingWidget::cancelStaleSearch()
+{
+    if (m_pendingResults == nullptr)
+        return false;
+    // The results are useless if the game changed since the search
+    // was started (when navigating in the history, for instance)
+    if (m_game != nullptr && m_game->getCurrTurn() == m_searchTurn &&
+        m_game->getBoard().getHash() == m_searchBoardHash)
+    {
+        return false;
+    }
+    m_searchService->cancel();
+    m_pendingResults.reset();
+    emit notifyInfo(_q("Search cancelled"));
+    return true;
+}
+
+
 void TrainingWidget::playSelectedWord()
 {
     QModelIndexList indexList = treeViewResults->selectionModel()->selectedIndexes();
@@ -21,6 +21,8 @@
 #ifndef TRAINING_WIDGET_H_
 #define TRAINING_WIDGET_H_
 
+#include <cstdint>
+#include <memory>
 #include <QWidget>
 #include "ui_training_widget.h"
 #include "logging.h"
@@ -33,6 +35,9 @@ class PlayModel;
 class CustomPopup;
 class PlayWordMediator;
 class PublicGame;
+class SearchService;
+class Results;
+class LimitResults;
 
 class TrainingWidget: public QWidget, private Ui::TrainingWidget
 {
@@ -67,6 +72,8 @@ private slots:
     void setNewRack();
     void completeRack();
     void search();
+    void searchProgress(unsigned iSearchId, unsigned iNbRounds, int iBestScore);
+    void searchDone(unsigned iSearchId, std::shared_ptr<Results> iResults);
     void playSelectedWord();
 
 private:
@@ -82,6 +89,15 @@ private:
     /// Mediator for the "play word" controls
     PlayWordMediator *m_mediator;
 
+    /// Service running the searches in the background
+    SearchService *m_searchService;
+
+    /// Results of the running search, if any
+    std::shared_ptr<LimitResults> m_pendingResults;
+    /// Turn and board hash of the game when the running search was started
+    unsigned m_searchTurn{0};
+    uint64_t m_searchBoardHash{0};
+
     /// Palette to write text in black
     QPalette blackPalette;
 
@@ -96,6 +112,12 @@ private:
 
     /// Helper method to set the rack
     void helperSetRack(bool iAll);
+
+    /**
+     * Cancel the running search if the game changed since it was started.
+     * Return true if the search was cancelled.
+     */
+    bool cancelStaleSearch();
 };
 
 #endif
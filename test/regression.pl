@@ -4,6 +4,7 @@ use strict;
 use warnings;
 
 use Cwd 'abs_path';
+use File::Basename;
 
 my $root_path = $0;
 $root_path =~ s/regression.pl/../;
@@ -38,6 +39,8 @@ my $tmp_dir = "/tmp/eliot";
 my $input_ext = ".input";
 my $ref_ext = ".ref";
 my $run_ext = ".run";
+my $setup_ext = ".setup";
+my $tool_ext = ".tool";
 
 
 # Look for ods5.dawg
@@ -70,6 +73,14 @@ if (not -x $eliottxt)
     die "Cannot find the text interface executable in [".join(", ", @eliottxt_array)."]";
 }
 
+# Environment of the tool scenarios: the other tools are built next to
+# eliottxt, and the commands can refer to the dictionary and to the files
+# of the test directory
+$eliottxt = abs_path($eliottxt);
+$ENV{PATH} = dirname($eliottxt) . ":$ENV{PATH}";
+$ENV{ELIOT_DIC} = abs_path($ods);
+$ENV{ELIOT_TESTS} = "$root_path/test";
+
 
 # Fill a map of (scenario --> randseed) from the driver file.
 # Also fill the list of scenarios in the order of the driver file.
@@ -102,26 +113,53 @@ else
     # Remove known file extensions in case they are present
     foreach my $item (@ARGV)
     {
-        $item =~ s/$input_ext$|$ref_ext$|$run_ext$//;
+        $item =~ s/$input_ext$|$tool_ext$|$ref_ext$|$run_ext$//;
         push(@scenarios_to_play, $item);
     }
 }
 
 
+# Run the shell commands of a tool scenario, one per line, in an empty
+# directory (so that the files they create do not end up in the test
+# directory). Each command is written to the run file, followed by its
+# output and by its exit status if it failed.
+sub run_tool_scenario
+{
+    my ($tool_file, $run_file) = @_;
+    my $work_dir = "$tmp_dir/work";
+    system("rm -rf $work_dir && mkdir -p $work_dir") == 0
+        or die "Cannot create the directory $work_dir";
+
+    open(my $tool, "<", $tool_file) or die "Cannot open $tool_file: $!";
+    open(my $run, ">", $run_file) or die "Cannot create $run_file: $!";
+    while (my $command = <$tool>)
+    {
+        chomp $command;
+        next if $command =~ /^\s*(#|$)/;
+        print $run "\$ $command\n";
+        print $run `cd $work_dir && ( $command ) 2>&1`;
+        print $run "[exit status " . ($? >> 8) . "]\n" if $? != 0;
+    }
+    close($run);
+    close($tool);
+}
+
+
 # Actually play the selected scenarios
 my @errors;
 foreach my $scenario (@scenarios_to_play)
 {
     print "Scenario: $scenario\n";
     my $input_file = $scenario . $input_ext;
+    my $tool_file  = $scenario . $tool_ext;
     my $ref_file   = $scenario . $ref_ext;
     my $run_file   = $scenario . $run_ext;
     my $randseed   = $scenario_map{$scenario};
 
     # Check that the needed files exist
-    if (not -f $input_file)
+    if (not -f $input_file and not -f $tool_file)
     {
-        print "--> Error: missing file: $input_file\n";
+        print "--> Error: missing file: $input_file or $tool_file\n";
         push(@errors, $scenario);
         next;
     }
@@ -132,16 +170,32 @@ foreach my $scenario (@scenarios_to_play)
         next;
     }
 
-    # OK, let's do the actual stuff
-    unlink $run_file;
-    my $rc = `$eliottxt $ods $randseed < $input_file > $run_file 2>&1`;
-    if ($rc ne "")
+    # Prepare the files needed by the scenario
+    my $setup_file = $scenario . $setup_ext;
+    if (-f $setup_file && system("perl $setup_file $eliottxt $ods") != 0)
     {
-        print "--> Error: execution of scenario failed (return value: $rc)\n";
+        print "--> Error: setup of scenario failed\n";
         push(@errors, $scenario);
         next;
     }
 
+    # OK, let's do the actual stuff
+    unlink $run_file;
+    if (-f $tool_file)
+    {
+        run_tool_scenario($tool_file, $run_file);
+    }
+    else
+    {
+        my $rc = `$eliottxt $ods $randseed < $input_file > $run_file 2>&1`;
+        if ($rc ne "")
+        {
+            print "--> Error: execution of scenario failed (return value: $rc)\n";
+            push(@errors, $scenario);
+            next;
+        }
+    }
+
     # Create temporary copies of the files, without comments
     my $tmp_ref_file = "$tmp_dir/$ref_file";
     my $tmp_run_file = "$tmp_dir/$run_file";
@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <format>
+
+#include "batch_tools.h"
+#include "game_factory.h"
+#include "settings.h"
+#include "search_cache.h"
+#include "thread_pool.h"
+
+
+string BatchTools::escapeJson(const string &iStr)
+{
+    string res;
+    for (char c : iStr)
+    {
+        if (c == '"' || c == '\\')
+            res += '\\';
+        if ((unsigned char)c < 0x20)
+            res += std::format("\\u{:04x}", (unsigned char)c);
+        else
+            res += c;
+    }
+    return res;
+}
+
+
+void BatchTools::createSingletons()
+{
+    Settings::Instance();
+    GameFactory::Instance();
+    SearchCache::Instance();
+}
+
+
+void BatchTools::destroySingletons()
+{
+    GameFactory::Destroy();
+    Settings::Destroy();
+    SearchCache::Destroy();
+    ThreadPool::Destroy();
+}
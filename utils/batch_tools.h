@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BATCH_TOOLS_H_
+#define BATCH_TOOLS_H_
+
+#include <string>
+
+using std::string;
+
+
+/**
+ * Helpers shared by the command-line tools playing or analyzing
+ * games in parallel threads (eliotsim, eliotleaves and eliotanalyze).
+ */
+class BatchTools
+{
+public:
+    /// This class is a toolbox and should not be instantiated
+    BatchTools() = delete;
+
+    /// Escape a string for a JSON output
+    static string escapeJson(const string &iStr);
+
+    /**
+     * Create the singletons used by the games, so that the threads
+     * do not race to create them
+     */
+    static void createSingletons();
+
+    /// Destroy the singletons, including the thread pool
+    static void destroySingletons();
+};
+
+#endif
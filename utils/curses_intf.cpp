@@ -41,6 +41,8 @@
 #include "curses_intf.h"
 #include "dic.h"
 #include "game_factory.h"
+#include "search_cache.h"
+#include "thread_pool.h"
 #include "game_params.h"
 #include "board.h"
 #include "board_layout.h"
@@ -1244,6 +1246,8 @@ int main(int argc, char ** argv)
     }
 
     GameFactory::Destroy();
+    SearchCache::Destroy();
+    ThreadPool::Destroy();
 
     return retCode;
 }
@@ -0,0 +1,440 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+/**
+ * Analyze saved games with the engine: each game is replayed, the best
+ * move of each turn is searched, and the moves of the players are compared
+ * to it. The games are analyzed in parallel, sharing the dictionary.
+ *
+ * For each player, the output gives the number of moves, how many of them
+ * were top moves, the total score compared to the total of the best
+ * scores, and the bingos which could have been played. The statistics are
+ * printed for each game (one line per player in CSV, one line per game in
+ * JSON), or for each player name over all the games.
+ */
+
+#include "config.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <format>
+#include <clocale>
+#include <cstdlib>
+#include <getopt.h>
+
+#include "dic.h"
+#include "game_params.h"
+#include "public_game.h"
+#include "player.h"
+#include "history.h"
+#include "turn_data.h"
+#include "pldrack.h"
+#include "rack.h"
+#include "move.h"
+#include "round.h"
+#include "board.h"
+#include "results.h"
+#include "encoding.h"
+#include "thread_pool.h"
+#include "base_exception.h"
+#include "batch_tools.h"
+
+using namespace std;
+
+
+/// Statistics of the moves of a player
+struct PlayerStats
+{
+    string name;
+    unsigned nbMoves{0};
+    /// Moves scoring as much as the best move
+    unsigned nbTopMoves{0};
+    int score{0};
+    /// Total of the best scores of the turns played
+    int bestScore{0};
+    /// Turns where a bingo could be played
+    unsigned nbBingosPossible{0};
+    unsigned nbBingosPlayed{0};
+    /// Turns where a bingo could be played, but was not
+    unsigned nbBingosMissed{0};
+
+    void add(const PlayerStats &iOther)
+    {
+        nbMoves += iOther.nbMoves;
+        nbTopMoves += iOther.nbTopMoves;
+        score += iOther.score;
+        bestScore += iOther.bestScore;
+        nbBingosPossible += iOther.nbBingosPossible;
+        nbBingosPlayed += iOther.nbBingosPlayed;
+        nbBingosMissed += iOther.nbBingosMissed;
+    }
+
+    double getAccuracy() const
+    {
+        return bestScore == 0 ? 1. : double(score) / bestScore;
+    }
+};
+
+
+/// Result of the analysis of a game
+struct GameAnalysis
+{
+    unsigned nbTurns{0};
+    vector<PlayerStats> players;
+    /// Set if the game could not be analyzed (there are no players then)
+    string error;
+};
+
+
+void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options] /path/to/dictionary.dawg [game1 game2 ...]" << endl
+         << "Options:" << endl
+         << "  -l, --list <string>     File containing the games to analyze (one per line)," << endl
+         << "                          in addition to the ones given on the command line" << endl
+         << "  -j, --json              Print the statistics in JSON format (one line per" << endl
+         << "                          game) instead of CSV" << endl
+         << "  -t, --totals            Print the statistics of each player name over all" << endl
+         << "                          the games, instead of the statistics of each game" << endl
+         << "  -o, --output <string>   Write the statistics to this file instead of stdout" << endl
+         << "  -h, --help              Print this help and exit" << endl
+         << "Example:" << endl
+         << "  " << iBinaryName << " -t ods5.dawg games/*.xml" << endl;
+}
+
+
+/// Escape a string for a CSV output
+string escapeCsv(const string &iStr)
+{
+    if (iStr.find_first_of(",\"\n") == string::npos)
+        return iStr;
+    string res = "\"";
+    for (char c : iStr)
+    {
+        if (c == '"')
+            res += '"';
+        res += c;
+    }
+    return res + "\"";
+}
+
+
+/// Replay the given game, and compare the moves of the players to the best ones
+GameAnalysis analyzeGame(const Dictionary &iDic, const string &iFileName)
+{
+    GameAnalysis analysis;
+    try
+    {
+        unique_ptr<PublicGame> game(PublicGame::load(iFileName, iDic));
+        const History &history = game->getHistory();
+        analysis.nbTurns = history.getSize();
+        for (unsigned i = 0; i < game->getNbPlayers(); ++i)
+        {
+            analysis.players.emplace_back();
+            string name = lfw(game->getPlayer(i).getName());
+            // The players are grouped by name for the totals
+            if (name.empty())
+                name = std::format("Player {}", i + 1);
+            analysis.players.back().name = name;
+        }
+
+        // The moves are replayed on a separate board,
+        // there is no need to navigate in the game
+        Board board(game->getParams());
+        bool firstWord = true;
+        for (unsigned turn = 0; turn < history.getSize(); ++turn)
+        {
+            // In duplicate mode, all the players have the same rack:
+            // search each rack only once
+            map<wstring, StatsResults> searches;
+            for (unsigned i = 0; i < game->getNbPlayers(); ++i)
+            {
+                const History &playerHistory = game->getPlayer(i).getHistory();
+                if (turn >= playerHistory.getSize())
+                    continue;
+                const TurnData &turnData = playerHistory.getTurn(turn);
+                const Move &move = turnData.getMove();
+                // In a free game, the other players did not play this turn
+                if (move.isNull())
+                    continue;
+
+                const Rack &rack = turnData.getPlayedRack().getRack();
+                auto [it, isNew] = searches.try_emplace(rack.toString());
+                StatsResults &results = it->second;
+                if (isNew)
+                    results.search(iDic, board, rack, firstWord);
+
+                PlayerStats &stats = analysis.players[i];
+                const bool isBingo = move.isValid() && move.getRound().getBonus();
+                ++stats.nbMoves;
+                stats.score += move.getScore();
+                stats.bestScore += results.getBestScore();
+                if (move.isValid() && move.getScore() >= results.getBestScore())
+                    ++stats.nbTopMoves;
+                if (isBingo)
+                    ++stats.nbBingosPlayed;
+                if (results.getNbBingos() > 0)
+                {
+                    ++stats.nbBingosPossible;
+                    if (!isBingo)
+                        ++stats.nbBingosMissed;
+                }
+            }
+
+            const Move &move = history.getTurn(turn).getMove();
+            if (move.isValid())
+            {
+                board.addRound(iDic, move.getRound());
+                firstWord = false;
+            }
+        }
+    }
+    catch (std::exception &e)
+    {
+        // The statistics of a partially analyzed game are not output
+        analysis.nbTurns = 0;
+        analysis.players.clear();
+        analysis.error = e.what();
+    }
+    return analysis;
+}
+
+
+string formatCsvHeader()
+{
+    return "file,player,name,moves,top_moves,score,best_score,accuracy,"
+           "bingos_possible,bingos_played,bingos_missed";
+}
+
+
+string formatCsv(const string &iFileName, int iPlayer, const PlayerStats &iStats)
+{
+    return std::format("{},{},{},{},{},{},{},{:.4f},{},{},{}",
+                       escapeCsv(iFileName), iPlayer, escapeCsv(iStats.name),
+                       iStats.nbMoves, iStats.nbTopMoves, iStats.score,
+                       iStats.bestScore, iStats.getAccuracy(),
+                       iStats.nbBingosPossible, iStats.nbBingosPlayed,
+                       iStats.nbBingosMissed);
+}
+
+
+string formatJson(const PlayerStats &iStats)
+{
+    return std::format("{{\"name\":\"{}\",\"moves\":{},\"top_moves\":{},\"score\":{},"
+                       "\"best_score\":{},\"accuracy\":{:.4f},\"bingos_possible\":{},"
+                       "\"bingos_played\":{},\"bingos_missed\":{}}}",
+                       BatchTools::escapeJson(iStats.name), iStats.nbMoves, iStats.nbTopMoves,
+                       iStats.score, iStats.bestScore, iStats.getAccuracy(),
+                       iStats.nbBingosPossible, iStats.nbBingosPlayed,
+                       iStats.nbBingosMissed);
+}
+
+
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "");
+
+    // Do not log by default (can be overridden with ELIOT_LOG_PROFILE)
+    initialize_logging("NOLOG");
+
+    static const struct option long_options[] =
+    {
+        {.name="help", .has_arg=no_argument, .flag=nullptr, .val='h'},
+        {.name="list", .has_arg=required_argument, .flag=nullptr, .val='l'},
+        {.name="json", .has_arg=no_argument, .flag=nullptr, .val='j'},
+        {.name="totals", .has_arg=no_argument, .flag=nullptr, .val='t'},
+        {.name="output", .has_arg=required_argument, .flag=nullptr, .val='o'},
+        {.name=nullptr, .has_arg=0, .flag=nullptr, .val=0}
+    };
+    static const char short_options[] = "hl:jto:";
+
+    string listFileName;
+    bool json = false;
+    bool totals = false;
+    string outFileName;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'l':
+                listFileName = optarg;
+                break;
+            case 'j':
+                json = true;
+                break;
+            case 't':
+                totals = true;
+                break;
+            case 'o':
+                outFileName = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if (optind >= argc)
+    {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    vector<string> fileNames(argv + optind + 1, argv + argc);
+    if (!listFileName.empty())
+    {
+        ifstream listFile(listFileName);
+        if (!listFile.is_open())
+        {
+            cerr << "Cannot open file " << listFileName << endl;
+            return 1;
+        }
+        string line;
+        while (getline(listFile, line))
+        {
+            if (!line.empty())
+                fileNames.push_back(line);
+        }
+    }
+    if (fileNames.empty())
+    {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    try
+    {
+        Dictionary dic(argv[optind]);
+
+        ofstream outFile;
+        if (!outFileName.empty())
+        {
+            outFile.open(outFileName);
+            if (!outFile.is_open())
+            {
+                cerr << "Cannot open file " << outFileName << endl;
+                return 1;
+            }
+        }
+        ostream &out = outFileName.empty() ? cout : outFile;
+
+        // Create the singletons before starting the threads
+        BatchTools::createSingletons();
+
+        // Each task writes its own analysis, so no locking is needed.
+        // The output is printed afterwards, in the order of the files.
+        vector<GameAnalysis> analyses(fileNames.size());
+        ThreadPool::Instance().run(fileNames.size(), [&](unsigned iFile) {
+            analyses[iFile] = analyzeGame(dic, fileNames[iFile]);
+        });
+
+        unsigned nbErrors = 0;
+        for (unsigned i = 0; i < fileNames.size(); ++i)
+        {
+            if (analyses[i].error.empty())
+                continue;
+            ++nbErrors;
+            cerr << fileNames[i] << ": " << analyses[i].error << endl;
+        }
+
+        if (totals)
+        {
+            map<string, PlayerStats> byName;
+            for (const GameAnalysis &analysis : analyses)
+            {
+                if (!analysis.error.empty())
+                    continue;
+                for (const PlayerStats &stats : analysis.players)
+                {
+                    PlayerStats &total = byName[stats.name];
+                    total.name = stats.name;
+                    total.add(stats);
+                }
+            }
+            if (!json)
+                out << formatCsvHeader() << endl;
+            unsigned num = 0;
+            for (const auto &[name, stats] : byName)
+            {
+                if (json)
+                    out << formatJson(stats) << endl;
+                else
+                    out << formatCsv("*", num, stats) << endl;
+                ++num;
+            }
+        }
+        else
+        {
+            if (!json)
+                out << formatCsvHeader() << endl;
+            for (unsigned i = 0; i < fileNames.size(); ++i)
+            {
+                const GameAnalysis &analysis = analyses[i];
+                if (json)
+                {
+                    string line = std::format("{{\"file\":\"{}\"", BatchTools::escapeJson(fileNames[i]));
+                    if (!analysis.error.empty())
+                        line += std::format(",\"error\":\"{}\"", BatchTools::escapeJson(analysis.error));
+                    else
+                    {
+                        line += std::format(",\"turns\":{},\"players\":[", analysis.nbTurns);
+                        for (unsigned p = 0; p < analysis.players.size(); ++p)
+                            line += (p == 0 ? "" : ",") + formatJson(analysis.players[p]);
+                        line += "]";
+                    }
+                    out << line << "}" << endl;
+                }
+                else if (analysis.error.empty())
+                {
+                    for (unsigned p = 0; p < analysis.players.size(); ++p)
+                        out << formatCsv(fileNames[i], p, analysis.players[p]) << endl;
+                }
+            }
+        }
+
+        cerr << "Games analyzed: " << fileNames.size() - nbErrors
+             << ", errors: " << nbErrors << endl;
+
+        BatchTools::destroySingletons();
+    }
+    catch (const BaseException &e)
+    {
+        cerr << "Exception caught: " << e.what() << "\n" << e.getStackTrace();
+        return 1;
+    }
+    catch (std::exception &e)
+    {
+        cerr << "Exception caught: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+/**
+ * Convert saved games between the XML format and the binary format
+ * (see BinFormat). The format of the input file is detected automatically,
+ * and by default the output is written in the other format.
+ */
+
+#include "config.h"
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <clocale>
+#include <cstdlib>
+#include <getopt.h>
+
+#include "dic.h"
+#include "game_factory.h"
+#include "public_game.h"
+#include "bin_reader.h"
+#include "settings.h"
+#include "search_cache.h"
+#include "thread_pool.h"
+#include "base_exception.h"
+
+using namespace std;
+
+
+void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options] -o /path/to/output /path/to/dictionary.dawg /path/to/game" << endl
+         << "Options:" << endl
+         << "  -b, --binary            Write the game in the binary format" << endl
+         << "  -x, --xml               Write the game in the XML format" << endl
+         << "                          (default: the format not used by the input file)" << endl
+         << "  -o, --output <string>   File where the game is written" << endl
+         << "  -h, --help              Print this help and exit" << endl
+         << "Example:" << endl
+         << "  " << iBinaryName << " -o game.elb ods5.dawg game.xml" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "");
+
+    // Do not log by default (can be overridden with ELIOT_LOG_PROFILE)
+    initialize_logging("NOLOG");
+
+    static const struct option long_options[] =
+    {
+        {.name="help", .has_arg=no_argument, .flag=nullptr, .val='h'},
+        {.name="binary", .has_arg=no_argument, .flag=nullptr, .val='b'},
+        {.name="xml", .has_arg=no_argument, .flag=nullptr, .val='x'},
+        {.name="output", .has_arg=required_argument, .flag=nullptr, .val='o'},
+        {.name=nullptr, .has_arg=0, .flag=nullptr, .val=0}
+    };
+    static const char short_options[] = "hbxo:";
+
+    // 0: automatic, 1: binary, 2: XML
+    int outFormat = 0;
+    string outFileName;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'b':
+                outFormat = 1;
+                break;
+            case 'x':
+                outFormat = 2;
+                break;
+            case 'o':
+                outFileName = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if (optind != argc - 2 || outFileName.empty())
+    {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    try
+    {
+        Dictionary dic(argv[optind]);
+        const string inFileName = argv[optind + 1];
+
+        const bool inBinary = BinReader::IsBinFile(inFileName);
+        const bool outBinary = outFormat == 0 ? !inBinary : outFormat == 1;
+
+        unique_ptr<PublicGame> game(PublicGame::load(inFileName, dic));
+        game->save(outFileName, outBinary ? PublicGame::kBINARY : PublicGame::kXML);
+        cerr << (inBinary ? "binary" : "XML") << " -> "
+             << (outBinary ? "binary" : "XML") << ": " << outFileName << endl;
+
+        game.reset();
+        GameFactory::Destroy();
+        Settings::Destroy();
+        SearchCache::Destroy();
+        ThreadPool::Destroy();
+    }
+    catch (const BaseException &e)
+    {
+        cerr << "Exception caught: " << e.what() << "\n" << e.getStackTrace();
+        return 1;
+    }
+    catch (std::exception &e)
+    {
+        cerr << "Exception caught: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+/**
+ * Generate a leave table (see LeaveTable) from self-play statistics.
+ * Free games are played between AI players, and for each move the letters
+ * remaining on the rack are associated to the score of the next move of
+ * the same player. The value of a leave is the difference between the
+ * average score following it and the average score of all the moves.
+ * The averages of the rare leaves are smoothed, using the average of all
+ * the leaves with the same number of tiles.
+ *
+ * The games can be played with an existing table, so that the values can
+ * be refined by running the tool several times.
+ */
+
+#include "config.h"
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <clocale>
+#include <cstdlib>
+#include <ctime>
+#include <getopt.h>
+
+#include "dic.h"
+#include "game_params.h"
+#include "game_factory.h"
+#include "public_game.h"
+#include "game.h"
+#include "player.h"
+#include "history.h"
+#include "turn_data.h"
+#include "pldrack.h"
+#include "rack.h"
+#include "move.h"
+#include "round.h"
+#include "ai_percent.h"
+#include "ai_leave.h"
+#include "leave_table.h"
+#include "random.h"
+#include "thread_pool.h"
+#include "base_exception.h"
+#include "batch_tools.h"
+
+using namespace std;
+
+
+/// Scores following a given leave
+struct LeaveStats
+{
+    unsigned count{0};
+    double total{0};
+};
+
+typedef map<uint64_t, LeaveStats> StatsMap;
+
+/// Weight of the average of the leaves of the same size, for rare leaves
+static const double kPRIOR_WEIGHT = 10;
+
+
+/// Return the number of tiles of the leave with the given key
+unsigned GetLeaveSize(uint64_t iKey)
+{
+    unsigned size = 0;
+    for (; iKey != LeaveTable::kEMPTY_LEAVE; iKey >>= 6)
+        ++size;
+    return size;
+}
+
+
+void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options] -o /path/to/table /path/to/dictionary.dawg" << endl
+         << "Options:" << endl
+         << "  -n, --games <int>       Number of games to play (default: 1000)" << endl
+         << "  -p, --players <int>     Number of players in each game (default: 2)" << endl
+         << "  -s, --seed <int>        Master random seed (default: current time)" << endl
+         << "  -l, --leaves <string>   Existing leave table, used by the players" << endl
+         << "  -m, --min-count <int>   Minimal number of occurrences of a leave to keep it" << endl
+         << "                          in the table (default: 5)" << endl
+         << "  -o, --output <string>   File where the table is written" << endl
+         << "  -h, --help              Print this help and exit" << endl
+         << "Example:" << endl
+         << "  " << iBinaryName << " -n 10000 -o ods5.leaves ods5.dawg" << endl;
+}
+
+
+/// Play one game, and add the statistics of its moves to oStats
+void playGame(const Dictionary &iDic, unsigned iNbPlayers, unsigned iSeed,
+              const shared_ptr<const LeaveTable> &iLeaves, StatsMap &oStats)
+{
+    std::mt19937 engine(iSeed);
+    Random::ThreadEngine threadEngine(engine);
+
+    GameParams params(iDic, GameParams::kFREEGAME);
+    PublicGame game(*GameFactory::Instance()->createGame(params));
+    for (unsigned i = 0; i < iNbPlayers; ++i)
+    {
+        if (iLeaves)
+            game.addPlayer(new AILeave(iLeaves));
+        else
+            game.addPlayer(new AIPercent(1));
+    }
+    // With AI players only, the whole game is played by start()
+    game.start();
+
+    for (unsigned i = 0; i < game.getNbPlayers(); ++i)
+    {
+        // The history of the player also contains the turns
+        // of the other players, with a null move
+        const History &history = game.getPlayer(i).getHistory();
+        for (unsigned j = 0; j < history.getSize(); ++j)
+        {
+            const TurnData &turn = history.getTurn(j);
+            const Move &move = turn.getMove();
+            if (!move.isValid())
+                continue;
+
+            // Find the next move of the player
+            unsigned next = j + 1;
+            while (next < history.getSize() && history.getTurn(next).getMove().isNull())
+                ++next;
+            if (next == history.getSize())
+                continue;
+
+            // Compute the leave
+            Rack leave = turn.getPlayedRack().getRack();
+            const Round &round = move.getRound();
+            for (unsigned k = 0; k < round.getWordLen(); ++k)
+            {
+                if (round.isPlayedFromRack(k))
+                    leave.remove(round.isJoker(k) ? Tile::Joker() : round.getTile(k));
+            }
+
+            LeaveStats &stats = oStats[LeaveTable::MakeKey(leave)];
+            ++stats.count;
+            stats.total += history.getTurn(next).getMove().getScore();
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "");
+
+    // Do not log by default (can be overridden with ELIOT_LOG_PROFILE)
+    initialize_logging("NOLOG");
+
+    static const struct option long_options[] =
+    {
+        {.name="help", .has_arg=no_argument, .flag=nullptr, .val='h'},
+        {.name="games", .has_arg=required_argument, .flag=nullptr, .val='n'},
+        {.name="players", .has_arg=required_argument, .flag=nullptr, .val='p'},
+        {.name="seed", .has_arg=required_argument, .flag=nullptr, .val='s'},
+        {.name="leaves", .has_arg=required_argument, .flag=nullptr, .val='l'},
+        {.name="min-count", .has_arg=required_argument, .flag=nullptr, .val='m'},
+        {.name="output", .has_arg=required_argument, .flag=nullptr, .val='o'},
+        {.name=nullptr, .has_arg=0, .flag=nullptr, .val=0}
+    };
+    static const char short_options[] = "hn:p:s:l:m:o:";
+
+    unsigned nbGames = 1000;
+    unsigned nbPlayers = 2;
+    unsigned masterSeed = time(nullptr);
+    unsigned minCount = 5;
+    string inFileName;
+    string outFileName;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'n':
+                nbGames = atoi(optarg);
+                break;
+            case 'p':
+                nbPlayers = atoi(optarg);
+                break;
+            case 's':
+                masterSeed = strtoul(optarg, nullptr, 10);
+                break;
+            case 'l':
+                inFileName = optarg;
+                break;
+            case 'm':
+                minCount = atoi(optarg);
+                break;
+            case 'o':
+                outFileName = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if (optind != argc - 1 || outFileName.empty() || nbPlayers == 0)
+    {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    try
+    {
+        Dictionary dic(argv[optind]);
+
+        shared_ptr<const LeaveTable> leaves;
+        if (!inFileName.empty())
+            leaves = make_shared<const LeaveTable>(inFileName, dic);
+
+        cerr << "Using master seed: " << masterSeed << endl;
+
+        // Create the singletons before starting the threads
+        BatchTools::createSingletons();
+
+        StatsMap allStats;
+        std::mutex statsMutex;
+        ThreadPool::Instance().run(nbGames, [&](unsigned iGame) {
+            // Each game has its own random sequence (see eliotsim)
+            std::seed_seq seq{masterSeed, iGame};
+            unsigned seed;
+            seq.generate(&seed, &seed + 1);
+
+            StatsMap stats;
+            playGame(dic, nbPlayers, seed, leaves, stats);
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            for (const auto &[key, gameStats] : stats)
+            {
+                allStats[key].count += gameStats.count;
+                allStats[key].total += gameStats.total;
+            }
+        });
+
+        // Average score of a move
+        LeaveStats global;
+        for (const auto &[key, stats] : allStats)
+        {
+            global.count += stats.count;
+            global.total += stats.total;
+        }
+        if (global.count == 0)
+        {
+            cerr << "No move was played" << endl;
+            return 1;
+        }
+        const double average = global.total / global.count;
+
+        // Average score following the leaves of each size
+        map<unsigned, LeaveStats> bySize;
+        for (const auto &[key, stats] : allStats)
+        {
+            bySize[GetLeaveSize(key)].count += stats.count;
+            bySize[GetLeaveSize(key)].total += stats.total;
+        }
+
+        // The average of a rare leave is not reliable, so it is pulled
+        // towards the average of the leaves of the same size, as if
+        // kPRIOR_WEIGHT moves with this average had been observed
+        map<uint64_t, float> values;
+        for (const auto &[key, stats] : allStats)
+        {
+            if (stats.count < minCount)
+                continue;
+            const LeaveStats &sizeStats = bySize[GetLeaveSize(key)];
+            const double sizeAverage = sizeStats.total / sizeStats.count;
+            const double mean = (stats.total + kPRIOR_WEIGHT * sizeAverage) /
+                                (stats.count + kPRIOR_WEIGHT);
+            values[key] = mean - average;
+        }
+
+        LeaveTable::Save(outFileName, dic, values);
+        cerr << "Moves: " << global.count << ", average score: " << average
+             << ", leaves: " << allStats.size() << ", kept: " << values.size() << endl;
+
+        BatchTools::destroySingletons();
+    }
+    catch (const BaseException &e)
+    {
+        cerr << "Exception caught: " << e.what() << "\n" << e.getStackTrace();
+        return 1;
+    }
+    catch (std::exception &e)
+    {
+        cerr << "Exception caught: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
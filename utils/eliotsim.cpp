@@ -0,0 +1,380 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2026 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+/**
+ * Headless simulator: play complete games between AI players, possibly
+ * in parallel, and print a summary of each game in JSON format (one line
+ * per game): the score, moves and bingos of each player, and the wall-clock
+ * and CPU time taken to play the whole game.
+ * Each game has its own random generator, seeded from the master seed
+ * and the number of the game, so the results do not depend on the number
+ * of threads. The seed of a game can also be given to eliottxt to replay
+ * the same game.
+ */
+
+#include "config.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <format>
+#include <clocale>
+#include <cstdlib>
+#include <ctime>
+#include <getopt.h>
+
+#include "dic.h"
+#include "game_params.h"
+#include "game_factory.h"
+#include "public_game.h"
+#include "game.h"
+#include "player.h"
+#include "history.h"
+#include "turn_data.h"
+#include "move.h"
+#include "ai_percent.h"
+#include "ai_leave.h"
+#include "ai_montecarlo.h"
+#include "leave_table.h"
+#include "random.h"
+#include "thread_pool.h"
+#include "base_exception.h"
+#include "batch_tools.h"
+
+using namespace std;
+
+
+/// Parameters of the simulation
+struct SimParams
+{
+    unsigned nbGames{10};
+    unsigned masterSeed{0};
+    GameParams::GameMode mode{GameParams::kDUPLICATE};
+    string variants;
+    /// Levels of the AI players (kLEAVE_LEVEL for the players using
+    /// the leave table, kMONTECARLO_LEVEL for the simulating players)
+    vector<float> levels{1, 1};
+    shared_ptr<const LeaveTable> leaves;
+    AIMonteCarlo::Params monteCarlo;
+};
+
+static const float kLEAVE_LEVEL = -1;
+static const float kMONTECARLO_LEVEL = -2;
+
+
+void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options] /path/to/dictionary.dawg" << endl
+         << "Options:" << endl
+         << "  -n, --games <int>       Number of games to play (default: 10)" << endl
+         << "  -s, --seed <int>        Master random seed (default: current time)" << endl
+         << "  -m, --mode <string>     Game mode: 'duplicate' (default) or 'freegame'" << endl
+         << "  -v, --variants <string> Variants of the game: any combination of" << endl
+         << "                          'j' (joker), 'e' (explosive) and '8' (7 among 8)" << endl
+         << "  -a, --ai <list>         Comma-separated levels of the AI players, between" << endl
+         << "                          0 and 1, 'L' for a player using the leave table," << endl
+         << "                          or 'M' for a player simulating the next turns" << endl
+         << "                          (default: '1,1')" << endl
+         << "  -l, --leaves <string>   Leave table used by the 'L' and 'M' players" << endl
+         << "  -t, --time <int>        Time budget of the 'M' players for each turn," << endl
+         << "                          in milliseconds (default: 1000, 0 for no limit)" << endl
+         << "  -i, --iterations <int>  Maximal number of simulations of the 'M' players" << endl
+         << "                          for each turn (default: 0, i.e. no limit)" << endl
+         << "  -o, --output <string>   Write the summaries to this file instead of stdout" << endl
+         << "  -h, --help              Print this help and exit" << endl
+         << "Example:" << endl
+         << "  " << iBinaryName << " -n 1000 -s 42 -m duplicate -a 1,0.9,0.75 ods5.dawg" << endl;
+}
+
+
+/// Seed of the given game, derived from the master seed
+unsigned getGameSeed(unsigned iMasterSeed, unsigned iGame)
+{
+    std::seed_seq seq{iMasterSeed, iGame};
+    unsigned seed;
+    seq.generate(&seed, &seed + 1);
+    return seed;
+}
+
+
+/// CPU time used by the current thread, in milliseconds
+double getThreadCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000. + ts.tv_nsec / 1000000.;
+}
+
+
+/// Play one game, and return its summary
+string playGame(const Dictionary &iDic, const SimParams &iParams, unsigned iGame)
+{
+    const unsigned seed = getGameSeed(iParams.masterSeed, iGame);
+    string summary = std::format("{{\"game\":{},\"seed\":{}", iGame, seed);
+
+    // Use a dedicated random generator for the game
+    std::mt19937 engine(seed);
+    Random::ThreadEngine threadEngine(engine);
+
+    try
+    {
+        GameParams params(iDic, iParams.mode);
+        for (char variant : iParams.variants)
+        {
+            if (variant == 'j')
+                params.addVariant(GameParams::kJOKER);
+            else if (variant == 'e')
+                params.addVariant(GameParams::kEXPLOSIVE);
+            else if (variant == '8')
+                params.addVariant(GameParams::k7AMONG8);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const double startCpu = getThreadCpuTime();
+
+        // With AI players only, the whole game is played by start()
+        PublicGame game(*GameFactory::Instance()->createGame(params));
+        for (float level : iParams.levels)
+        {
+            if (level == kLEAVE_LEVEL)
+                game.addPlayer(new AILeave(iParams.leaves));
+            else if (level == kMONTECARLO_LEVEL)
+                game.addPlayer(new AIMonteCarlo(iParams.monteCarlo, iParams.leaves));
+            else
+                game.addPlayer(new AIPercent(level));
+        }
+        game.start();
+
+        const double cpuTime = getThreadCpuTime() - startCpu;
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+
+        const History &history = game.getHistory();
+        // The times cover the whole game, not only the searches of the players
+        summary += std::format(",\"turns\":{},\"game_time_ms\":{:.1f},\"game_cpu_ms\":{:.1f}",
+                               history.getSize(), time.count(), cpuTime);
+
+        summary += ",\"players\":[";
+        for (unsigned i = 0; i < game.getNbPlayers(); ++i)
+        {
+            const Player &player = game.getPlayer(i);
+            unsigned nbMoves = 0;
+            unsigned nbBingos = 0;
+            for (unsigned j = 0; j < player.getHistory().getSize(); ++j)
+            {
+                const Move &move = player.getHistory().getTurn(j).getMove();
+                if (!move.isValid())
+                    continue;
+                ++nbMoves;
+                if (move.getRound().getBonus())
+                    ++nbBingos;
+            }
+            string level;
+            if (iParams.levels[i] == kLEAVE_LEVEL)
+                level = "\"leave\"";
+            else if (iParams.levels[i] == kMONTECARLO_LEVEL)
+                level = "\"montecarlo\"";
+            else
+                level = std::format("{}", iParams.levels[i]);
+            summary += std::format("{}{{\"level\":{},\"score\":{},\"moves\":{},\"bingos\":{}}}",
+                                   i == 0 ? "" : ",", level,
+                                   player.getTotalScore(), nbMoves, nbBingos);
+        }
+        summary += "]";
+    }
+    catch (std::exception &e)
+    {
+        summary += std::format(",\"error\":\"{}\"", BatchTools::escapeJson(e.what()));
+    }
+
+    return summary + "}";
+}
+
+
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "");
+
+    // Do not log by default (can be overridden with ELIOT_LOG_PROFILE)
+    initialize_logging("NOLOG");
+
+    static const struct option long_options[] =
+    {
+        {.name="help", .has_arg=no_argument, .flag=nullptr, .val='h'},
+        {.name="games", .has_arg=required_argument, .flag=nullptr, .val='n'},
+        {.name="seed", .has_arg=required_argument, .flag=nullptr, .val='s'},
+        {.name="mode", .has_arg=required_argument, .flag=nullptr, .val='m'},
+        {.name="variants", .has_arg=required_argument, .flag=nullptr, .val='v'},
+        {.name="ai", .has_arg=required_argument, .flag=nullptr, .val='a'},
+        {.name="output", .has_arg=required_argument, .flag=nullptr, .val='o'},
+        {.name="leaves", .has_arg=required_argument, .flag=nullptr, .val='l'},
+        {.name="time", .has_arg=required_argument, .flag=nullptr, .val='t'},
+        {.name="iterations", .has_arg=required_argument, .flag=nullptr, .val='i'},
+        {.name=nullptr, .has_arg=0, .flag=nullptr, .val=0}
+    };
+    static const char short_options[] = "hn:s:m:v:a:o:l:t:i:";
+
+    SimParams params;
+    params.masterSeed = time(nullptr);
+    string outFileName;
+    string leavesFileName;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'n':
+                params.nbGames = atoi(optarg);
+                break;
+            case 's':
+                params.masterSeed = strtoul(optarg, nullptr, 10);
+                break;
+            case 'm':
+                if (string(optarg) == "duplicate")
+                    params.mode = GameParams::kDUPLICATE;
+                else if (string(optarg) == "freegame")
+                    params.mode = GameParams::kFREEGAME;
+                else
+                {
+                    // The other modes need a human player
+                    cerr << "Unsupported game mode: " << optarg << endl;
+                    exit(1);
+                }
+                break;
+            case 'v':
+                params.variants = optarg;
+                break;
+            case 'a':
+                {
+                    params.levels.clear();
+                    istringstream levels(optarg);
+                    string level;
+                    while (getline(levels, level, ','))
+                    {
+                        if (level == "L")
+                            params.levels.push_back(kLEAVE_LEVEL);
+                        else if (level == "M")
+                            params.levels.push_back(kMONTECARLO_LEVEL);
+                        else
+                            params.levels.push_back(atof(level.c_str()));
+                    }
+                }
+                break;
+            case 'o':
+                outFileName = optarg;
+                break;
+            case 'l':
+                leavesFileName = optarg;
+                break;
+            case 't':
+                params.monteCarlo.timeBudget = atoi(optarg);
+                break;
+            case 'i':
+                params.monteCarlo.maxIterations = atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    if (optind != argc - 1 || params.levels.empty() ||
+        (params.monteCarlo.timeBudget == 0 && params.monteCarlo.maxIterations == 0))
+    {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+    // The joker is not shared correctly between the racks of a free game
+    if (params.mode == GameParams::kFREEGAME &&
+        params.variants.find_first_of("je") != string::npos)
+    {
+        cerr << "The joker and explosive variants need the duplicate mode" << endl;
+        exit(1);
+    }
+
+    try
+    {
+        Dictionary dic(argv[optind]);
+
+        const bool needLeaves = std::find(params.levels.begin(), params.levels.end(),
+                                          kLEAVE_LEVEL) != params.levels.end();
+        if (needLeaves && leavesFileName.empty())
+        {
+            cerr << "A leave table is needed for the 'L' players" << endl;
+            return 1;
+        }
+        // The leave table is optional for the 'M' players
+        if (needLeaves || !leavesFileName.empty())
+            params.leaves = make_shared<const LeaveTable>(leavesFileName, dic);
+
+        ofstream outFile;
+        if (!outFileName.empty())
+        {
+            outFile.open(outFileName);
+            if (!outFile.is_open())
+            {
+                cerr << "Cannot open file " << outFileName << endl;
+                return 1;
+            }
+        }
+        ostream &out = outFileName.empty() ? cout : outFile;
+
+        cerr << "Using master seed: " << params.masterSeed << endl;
+
+        // Create the singletons before starting the threads
+        BatchTools::createSingletons();
+
+        std::mutex outMutex;
+        ThreadPool::Instance().run(params.nbGames, [&](unsigned iGame) {
+            const string &summary = playGame(dic, params, iGame);
+            std::lock_guard<std::mutex> lock(outMutex);
+            out << summary << endl;
+        });
+
+        BatchTools::destroySingletons();
+    }
+    catch (const BaseException &e)
+    {
+        cerr << "Exception caught: " << e.what() << "\n" << e.getStackTrace();
+        return 1;
+    }
+    catch (std::exception &e)
+    {
+        cerr << "Exception caught: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
@@ -23,6 +23,8 @@
 
 #include <cwchar>
 #include <iostream>
+#include <sstream>
+#include <memory>
 #include <cstdlib>
 #include <ctime>
 #include <cstring>
@@ -44,13 +46,17 @@
 #include "game_params.h"
 #include "game_factory.h"
 #include "public_game.h"
+#include "endgame_solver.h"
 #include "game.h"
 #include "player.h"
 #include "ai_percent.h"
+#include "ai_montecarlo.h"
 #include "encoding.h"
 #include "game_exception.h"
 #include "base_exception.h"
 #include "settings.h"
+#include "search_cache.h"
+#include "thread_pool.h"
 #include "move.h"
 #include "random.h"
 
@@ -264,6 +270,37 @@ PublicGame * readGame(const Dictionary &iDic,
 }
 
 
+vector<Player*> readPlayers(const vector<wstring> &tokens)
+{
+    int nbHuman = parseNum(tokens, 1);
+    int nbAI = parseNum(tokens, 2);
+    // With the 'm' option, the first AI player simulates the game on the
+    // given number of candidates. The number of simulations is fixed
+    // (without time budget), so that the games can be reproduced
+    int nbMonteCarlo = 0;
+    AIMonteCarlo::Params params;
+    if (tokens.size() > 3 && parseCharInList(tokens, 3, L"m") == L'm')
+    {
+        nbMonteCarlo = 1;
+        params.nbCandidates = parseNum(tokens, 4);
+        params.timeBudget = 0;
+        params.maxIterations = 8;
+    }
+
+    vector<Player*> players;
+    for (int i = 0; i < nbHuman; i++)
+        players.push_back(new HumanPlayer);
+    for (int i = 0; i < nbAI; i++)
+    {
+        if (i < nbMonteCarlo)
+            players.push_back(new AIMonteCarlo(params));
+        else
+            players.push_back(new AIPercent(1));
+    }
+    return players;
+}
+
+
 void helpTraining()
 {
     std::println("  ?    : aide -- cette page");
@@ -279,7 +316,8 @@ void helpTraining()
     std::println("            t -- tirage");
     std::println("            T -- tirage de tous les joueurs");
     std::println("  d [] : vérifier le mot []");
-    std::println("  b [b|p|r] [] : effectuer une recherche speciale à partir de []");
+    std::println("  b [a|b|p|r] [] : effectuer une recherche speciale à partir de []");
+    std::println("            a -- meilleurs anagrammes (hors grille)");
     std::println("            b -- benjamins");
     std::println("            p -- 7 + 1");
     std::println("            r -- raccords");
@@ -289,8 +327,14 @@ void helpTraining()
     std::println("  j [] {{}} : jouer le mot [] aux coordonnées {{}}");
     std::println("  n [] : jouer le résultat numéro []");
     std::println("  r    : rechercher les meilleurs résultats");
-    std::println("  s [] : sauver la partie en cours dans le fichier []");
+    std::println("  s [] [x|b|j] : sauver la partie en cours dans le fichier []");
+    std::println("            x -- format XML (par défaut)");
+    std::println("            b -- format binaire");
+    std::println("            j -- format binaire, puis journal des modifications");
+    std::println("  v [] : vérifier que la partie récupérée du fichier [] (avec son journal)");
+    std::println("         est identique à la partie en cours");
     std::println("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)");
+    std::println("  h g [] : aller au tour []");
     std::println("  q    : quitter le mode entraînement");
 }
 
@@ -311,8 +355,16 @@ void helpFreegame()
     std::println("  d [] : vérifier le mot []");
     std::println("  j [] {{}} : jouer le mot [] aux coordonnées {{}}");
     std::println("  p [] : passer son tour en changeant les lettres []");
-    std::println("  s [] : sauver la partie en cours dans le fichier []");
+    std::println("  f [] : analyser la fin de partie (sac vide) en [] ms au plus");
+    std::println("         (0 : sans limite)");
+    std::println("  s [] [x|b|j] : sauver la partie en cours dans le fichier []");
+    std::println("            x -- format XML (par défaut)");
+    std::println("            b -- format binaire");
+    std::println("            j -- format binaire, puis journal des modifications");
+    std::println("  v [] : vérifier que la partie récupérée du fichier [] (avec son journal)");
+    std::println("         est identique à la partie en cours");
     std::println("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)");
+    std::println("  h g [] : aller au tour []");
     std::println("  q    : quitter le mode partie libre");
 }
 
@@ -333,8 +385,14 @@ void helpDuplicate()
     std::println("  d [] : vérifier le mot []");
     std::println("  j [] {{}} : jouer le mot [] aux coordonnées {{}}");
     std::println("  n [] : passer au joueur n°[]");
-    std::println("  s [] : sauver la partie en cours dans le fichier []");
+    std::println("  s [] [x|b|j] : sauver la partie en cours dans le fichier []");
+    std::println("            x -- format XML (par défaut)");
+    std::println("            b -- format binaire");
+    std::println("            j -- format binaire, puis journal des modifications");
+    std::println("  v [] : vérifier que la partie récupérée du fichier [] (avec son journal)");
+    std::println("         est identique à la partie en cours");
     std::println("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay");
+    std::println("  h g [] : aller au tour []");
     std::println("  q    : quitter le mode duplicate");
 }
 
@@ -361,8 +419,14 @@ void helpArbitration()
     std::println("            w -- avertissement");
     std::println("            p -- pénalité");
     std::println("  f    : finaliser le tour courant");
-    std::println("  s [] : sauver la partie en cours dans le fichier []");
+    std::println("  s [] [x|b|j] : sauver la partie en cours dans le fichier []");
+    std::println("            x -- format XML (par défaut)");
+    std::println("            b -- format binaire");
+    std::println("            j -- format binaire, puis journal des modifications");
+    std::println("  v [] : vérifier que la partie récupérée du fichier [] (avec son journal)");
+    std::println("         est identique à la partie en cours");
     std::println("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)");
+    std::println("  h g [] : aller au tour []");
     std::println("  q    : quitter le mode arbitrage");
 }
 
@@ -384,8 +448,14 @@ void helpTopping()
     std::println("  d [] : vérifier le mot []");
     std::println("  j [] {{}} <> : jouer le mot [] aux coordonnées {{}} après <> secondes");
     std::println("  t [] : simuler un timeout après [] secondes");
-    std::println("  s [] : sauver la partie en cours dans le fichier []");
+    std::println("  s [] [x|b|j] : sauver la partie en cours dans le fichier []");
+    std::println("            x -- format XML (par défaut)");
+    std::println("            b -- format binaire");
+    std::println("            j -- format binaire, puis journal des modifications");
+    std::println("  v [] : vérifier que la partie récupérée du fichier [] (avec son journal)");
+    std::println("         est identique à la partie en cours");
     std::println("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)");
+    std::println("  h g [] : aller au tour []");
     std::println("  q    : quitter le mode topping");
 }
 
@@ -425,7 +495,10 @@ void help()
     std::println("                [] joueurs humains et {{}} joueurs IA (partie détonante)");
     std::println("  a8 [] {{}} : démarrer une partie arbitrage avec");
     std::println("                [] joueurs humains et {{}} joueurs IA (partie 7 sur 8)");
-    std::println("  c []     : charger la partie du fichier []");
+    std::println("  d|l|a [] {{}} m {{1}} : idem, le premier joueur IA simule");
+    std::println("                la suite de la partie pour ses {{1}} meilleurs coups");
+    std::println("  c [] [r] : charger la partie du fichier []");
+    std::println("             r -- avec son journal des modifications");
     std::println("  x [] {{1}} {{2}} {{3}} : expressions rationnelles");
     std::println("          [] expression à rechercher");
     std::println("          {{1}} nombre de résultats à afficher");
@@ -474,9 +547,22 @@ void displayData(const PublicGame &iGame, const vector<wstring> &tokens)
 }
 
 
+/// Return what the displays show of the game, to compare games
+string dumpGame(const PublicGame &iGame)
+{
+    ostringstream oss;
+    oss << "Turn " << iGame.getCurrTurn() << " out of " << iGame.getNbTurns() << endl;
+    GameIO::printBoard(oss, iGame);
+    GameIO::printGameDebug(oss, iGame);
+    GameIO::printAllRacks(oss, iGame);
+    GameIO::printAllPoints(oss, iGame);
+    return oss.str();
+}
+
+
 void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
 {
-    wchar_t command = parseCharInList(tokens, 0, L"#adhjs");
+    wchar_t command = parseCharInList(tokens, 0, L"#adhjsv");
     if (command == L'#')
         // Ignore comments
         return;
@@ -492,7 +578,7 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
     }
     else if (command == L'h')
     {
-        wchar_t action = parseCharInList(tokens, 1, L"pnflr");
+        wchar_t action = parseCharInList(tokens, 1, L"pnflrg");
         int count = parseNum(tokens, 2, true, 1);
         if (action == L'p')
         {
@@ -510,6 +596,8 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
             iGame.lastTurn();
         else if (action == L'r')
             iGame.clearFuture();
+        else if (action == L'g')
+            iGame.goToTurn(count);
     }
     else if (command == L'j')
     {
@@ -522,9 +610,17 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
     else if (command == L's')
     {
         const wstring &fileName = parseFileName(tokens, 1);
+        wchar_t format = L'x';
+        if (tokens.size() > 2)
+            format = parseCharInList(tokens, 2, L"xbj");
         try
         {
-            iGame.save(lfw(fileName));
+            if (format == L'j')
+                iGame.startJournal(lfw(fileName));
+            else if (format == L'b')
+                iGame.save(lfw(fileName), PublicGame::kBINARY);
+            else
+                iGame.save(lfw(fileName), PublicGame::kXML);
         }
         catch (std::exception &e)
         {
@@ -532,6 +628,31 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
             return;
         }
     }
+    else if (command == L'v')
+    {
+        const wstring &fileName = parseFileName(tokens, 1);
+        unique_ptr<PublicGame> recovered;
+        try
+        {
+            recovered.reset(PublicGame::recover(lfw(fileName), iGame.getDic()));
+        }
+        catch (std::exception &e)
+        {
+            std::println("impossible de récupérer la partie {} : {}", lfw(fileName), e.what());
+            return;
+        }
+        if (!iGame.isLastTurn())
+            recovered->goToTurn(iGame.getCurrTurn());
+        const string &live = dumpGame(iGame);
+        const string &recov = dumpGame(*recovered);
+        if (live == recov)
+            std::println("partie récupérée identique");
+        else
+        {
+            std::println("partie récupérée différente :");
+            cout << recov << endl;
+        }
+    }
 }
 
 
@@ -607,14 +728,25 @@ void loopTraining(PublicGame &iGame)
             continue;
         try
         {
-            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsbnrt*+q");
+            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsbnrt*+qv");
             if (command == L'?')
                 helpTraining();
             else if (command == L'b')
             {
-                wchar_t type = parseCharInList(tokens, 1, L"bpr");
+                wchar_t type = parseCharInList(tokens, 1, L"abpr");
                 const wstring &word = parseLetters(tokens, 2, iGame.getDic());
-                if (type == L'b')
+                if (type == L'a')
+                {
+                    int limit = parseNum(tokens, 3, true, 10);
+                    vector<pair<wdstring, unsigned int> > wordList;
+                    iGame.getDic().searchAnagrams(word, wordList, 1,
+                                                  DIC_WORD_MAX - 1, limit);
+                    for (const auto &[wstr, points] : wordList)
+                    {
+                        std::println("{:3} {}", points, lfw(wstr));
+                    }
+                }
+                else if (type == L'b')
                 {
                     vector<wdstring> wordList;
                     iGame.getDic().searchBenj(word, wordList);
@@ -694,9 +826,22 @@ void loopFreegame(PublicGame &iGame)
             continue;
         try
         {
-            wchar_t command = parseCharInList(tokens, 0, L"#?adhjspq");
+            wchar_t command = parseCharInList(tokens, 0, L"#?adfhjspqv");
             if (command == L'?')
                 helpFreegame();
+            else if (command == L'f')
+            {
+                int timeLimit = parseNum(tokens, 1, true, 5000);
+                const EndgameResult &result =
+                    iGame.freeGameSolveEndgame(timeLimit);
+                std::println("meilleur coup : {}", lfw(result.move.toString()));
+                // The depth and the number of positions depend on the speed
+                // of the machine, they are only logged
+                std::println("écart : {:+} ({})", result.value,
+                             result.solved ? "exact" : "estimé");
+                for (unsigned i = 0; i < result.line.size(); ++i)
+                    std::println("  {}: {}", i + 1, lfw(result.line[i].toString()));
+            }
             else if (command == L'p')
             {
                 wstring letters = L"";
@@ -736,7 +881,7 @@ void loopDuplicate(PublicGame &iGame)
             continue;
         try
         {
-            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsnq");
+            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsnqv");
             if (command == L'?')
                 helpDuplicate();
             else if (command == L'n')
@@ -771,7 +916,7 @@ void loopArbitration(PublicGame &iGame)
             continue;
         try
         {
-            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsfjmet*q");
+            wchar_t command = parseCharInList(tokens, 0, L"#?adhjsfjmet*qv");
             if (command == L'?')
                 helpArbitration();
             else if (command == L'f')
@@ -839,7 +984,7 @@ void loopTopping(PublicGame &iGame)
             continue;
         try
         {
-            wchar_t command = parseCharInList(tokens, 0, L"#?adhjstq");
+            wchar_t command = parseCharInList(tokens, 0, L"#?adhjstqv");
             if (command == L'?')
                 helpTopping();
             else if (command == L'q')
@@ -897,9 +1042,13 @@ void mainLoop(const Dictionary &iDic)
                 case L'c':
                     {
                         const string &fileName = lfw(parseFileName(tokens, 1));
+                        const bool withJournal =
+                            tokens.size() > 2 && parseCharInList(tokens, 2, L"r") == L'r';
                         try
                         {
-                            PublicGame *game = PublicGame::load(fileName, iDic);
+                            PublicGame *game = withJournal ?
+                                PublicGame::recover(fileName, iDic) :
+                                PublicGame::load(fileName, iDic);
                             if (game->getMode() == PublicGame::kTRAINING)
                                 loopTraining(*game);
                             else if (game->getMode() == PublicGame::kFREEGAME)
@@ -930,14 +1079,11 @@ void mainLoop(const Dictionary &iDic)
                     break;
                 case L'd':
                     {
-                        int nbHuman = parseNum(tokens, 1);
-                        int nbAI = parseNum(tokens, 2);
+                        const vector<Player*> &players = readPlayers(tokens);
                         // New duplicate game
                         PublicGame *game = readGame(iDic, GameParams::kDUPLICATE, tokens[0]);
-                        for (int i = 0; i < nbHuman; i++)
-                            game->addPlayer(new HumanPlayer);
-                        for (int i = 0; i < nbAI; i++)
-                            game->addPlayer(new AIPercent(1));
+                        for (Player *player : players)
+                            game->addPlayer(player);
                         game->start();
                         loopDuplicate(*game);
                         delete game;
@@ -945,14 +1091,11 @@ void mainLoop(const Dictionary &iDic)
                     break;
                 case L'l':
                     {
-                        int nbHuman = parseNum(tokens, 1);
-                        int nbAI = parseNum(tokens, 2);
+                        const vector<Player*> &players = readPlayers(tokens);
                         // New free game
                         PublicGame *game = readGame(iDic, GameParams::kFREEGAME, tokens[0]);
-                        for (int i = 0; i < nbHuman; i++)
-                            game->addPlayer(new HumanPlayer);
-                        for (int i = 0; i < nbAI; i++)
-                            game->addPlayer(new AIPercent(1));
+                        for (Player *player : players)
+                            game->addPlayer(player);
                         game->start();
                         loopFreegame(*game);
                         delete game;
@@ -960,14 +1103,11 @@ void mainLoop(const Dictionary &iDic)
                     break;
                 case L'a':
                     {
-                        int nbHuman = parseNum(tokens, 1);
-                        int nbAI = parseNum(tokens, 2);
+                        const vector<Player*> &players = readPlayers(tokens);
                         // New free game
                         PublicGame *game = readGame(iDic, GameParams::kARBITRATION, tokens[0]);
-                        for (int i = 0; i < nbHuman; i++)
-                            game->addPlayer(new HumanPlayer);
-                        for (int i = 0; i < nbAI; i++)
-                            game->addPlayer(new AIPercent(1));
+                        for (Player *player : players)
+                            game->addPlayer(player);
                         game->start();
                         loopArbitration(*game);
                         delete game;
@@ -1035,6 +1175,8 @@ int main(int argc, char *argv[])
         mainLoop(dic);
         GameFactory::Destroy();
         Settings::Destroy();
+        SearchCache::Destroy();
+        ThreadPool::Destroy();
 
         // Free the readline static variable
         if (wline_read)